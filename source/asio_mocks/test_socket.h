@@ -185,6 +185,17 @@ public:
 		const MutableBufferSequence & buffers,
 		ReadHandler handler);
 
+    /**
+     * @brief waits until the socket becomes readable. The handler is called with 0 bytes transferred.
+     *
+     * The data of a planned read is taken from the plan, when the socket becomes readable and is delivered
+     * by the next read.
+     */
+    template< typename ReadHandler >
+    void async_read_some(
+        const boost::asio::null_buffers& buffers,
+        ReadHandler handler);
+
     template<
         typename ConstBufferSequence,
         typename WriteHandler>
@@ -262,6 +273,9 @@ private:
 		    const MutableBufferSequence & buffers,
 		    ReadHandler handler);
 
+        template< typename ReadHandler >
+        void async_wait_readable( ReadHandler handler );
+
         template<
             typename ConstBufferSequence,
             typename WriteHandler>
@@ -342,6 +356,10 @@ private:
         read_plan                                   read_plan_;
         write_plan                                  write_plan_;
         bool                                        closed_;
+
+        // set, when the socket was signaled to be readable; ready_read_ then contains the data of a planned read
+        bool                                        read_ready_;
+        read_plan::item                             ready_read_;
     };
 
     boost::shared_ptr< impl >  pimpl_;
@@ -424,6 +442,15 @@ void socket<Iterator, Timer, Trait>::async_read_some(
     pimpl_->async_read_some(buffers, handler);
 }
 
+template <class Iterator, class Timer, class Trait>
+template <typename ReadHandler>
+void socket<Iterator, Timer, Trait>::async_read_some(
+        const boost::asio::null_buffers&,
+        ReadHandler handler)
+{
+    pimpl_->async_wait_readable(handler);
+}
+
 template <class Iterator, class Timer, class Trait>
 template<typename ConstBufferSequence, typename WriteHandler>
 void socket<Iterator, Timer, Trait>::async_write_some(
@@ -537,6 +564,8 @@ socket<Iterator, Timer, Trait>::impl::impl(boost::asio::io_service& io_service)
  , read_timer_(io_service_)
  , write_timer_(io_service_)
  , closed_( false )
+ , read_ready_( false )
+ , ready_read_()
 {
 }
 
@@ -574,6 +603,8 @@ socket<Iterator, Timer, Trait>::impl::impl(boost::asio::io_service&
  , read_delay_(read_delay)
  , write_delay_(write_delay)
  , closed_( false )
+ , read_ready_( false )
+ , ready_read_()
 {
     assert(times);
 }
@@ -610,6 +641,8 @@ socket<Iterator, Timer, Trait>::impl::impl(boost::asio::io_service&         io_s
  , read_timer_(io_service_)
  , write_timer_(io_service_)
  , closed_( false )
+ , read_ready_( false )
+ , ready_read_()
 {
 }
 
@@ -640,6 +673,8 @@ socket<Iterator, Timer, Trait>::impl::impl(boost::asio::io_service& io_service,
  , read_timer_(io_service_)
  , write_timer_(io_service_)
  , closed_( false )
+ , read_ready_( false )
+ , ready_read_()
 {
 }
 
@@ -669,6 +704,8 @@ socket<Iterator, Timer, Trait>::impl::impl(boost::asio::io_service& io_service,
  , read_timer_(io_service_)
  , write_timer_(io_service_)
  , closed_( false )
+ , read_ready_( false )
+ , ready_read_()
 {
 }
 
@@ -700,6 +737,8 @@ socket<Iterator, Timer, Trait>::impl::impl(boost::asio::io_service& io_service,
  , read_plan_(reads)
  , write_plan_(writes)
  , closed_( false )
+ , read_ready_( false )
+ , ready_read_()
 {
 }
 
@@ -812,6 +851,25 @@ namespace {
         SocketPtr   socket;
     };
 
+    template <class Handler>
+    struct delayed_readable_t
+    {
+        void operator()(const boost::system::error_code& error)
+        {
+            handler(error ? make_error_code(boost::asio::error::operation_aborted) : error, 0);
+        }
+
+        Handler     handler;
+    };
+
+    template <class Handler>
+    delayed_readable_t<Handler> delayed_readable(const Handler& handler)
+    {
+        delayed_readable_t<Handler> delay = {handler};
+
+        return delay;
+    }
+
     template <class Handler, class Buffer, class SocketPtr>
     delayed_read_t<Handler, Buffer, SocketPtr>
     delayed_read(const Handler& handler, const Buffer& buffer, const SocketPtr& socket)
@@ -931,7 +989,21 @@ void socket<Iterator, Timer, Trait>::impl::async_read_some(
         return;
     }
 
-    if ( !read_plan_.empty() )
+    // the socket was signaled to be readable, the read is not delayed again
+    if ( read_ready_ && !read_plan_.empty() )
+    {
+        const std::size_t size = copy_read(ready_read_.first, buffers);
+        ready_read_.first.erase(0, size);
+        read_ready_ = !ready_read_.first.empty();
+
+        io_service_.post(boost::bind<void>(handler, boost::system::error_code(), size));
+    }
+    else if ( read_ready_ )
+    {
+        read_ready_ = false;
+        undelayed_async_read_some(buffers, handler);
+    }
+    else if ( !read_plan_.empty() )
     {
         const read_plan::item plan = read_plan_.next_read();
 
@@ -958,6 +1030,49 @@ void socket<Iterator, Timer, Trait>::impl::async_read_some(
         undelayed_async_read_some(buffers, handler);
     }
 }
+template <class Iterator, class Timer, class Trait>
+template <class ReadHandler>
+void socket<Iterator, Timer, Trait>::impl::async_wait_readable(ReadHandler handler)
+{
+    if ( !connected_ || shutdown_read_ )
+    {
+        io_service_.post(boost::bind<void>(handler, make_error_code(boost::asio::error::not_connected), 0));
+        return;
+    }
+
+    const bool already_ready = read_ready_;
+    read_ready_ = true;
+
+    if ( already_ready )
+    {
+        io_service_.post(boost::bind<void>(handler, boost::system::error_code(), 0));
+    }
+    else if ( !read_plan_.empty() )
+    {
+        // the socket becomes readable, when the data of the next planned read arrived
+        ready_read_ = read_plan_.next_read();
+
+        if ( ready_read_.second != boost::posix_time::time_duration() )
+        {
+            read_timer_.expires_from_now(ready_read_.second);
+            read_timer_.async_wait(delayed_readable(handler));
+        }
+        else
+        {
+            io_service_.post(boost::bind<void>(handler, boost::system::error_code(), 0));
+        }
+    }
+    else if ( read_delay_ != boost::posix_time::time_duration() )
+    {
+        read_timer_.expires_from_now(read_delay_);
+        read_timer_.async_wait(delayed_readable(handler));
+    }
+    else
+    {
+        io_service_.post(boost::bind<void>(handler, boost::system::error_code(), 0));
+    }
+}
+
 template <class Iterator, class Timer, class Trait>
 
 template<typename ConstBufferSequence, typename WriteHandler>
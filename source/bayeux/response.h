@@ -113,7 +113,8 @@ namespace bayeux
 			std::size_t bytes_read_and_decoded );
 
 		void handle_requests( const json::value& );
-		void handle_form_requests( const std::string& );
+		// decodes the given form/url encoded text in place and handles all contained messages
+		void handle_form_requests( char* begin, char* end, bool form_encoded );
 
         // response_interface implementation
         void second_connection_detected();
@@ -136,6 +137,7 @@ namespace bayeux
 
         // used when the message is application/x-www-form-urlencoded
         bool                                                    form_encoded_;
+        // the encoded body or query; decoded in place
         std::vector< char >                                     form_body_;
 
 		// a concatenated list of snippets that form the http response
@@ -211,7 +213,7 @@ namespace bayeux
 	  , connection_( connection )
 	  , request_( header )
 	  , parsed_( false )
-	  , message_parser_()
+	  , message_parser_( json::parser::default_block_size )
 	  , form_encoded_( false )
 	  , form_body_()
 	  , response_()
@@ -234,7 +236,7 @@ namespace bayeux
 
         if ( request_->body_expected() )
         {
-            form_encoded_ = request_->option_available( http::content_type_header, http::application_x_www_from_urlencded );
+            form_encoded_ = request_->option_available( http::header_content_type, http::application_x_www_from_urlencded );
 
             connection_->async_read_body( boost::bind( &response::body_read_handler, this->shared_from_this(), _1, _2, _3
                     ) );
@@ -244,7 +246,9 @@ namespace bayeux
             tools::substring scheme, authority, path, query, fragment;
             // lets see, if the query contains a bayeux message
             http::split_url( request_->uri(), scheme, authority, path, query, fragment );
-            handle_form_requests( http::url_decode( query ) );
+
+            form_body_.assign( query.begin(), query.end() );
+            handle_form_requests( form_body_.data(), form_body_.data() + form_body_.size(), false );
         }
 	}
 
@@ -274,8 +278,7 @@ namespace bayeux
 
 		    if ( bytes_read_and_decoded == 0 )
 		    {
-		        handle_form_requests(
-		            http::form_decode( tools::substring( &form_body_[ 0 ], &form_body_[ 0 ] + form_body_.size() ) ) );
+		        handle_form_requests( form_body_.data(), form_body_.data() + form_body_.size(), true );
 		    }
 
 		    guard.dismiss();
@@ -362,10 +365,14 @@ namespace bayeux
 	}
 
     template < class Connection >
-    void response< Connection >::handle_form_requests( const std::string& body )
+    void response< Connection >::handle_form_requests( char* begin, char* end, bool form_encoded )
     {
+        end = form_encoded
+            ? http::form_decode( begin, end, begin )
+            : http::url_decode( begin, end, begin );
+
         const std::vector< std::pair< tools::substring, tools::substring > > messages =
-            http::split_query( tools::substring( body.c_str(), body.c_str() + body.size() ) );
+            http::split_query( tools::substring( begin, end ) );
 
         unsigned message_cnt = 0;
         for ( std::vector< std::pair< tools::substring, tools::substring > >::const_iterator msg = messages.begin();
@@ -404,7 +411,7 @@ namespace bayeux
         timer_.cancel();
 
         response_ = this->build_response( this->bayeux_response_ );
-        connection_->async_write(
+        connection_->async_write_last(
             response_,
             boost::bind( &response::response_written, this->shared_from_this(), _1, _2 ),
             *this );
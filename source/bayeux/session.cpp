@@ -8,6 +8,7 @@
 #include "bayeux/node_channel.h"
 #include "bayeux/response.h"
 #include "pubsub/root.h"
+#include <boost/bind.hpp>
 
 namespace bayeux
 {
@@ -203,7 +204,11 @@ namespace bayeux
 	        }
 	    }
 
-	    const json::object update_msg = build_update_msg( name, data );
+	    // all sessions share the same update message for a node version
+	    static const char update_payload_tag = 0;
+
+	    const json::object update_msg = data.payload( &update_payload_tag, pubsub::node::update_range(),
+	        boost::bind( &session::build_update_msg, this, boost::cref( name ), boost::cref( data ) ) ).upcast< json::object >();
 
 	    if ( response_list.empty() && !update_msg.empty() )
 	    {
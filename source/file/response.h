@@ -13,12 +13,18 @@
 #include <boost/enable_shared_from_this.hpp>
 #include <boost/asio/buffer.hpp>
 #include <boost/bind.hpp>
+#include <boost/function.hpp>
+#include <algorithm>
+#include <stdexcept>
 #include <iterator>
 
 namespace file
 {
     /**
      * @brief very simple implementation of delivering a local file
+     *
+     * The file is read and written in blocks of block_size bytes, so that the memory used by a response does not
+     * depend on the size of the delivered file.
      */
     template < class Connection >
     class response :
@@ -32,27 +38,41 @@ namespace file
             const boost::system::error_code&    error,
             std::size_t                         bytes_transferred);
 
+        static const std::size_t block_size = 64 * 1024;
+
     private:
         virtual void start();
         virtual const char* name() const;
 
+        // reads the next block and writes it together with the header, if the header was not written yet
+        void write_next_block();
+
         const boost::shared_ptr< Connection >       connection_;
         const boost::filesystem::path               path_;
+        boost::filesystem::ifstream                 input_;
+        boost::uintmax_t                            remaining_;
         std::vector< char >                         buffer_;
         std::string                                 header_;
+        bool                                        header_written_;
         std::vector< boost::asio::const_buffer >    result_;
 
         typedef server::report_error_guard< Connection > response_guard;
     };
 
     // implementation
+    template < class Connection >
+    const std::size_t response< Connection >::block_size;
+
     template < class Connection >
     response< Connection >::response( const boost::shared_ptr< Connection >& connection,
                                       const boost::filesystem::path&         file_to_deliver )
         : connection_( connection )
         , path_( file_to_deliver )
+        , input_()
+        , remaining_( 0 )
         , buffer_()
         , header_()
+        , header_written_( false )
         , result_()
     {
     }
@@ -62,13 +82,27 @@ namespace file
         const boost::system::error_code&    error,
         std::size_t                         bytes_transferred)
     {
-        if ( !error )
+        if ( error )
+        {
+            connection_->response_not_possible( *this );
+        }
+        else if ( remaining_ == 0 )
         {
             connection_->response_completed( *this );
         }
         else
         {
-            connection_->response_not_possible( *this );
+            // the header is written, so an error can only be reported by closing the connection
+            server::close_connection_guard< Connection > guard( *connection_, *this );
+
+            try
+            {
+                write_next_block();
+                guard.dismiss();
+            }
+            catch ( ... ) // error reported by closing the connection
+            {
+            }
         }
     }
 
@@ -84,27 +118,15 @@ namespace file
 
         try 
         {
-            boost::filesystem::ifstream input( path_ );
+            input_.open( path_, std::ios_base::in | std::ios_base::binary );
 
-            if ( input.is_open() )
+            if ( input_.is_open() )
             {
-                std::istreambuf_iterator< char > begin( input ), end;
-                buffer_.insert( buffer_.begin(), begin, end );
+                remaining_ = boost::filesystem::file_size( path_ );
+                header_    = response_header + tools::as_string( remaining_ ) + "\r\n\r\n";
 
-                if ( !input.bad() )
-                {
-                    header_ = response_header + tools::as_string( buffer_.size() ) + "\r\n\r\n";
-
-                    result_.push_back( boost::asio::buffer( header_ ) );
-                    result_.push_back( boost::asio::buffer( buffer_ ) );
-
-                    connection_->async_write(
-                        result_,
-                        boost::bind( &response::data_written, this->shared_from_this(), _1, _2 ),
-                        *this );
-
-                    guard.dismiss();
-                }
+                write_next_block();
+                guard.dismiss();
             }
         }
         catch ( ... ) // error reported by http error code
@@ -113,6 +135,38 @@ namespace file
         }
     }
 
+    template < class Connection >
+    void response< Connection >::write_next_block()
+    {
+        buffer_.resize( static_cast< std::size_t >( std::min< boost::uintmax_t >( remaining_, block_size ) ) );
+
+        if ( !buffer_.empty() && !input_.read( &buffer_[ 0 ], buffer_.size() ) )
+            throw std::runtime_error( "error reading file" );
+
+        remaining_ -= buffer_.size();
+
+        result_.clear();
+
+        if ( !header_written_ )
+            result_.push_back( boost::asio::buffer( header_ ) );
+
+        result_.push_back( boost::asio::buffer( buffer_ ) );
+
+        const boost::function< void ( const boost::system::error_code&, std::size_t ) > handler =
+            boost::bind( &response::data_written, this->shared_from_this(), _1, _2 );
+
+        if ( remaining_ == 0 )
+        {
+            connection_->async_write_last( result_, handler, *this );
+        }
+        else
+        {
+            connection_->async_write( result_, handler, *this );
+        }
+
+        header_written_ = true;
+    }
+
     template < class Connection >
     const char* response< Connection >::name() const
     {
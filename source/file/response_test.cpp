@@ -128,3 +128,39 @@ BOOST_AUTO_TEST_CASE( retrieve_a_not_existing_file )
     BOOST_REQUIRE_EQUAL( response.size(), 1u );
     BOOST_CHECK_EQUAL( response.front().first->code(), http::http_not_found );
 }
+
+/**
+ * @test a file, that is bigger than a single block is delivered completely
+ */
+BOOST_AUTO_TEST_CASE( retrieve_a_file_bigger_than_a_block )
+{
+    const boost::filesystem::path file_name = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+
+    std::vector< char > content;
+    for ( std::size_t i = 0; i != 3 * file::response< connection_t >::block_size + 17; ++i )
+        content.push_back( static_cast< char >( i * 7 ) );
+
+    {
+        std::ofstream output( file_name.string().c_str(), std::ios_base::out | std::ios_base::binary );
+        output.write( &content[ 0 ], content.size() );
+    }
+
+    const std::string request = "GET " + file_name.string() + " HTTP/1.1\r\nHost: google.de\r\n\r\n";
+
+    boost::asio::io_service queue;
+    socket_t                socket( queue, request.data(), request.data() + request.size() );
+    trait_t                 trait;
+
+    boost::shared_ptr< connection_t > connection( new connection_t( socket, trait ) );
+    connection->start();
+
+    tools::run( queue );
+    boost::filesystem::remove( file_name );
+
+    std::vector< std::pair< boost::shared_ptr< http::response_header >, std::vector< char > > > response =
+        http::decode_stream< http::response_header >( socket.bin_output() );
+
+    BOOST_REQUIRE_EQUAL( response.size(), 1u );
+    BOOST_CHECK_EQUAL( response.front().first->code(), http::http_ok );
+    BOOST_CHECK( http::test::compare_buffers( response.front().second, content, std::cerr ) );
+}
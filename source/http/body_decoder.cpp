@@ -37,6 +37,21 @@ namespace http
 		}
 	}
 
+    std::size_t body_decoder::feed_buffer( const char* buffer, std::size_t size, body_buffers& decoded )
+    {
+        std::size_t taken = 0;
+
+        while ( taken != size && !done() )
+        {
+            taken += feed_buffer( buffer + taken, size - taken );
+
+            for ( std::pair< std::size_t, const char* > part = decode(); part.first; part = decode() )
+                decoded.push_back( boost::asio::const_buffer( part.second, part.first ) );
+        }
+
+        return taken;
+    }
+
     bool body_decoder::done() const
     {
         if ( chunked_ )
@@ -9,9 +9,16 @@
 #include "http/http.h"
 #include "http/parser.h"
 #include "http/chunk_decoder.h"
+#include <boost/asio/buffer.hpp>
+#include <vector>
 
 namespace http
 {
+    /**
+     * @brief a scatter list of decoded body parts, pointing into the buffers, that where fed to a body_decoder
+     */
+    typedef std::vector< boost::asio::const_buffer > body_buffers;
+
 	/**
 	 * @brief decodes a message body
 	 *
@@ -38,6 +45,18 @@ namespace http
          */
         std::size_t feed_buffer( const char* buffer, std::size_t size );
 
+        /**
+         * @brief feeds a new part of the body to the decoder and decodes all complete chunks of the buffer at once
+         *
+         * The decoded parts are appended to decoded and point into the passed buffer. Using this function instead
+         * of pairs of feed_buffer() and decode() calls, a buffer containing many small chunks can be handed to a
+         * receiver as one list. If decoded is reused, no memory is allocated, once it reached its maximum size.
+         *
+         * @return the number of bytes taken from the buffer. This is smaller than size only, if the body ends
+         *         within the buffer.
+         */
+        std::size_t feed_buffer( const char* buffer, std::size_t size, body_buffers& decoded );
+
         /**
          * @brief returns true, if the whole body was feed() and decode()'d
          */
@@ -67,13 +86,19 @@ namespace http
     template < class Base >
     http::http_error_code body_decoder::start( const http::message_base< Base >& request )
     {
-        if ( request.option_available("Transfer-Encoding", "chunked") )
+        // a decoder can be used to decode a sequence of messages
+        chunked_      = false;
+        current_size_ = 0;
+        current_      = 0;
+
+        if ( request.option_available( http::header_transfer_encoding, "chunked" ) )
         {
             chunked_ = true;
+            static_cast< chunk_decoder< body_decoder >& >( *this ) = chunk_decoder< body_decoder >();
         }
         else
         {
-            const http::header* length_header = request.find_header( "Content-Length" );
+            const http::header* length_header = request.find_header( http::header_content_length );
             if ( !length_header )
                 return http::http_length_required;
 
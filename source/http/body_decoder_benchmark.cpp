@@ -0,0 +1,143 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+#include "http/body_decoder.h"
+#include "http/request.h"
+#include "http/test_tools.h"
+#include "tools/elapse_timer.h"
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/function.hpp>
+#include <boost/bind.hpp>
+#include <algorithm>
+#include <iostream>
+
+/*
+ * measures the throughput of the body_decoder for chunked bodies with small and with large chunks. The body is fed
+ * to the decoder in pieces of the size of a read buffer, as server::connection does. "per part" decodes every chunk
+ * by a pair of feed_buffer() and decode() and calls the handler once per decoded part, "buffers" decodes all
+ * complete chunks of a read at once and calls the handler once per read.
+ */
+namespace
+{
+    const std::size_t body_size      = 1024 * 1024;
+    const std::size_t read_size      = 4096;
+    const unsigned    iterations     = 50u;
+
+    const http::request_header chunked_header(
+        "POST / HTTP/1.1\r\n"
+        "Host: torrox.de\r\n"
+        "Transfer-Encoding: chunked\r\n"
+        "\r\n" );
+
+    struct statistic
+    {
+        statistic() : bytes( 0 ), calls( 0 ) {}
+
+        void part( const char*, std::size_t size )
+        {
+            bytes += size;
+            ++calls;
+        }
+
+        void buffers( const http::body_buffers& parts )
+        {
+            for ( http::body_buffers::const_iterator b = parts.begin(); b != parts.end(); ++b )
+                bytes += boost::asio::buffer_size( *b );
+
+            ++calls;
+        }
+
+        std::size_t bytes;
+        std::size_t calls;
+    };
+
+    // handlers are called through a boost::function, like the body read call back of a connection
+    void decode_per_part( const std::vector< char >& message, const boost::function< void ( const char*, std::size_t ) >& handler )
+    {
+        http::body_decoder decoder;
+        decoder.start( chunked_header );
+
+        for ( std::size_t pos = 0; pos != message.size() && !decoder.done(); )
+        {
+            const std::size_t read = std::min( read_size, message.size() - pos );
+
+            for ( std::size_t taken = 0; taken != read && !decoder.done(); )
+            {
+                taken += decoder.feed_buffer( &message[ pos + taken ], read - taken );
+
+                for ( std::pair< std::size_t, const char* > part = decoder.decode(); part.first; part = decoder.decode() )
+                    handler( part.second, part.first );
+            }
+
+            pos += read;
+        }
+    }
+
+    void decode_buffers( const std::vector< char >& message, const boost::function< void ( const http::body_buffers& ) >& handler )
+    {
+        http::body_decoder decoder;
+        decoder.start( chunked_header );
+
+        http::body_buffers parts;
+
+        for ( std::size_t pos = 0; pos != message.size() && !decoder.done(); )
+        {
+            const std::size_t read = std::min( read_size, message.size() - pos );
+
+            parts.clear();
+            decoder.feed_buffer( &message[ pos ], read, parts );
+
+            if ( !parts.empty() )
+                handler( parts );
+
+            pos += read;
+        }
+    }
+
+    void report( const char* name, const boost::posix_time::time_duration& elapsed, const statistic& stat, std::size_t message_size )
+    {
+        std::cout << "  " << name
+                  << ": elapsed: " << elapsed
+                  << "; handler calls: " << stat.calls / iterations
+                  << "; ns per kB: " << elapsed.total_nanoseconds() * 1024 / ( message_size * iterations )
+                  << std::endl;
+    }
+
+    void measure( const char* name, std::size_t max_chunk_size )
+    {
+        boost::minstd_rand          random;
+        const std::vector< char >   message = http::test::random_chunk(
+            random, http::test::random_body( random, body_size ), max_chunk_size );
+
+        std::cout << name << " (max chunk size: " << max_chunk_size << "; message size: " << message.size() << ")" << std::endl;
+
+        {
+            statistic stat;
+            const boost::function< void ( const char*, std::size_t ) > handler = boost::bind( &statistic::part, &stat, _1, _2 );
+
+            const tools::elapse_timer time;
+            for ( unsigned i = 0; i != iterations; ++i )
+                decode_per_part( message, handler );
+
+            report( "per part", time.elapsed(), stat, message.size() );
+        }
+
+        {
+            statistic stat;
+            const boost::function< void ( const http::body_buffers& ) > handler = boost::bind( &statistic::buffers, &stat, _1 );
+
+            const tools::elapse_timer time;
+            for ( unsigned i = 0; i != iterations; ++i )
+                decode_buffers( message, handler );
+
+            report( "buffers", time.elapsed(), stat, message.size() );
+        }
+    }
+}
+
+int main()
+{
+    measure( "small chunks", 16u );
+    measure( "large chunks", 64u * 1024u );
+}
@@ -3,6 +3,8 @@
 #include "http/request.h"
 #include "http/test_tools.h"
 #include "http/test_request_texts.h"
+#include <cstring>
+#include <string>
 
 static const http::request_header header_with_body(
 		"POST / HTTP/1.1\r\n"
@@ -153,3 +155,60 @@ BOOST_AUTO_TEST_CASE( decode_chunk_transfered_buffer )
             std::cerr ) );
 }
 
+
+namespace {
+    std::string as_string( const http::body_buffers& buffers )
+    {
+        std::string result;
+
+        for ( http::body_buffers::const_iterator b = buffers.begin(); b != buffers.end(); ++b )
+            result.append( boost::asio::buffer_cast< const char* >( *b ), boost::asio::buffer_size( *b ) );
+
+        return result;
+    }
+}
+
+/**
+ * @test all chunks of a buffer are decoded by a single call into a list of buffers, pointing into the fed buffer
+ */
+BOOST_AUTO_TEST_CASE( decode_all_chunks_of_a_buffer )
+{
+	static const http::request_header chunked_header(
+		"POST / HTTP/1.1\r\n"
+		"Host: google.de\r\n"
+		"Transfer-Encoding: chunked\r\n"
+		"\r\n" );
+
+	static const char body[] = "5\r\nHello\r\n1\r\n \r\n6\r\nWorld!\r\n0\r\n\r\nPOST / HTTP/1.1\r\n";
+	const std::size_t body_size = sizeof body - 1 - std::strlen( "POST / HTTP/1.1\r\n" );
+
+	http::body_decoder decoder;
+	BOOST_REQUIRE_EQUAL( http::http_ok, decoder.start( chunked_header ) );
+
+	http::body_buffers decoded;
+	BOOST_CHECK_EQUAL( body_size, decoder.feed_buffer( body, sizeof body - 1, decoded ) );
+
+	BOOST_CHECK( decoder.done() );
+	BOOST_REQUIRE_EQUAL( decoded.size(), 3u );
+	BOOST_CHECK( boost::asio::buffer_cast< const char* >( decoded[ 0 ] ) == &body[ 3 ] );
+	BOOST_CHECK_EQUAL( as_string( decoded ), "Hello World!" );
+
+	// fed in two parts
+	BOOST_REQUIRE_EQUAL( http::http_ok, decoder.start( chunked_header ) );
+	decoded.clear();
+
+	BOOST_CHECK_EQUAL( 12u, decoder.feed_buffer( body, 12u, decoded ) );
+	BOOST_CHECK( !decoder.done() );
+	BOOST_CHECK_EQUAL( as_string( decoded ), "Hello" );
+
+	BOOST_CHECK_EQUAL( body_size - 12u, decoder.feed_buffer( body + 12, sizeof body - 13, decoded ) );
+	BOOST_CHECK( decoder.done() );
+	BOOST_CHECK_EQUAL( as_string( decoded ), "Hello World!" );
+
+	// length encoded
+	BOOST_REQUIRE_EQUAL( http::http_ok, decoder.start( header_with_body ) );
+	decoded.clear();
+
+	BOOST_CHECK_EQUAL( 5u, decoder.feed_buffer( header_with_body.unparsed_buffer().first, header_with_body.unparsed_buffer().second, decoded ) );
+	BOOST_CHECK_EQUAL( as_string( decoded ), "12345" );
+}
@@ -0,0 +1,76 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+#include "http/chunk_encoder.h"
+
+namespace http {
+
+    namespace {
+        const char crlf[]       = "\r\n";
+        const char last_crlf[]  = "\r\n0\r\n\r\n";
+        const char last[]       = "0\r\n\r\n";
+
+        std::size_t hex_digits( std::size_t size )
+        {
+            std::size_t result = 1;
+
+            for ( ; size > 0xf; size >>= 4 )
+                ++result;
+
+            return result;
+        }
+    }
+
+    chunk_encoder::chunk_encoder()
+    {
+    }
+
+    chunk_encoder::buffers_type chunk_encoder::chunk( const boost::asio::const_buffer& data )
+    {
+        if ( boost::asio::buffer_size( data ) == 0 )
+        {
+            const buffers_type empty = {{ boost::asio::const_buffer(), boost::asio::const_buffer(), boost::asio::const_buffer() }};
+            return empty;
+        }
+
+        return encode( data, boost::asio::buffer( crlf, sizeof crlf - 1 ) );
+    }
+
+    chunk_encoder::buffers_type chunk_encoder::last_chunk( const boost::asio::const_buffer& data )
+    {
+        if ( boost::asio::buffer_size( data ) == 0 )
+        {
+            const buffers_type result = {{
+                boost::asio::const_buffer(), boost::asio::const_buffer(), boost::asio::buffer( last, sizeof last - 1 ) }};
+
+            return result;
+        }
+
+        return encode( data, boost::asio::buffer( last_crlf, sizeof last_crlf - 1 ) );
+    }
+
+    std::size_t chunk_encoder::encoded_size( std::size_t size )
+    {
+        return size == 0 ? 0 : hex_digits( size ) + size + 2 * ( sizeof crlf - 1 );
+    }
+
+    chunk_encoder::buffers_type chunk_encoder::encode( const boost::asio::const_buffer& data, const boost::asio::const_buffer& tail )
+    {
+        static const char digits[] = "0123456789abcdef";
+
+        char* const end   = size_line_ + sizeof size_line_;
+        char*       begin = end - ( sizeof crlf - 1 );
+
+        begin[ 0 ] = '\r';
+        begin[ 1 ] = '\n';
+
+        for ( std::size_t size = boost::asio::buffer_size( data ); size; size >>= 4 )
+            *--begin = digits[ size & 0xf ];
+
+        const buffers_type result = {{ boost::asio::buffer( begin, end - begin ), data, tail }};
+
+        return result;
+    }
+
+} // namespace http
@@ -0,0 +1,65 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+#ifndef SIOUX_SOURCE_HTTP_CHUNK_ENCODER_H
+#define SIOUX_SOURCE_HTTP_CHUNK_ENCODER_H
+
+#include <boost/array.hpp>
+#include <boost/asio/buffer.hpp>
+#include <cstddef>
+
+namespace http {
+
+    /**
+     * @brief class responsible to encode a body into chunks, without copying the body
+     *
+     * The encoder formats the chunk size line into a small buffer member and returns a sequence of buffers, that
+     * frames the passed body data. The returned buffers refer to the encoder and to the passed data, so both have
+     * to stay valid until the buffers are written. As every call to chunk() or last_chunk() overwrites the size line
+     * of the previous call, there can be only one write of encoded buffers in flight per encoder.
+     *
+     * Example: encoding "Hello" results in the buffers "5\r\n", "Hello" and "\r\n".
+     */
+    class chunk_encoder
+    {
+    public:
+        /**
+         * @brief the buffers of one encoded chunk: the chunk size line, the body data and the line end after the data
+         */
+        typedef boost::array< boost::asio::const_buffer, 3 > buffers_type;
+
+        chunk_encoder();
+
+        /**
+         * @brief encodes the given data as one chunk
+         *
+         * If data is empty, all returned buffers are empty, as an empty chunk would indicate the end of the body.
+         */
+        buffers_type chunk( const boost::asio::const_buffer& data );
+
+        /**
+         * @brief encodes the given data as the last chunk of a body
+         *
+         * Same as chunk(), but the last buffer contains the last-chunk and the empty trailer. data can be empty.
+         */
+        buffers_type last_chunk( const boost::asio::const_buffer& data );
+
+        /**
+         * @brief returns the number of bytes, an encoded chunk of size data bytes will use
+         */
+        static std::size_t encoded_size( std::size_t size );
+
+    private:
+        chunk_encoder( const chunk_encoder& );
+        chunk_encoder& operator=( const chunk_encoder& );
+
+        buffers_type encode( const boost::asio::const_buffer& data, const boost::asio::const_buffer& tail );
+
+        // hex digits and \r\n
+        char size_line_[ sizeof( std::size_t ) * 2 + 2 ];
+    };
+
+} // namespace http
+
+#endif // include guard
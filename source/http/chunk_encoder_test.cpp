@@ -0,0 +1,121 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+#include <boost/test/unit_test.hpp>
+#include "http/chunk_encoder.h"
+#include "http/chunk_decoder.h"
+#include "http/test_tools.h"
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+    void append( std::vector< char >& output, const http::chunk_encoder::buffers_type& buffers )
+    {
+        for ( http::chunk_encoder::buffers_type::const_iterator b = buffers.begin(); b != buffers.end(); ++b )
+        {
+            const char* const data = boost::asio::buffer_cast< const char* >( *b );
+            output.insert( output.end(), data, data + boost::asio::buffer_size( *b ) );
+        }
+    }
+
+    std::string as_string( const http::chunk_encoder::buffers_type& buffers )
+    {
+        std::vector< char > result;
+        append( result, buffers );
+
+        return std::string( result.begin(), result.end() );
+    }
+
+    class body_receiver : public http::chunk_decoder< body_receiver >
+    {
+    public:
+        std::size_t take_chunk( const char* input, std::size_t size )
+        {
+            body_.insert( body_.end(), input, input + size );
+
+            return size;
+        }
+
+        std::vector< char > body_;
+    };
+
+    std::vector< char > decode( const std::vector< char >& encoded )
+    {
+        body_receiver decoder;
+
+        for ( std::size_t pos = 0; pos != encoded.size() && !decoder.chunked_done(); )
+            pos += decoder.feed_chunked_buffer( &encoded[ pos ], encoded.size() - pos );
+
+        BOOST_CHECK( decoder.chunked_done() );
+
+        return decoder.body_;
+    }
+}
+
+/**
+ * @test the size line is hex encoded and the data is framed by CRLF
+ */
+BOOST_AUTO_TEST_CASE( encode_single_chunks )
+{
+    http::chunk_encoder encoder;
+
+    BOOST_CHECK_EQUAL( as_string( encoder.chunk( boost::asio::buffer( "Hello", 5 ) ) ), "5\r\nHello\r\n" );
+    BOOST_CHECK_EQUAL( as_string( encoder.last_chunk( boost::asio::buffer( "Hello", 5 ) ) ), "5\r\nHello\r\n0\r\n\r\n" );
+
+    const std::string large( 0x1a2b, 'x' );
+    BOOST_CHECK_EQUAL( as_string( encoder.chunk( boost::asio::buffer( large ) ) ), "1a2b\r\n" + large + "\r\n" );
+}
+
+/**
+ * @test empty data results in no chunk at all, or in the last-chunk only
+ */
+BOOST_AUTO_TEST_CASE( encode_empty_chunks )
+{
+    http::chunk_encoder encoder;
+
+    BOOST_CHECK_EQUAL( as_string( encoder.chunk( boost::asio::const_buffer() ) ), "" );
+    BOOST_CHECK_EQUAL( as_string( encoder.last_chunk( boost::asio::const_buffer() ) ), "0\r\n\r\n" );
+    BOOST_CHECK_EQUAL( http::chunk_encoder::encoded_size( 0 ), 0u );
+}
+
+/**
+ * @test encoded_size() matches the size of the encoded buffers
+ */
+BOOST_AUTO_TEST_CASE( encoded_size_of_chunks )
+{
+    http::chunk_encoder encoder;
+    const std::vector< char > data( 70000, 'a' );
+
+    for ( std::size_t size = 1; size < data.size(); size = size * 3 + 1 )
+    {
+        BOOST_CHECK_EQUAL(
+            boost::asio::buffer_size( encoder.chunk( boost::asio::buffer( &data[ 0 ], size ) ) ),
+            http::chunk_encoder::encoded_size( size ) );
+    }
+}
+
+/**
+ * @test a body encoded in chunks of different sizes decodes to the original body
+ */
+BOOST_AUTO_TEST_CASE( encoded_body_can_be_decoded )
+{
+    std::vector< char > body;
+    for ( std::size_t i = 0; i != 10000; ++i )
+        body.push_back( static_cast< char >( 'a' + i % 26 ) );
+
+    for ( std::size_t chunk_size = 1; chunk_size < body.size(); chunk_size = chunk_size * 2 + 3 )
+    {
+        http::chunk_encoder encoder;
+        std::vector< char > encoded;
+
+        std::size_t pos = 0;
+        for ( ; body.size() - pos > chunk_size; pos += chunk_size )
+            append( encoded, encoder.chunk( boost::asio::buffer( &body[ pos ], chunk_size ) ) );
+
+        append( encoded, encoder.last_chunk( boost::asio::buffer( &body[ pos ], body.size() - pos ) ) );
+
+        BOOST_CHECK( http::test::compare_buffers( body, decode( encoded ), std::cerr ) );
+    }
+}
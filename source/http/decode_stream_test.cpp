@@ -88,3 +88,32 @@ BOOST_AUTO_TEST_CASE( decode_response_with_body )
 
     BOOST_CHECK_EQUAL( "12345", std::string( body.begin(), body.end() ) );
 }
+
+/**
+ * @test the body decoder is reset between messages, so that a chunked message can follow a chunked message or a
+ *       message with Content-Length
+ */
+BOOST_AUTO_TEST_CASE( decode_consecutive_chunked_messages )
+{
+    static const char responses[] =
+        "HTTP/1.1 200 OK\r\n"
+        "Transfer-Encoding: chunked\r\n"
+        "\r\n"
+        "5\r\nHello\r\n0\r\n\r\n"
+        "HTTP/1.1 200 OK\r\n"
+        "Transfer-Encoding: chunked\r\n"
+        "\r\n"
+        "6\r\nWorld!\r\n0\r\n\r\n"
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Length: 3\r\n"
+        "\r\n"
+        "abc";
+
+    const http::decoded_response_stream_t bodies_and_headers = http::decode_stream< http::response_header >(
+        std::vector< char >( tools::begin( responses ), tools::end( responses ) -1 ) );
+
+    BOOST_REQUIRE_EQUAL( 3u, bodies_and_headers.size() );
+    BOOST_CHECK_EQUAL( "Hello", std::string( bodies_and_headers[ 0 ].second.begin(), bodies_and_headers[ 0 ].second.end() ) );
+    BOOST_CHECK_EQUAL( "World!", std::string( bodies_and_headers[ 1 ].second.begin(), bodies_and_headers[ 1 ].second.end() ) );
+    BOOST_CHECK_EQUAL( "abc", std::string( bodies_and_headers[ 2 ].second.begin(), bodies_and_headers[ 2 ].second.end() ) );
+}
@@ -4,6 +4,7 @@
 
 #include "http/header.h"
 #include "http/parser.h"
+#include "http/scan.h"
 #include "tools/split.h"
 #include <algorithm>
 #include <functional>
@@ -46,7 +47,7 @@ namespace http {
     bool header::parse(const char* begin, const char* end)
     {
         const char* const name  = http::eat_spaces_and_CRLS(begin, end);
-        const char* const colon = std::find(name, end, ':');
+        const char* const colon = http::find_char(name, end, ':');
 
         if ( name != begin || colon == end )
             return false;
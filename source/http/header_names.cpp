@@ -3,6 +3,9 @@
 // Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
 
 #include "http/header_names.h"
+#include "http/parser.h"
+#include <cassert>
+#include <cstring>
 
 namespace http
 {
@@ -11,4 +14,89 @@ namespace http
     const char * const transfer_encoding_header = "Transfer-Encoding";
 
     const char * const application_x_www_from_urlencded = "application/x-www-form-urlencoded";
+
+    namespace {
+        const std::size_t slot_count = 32u;
+
+        // the perfect hash function for the known headers: the length of the name plus the first character
+        // in lower case. The table below is laid out according to this function, which is checked at compile time.
+        constexpr std::size_t header_hash( char first, std::size_t length )
+        {
+            return ( length + static_cast< unsigned char >( first >= 'A' && first <= 'Z' ? first - 'A' + 'a' : first ) )
+                & ( slot_count - 1 );
+        }
+
+        struct known_name
+        {
+            const char*     name;
+            std::size_t     length;
+            known_header    id;
+        };
+
+#define SIOUX_KNOWN_HEADER( name, id ) { name, sizeof name - 1, id }
+
+        constexpr known_name slots[ slot_count ] = {
+            /*  0 */ SIOUX_KNOWN_HEADER( "Proxy-Connection", header_proxy_connection ),
+            {}, {}, {}, {},
+            /*  5 */ SIOUX_KNOWN_HEADER( "Transfer-Encoding", header_transfer_encoding ),
+            {}, {}, {},
+            /*  9 */ SIOUX_KNOWN_HEADER( "Cookie", header_cookie ),
+            {},
+            /* 11 */ SIOUX_KNOWN_HEADER( "Expect", header_expect ),
+            /* 12 */ SIOUX_KNOWN_HEADER( "Host", header_host ),
+            /* 13 */ SIOUX_KNOWN_HEADER( "Connection", header_connection ),
+            /* 14 */ SIOUX_KNOWN_HEADER( "Authorization", header_authorization ),
+            /* 15 */ SIOUX_KNOWN_HEADER( "Content-Type", header_content_type ),
+            /* 16 */ SIOUX_KNOWN_HEADER( "Accept-Encoding", header_accept_encoding ),
+            /* 17 */ SIOUX_KNOWN_HEADER( "Content-Length", header_content_length ),
+            {}, {}, {},
+            /* 21 */ SIOUX_KNOWN_HEADER( "Keep-Alive", header_keep_alive ),
+            /* 22 */ SIOUX_KNOWN_HEADER( "TE", header_te ),
+            {}, {}, {}, {},
+            /* 27 */ SIOUX_KNOWN_HEADER( "Trailer", header_trailer ),
+            /* 28 */ SIOUX_KNOWN_HEADER( "Upgrade", header_upgrade ),
+            {}, {}, {}
+        };
+
+#undef SIOUX_KNOWN_HEADER
+
+        // true, if every name is stored in the slot given by its hash
+        constexpr bool slots_are_valid( std::size_t slot )
+        {
+            return slot == slot_count
+                || ( ( slots[ slot ].name == 0 || header_hash( slots[ slot ].name[ 0 ], slots[ slot ].length ) == slot )
+                  && slots_are_valid( slot + 1 ) );
+        }
+
+        static_assert( slots_are_valid( 0 ), "a known header is not stored in the slot of its hash value" );
+    }
+
+    known_header classify_header( const char* begin, const char* end )
+    {
+        if ( begin == end )
+            return unknown_header;
+
+        const std::size_t               length = end - begin;
+        const known_name&               entry  = slots[ header_hash( *begin, length ) ];
+
+        return entry.length == length && http::strcasecmp( begin, end, entry.name ) == 0
+            ? entry.id
+            : unknown_header;
+    }
+
+    known_header classify_header( const char* name )
+    {
+        return classify_header( name, name + std::strlen( name ) );
+    }
+
+    const char* header_name( known_header id )
+    {
+        assert( id < number_of_known_headers );
+
+        const known_name* entry = slots;
+        for ( ; entry->name == 0 || entry->id != id; ++entry )
+            ;
+
+        return entry->name;
+    }
 }
@@ -5,6 +5,8 @@
 #ifndef SIOUX_SOURCE_HEADER_NAMES_H_
 #define SIOUX_SOURCE_HEADER_NAMES_H_
 
+#include <cstddef>
+
 namespace http
 {
     extern const char * const content_type_header;
@@ -12,6 +14,51 @@ namespace http
     extern const char * const transfer_encoding_header;
 
     extern const char * const application_x_www_from_urlencded;
+
+    /**
+     * @brief well known header names, that are classified, when a header is parsed
+     *
+     * A message keeps the position of the first header of every known name, so that looking up a
+     * known header takes constant time.
+     */
+    enum known_header
+    {
+        header_accept_encoding,
+        header_authorization,
+        header_connection,
+        header_content_length,
+        header_content_type,
+        header_cookie,
+        header_expect,
+        header_host,
+        header_keep_alive,
+        header_proxy_connection,
+        header_te,
+        header_trailer,
+        header_transfer_encoding,
+        header_upgrade,
+        number_of_known_headers,
+        unknown_header = number_of_known_headers
+    };
+
+    /**
+     * @brief returns the known_header of the given name or unknown_header
+     *
+     * The comparison is not case sensitive. The name is looked up in a perfect hash table, so at most one
+     * string comparison is done.
+     */
+    known_header classify_header( const char* begin, const char* end );
+
+    /**
+     * @brief returns the known_header of the given, zero terminated name or unknown_header
+     */
+    known_header classify_header( const char* name );
+
+    /**
+     * @brief the name of a known header
+     * @pre id != unknown_header
+     */
+    const char* header_name( known_header id );
 }
 
 #endif /* SIOUX_SOURCE_HEADER_NAMES_H_ */
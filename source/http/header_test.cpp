@@ -4,7 +4,11 @@
 
 #include <boost/test/unit_test.hpp>
 #include "http/header.h"
+#include "http/header_names.h"
+#include <algorithm>
+#include <cctype>
 #include <cstring>
+#include <string>
 
 namespace http {
 
@@ -41,6 +45,30 @@ BOOST_AUTO_TEST_CASE(parse_http_header)
     BOOST_CHECK_EQUAL("dsa \r\n \r\n foo", h.value());
 }
 
+/**
+ * @test all known header names are classified, independent from the case of the name
+ */
+BOOST_AUTO_TEST_CASE(classify_known_headers)
+{
+    for ( unsigned id = 0; id != number_of_known_headers; ++id )
+    {
+        const std::string name = header_name(static_cast<known_header>(id));
+        BOOST_CHECK_EQUAL(classify_header(name.c_str()), static_cast<known_header>(id));
+
+        std::string lower = name;
+        std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+        BOOST_CHECK_EQUAL(classify_header(lower.c_str()), static_cast<known_header>(id));
+    }
+
+    BOOST_CHECK_EQUAL(classify_header("Content-Type"), header_content_type);
+    BOOST_CHECK_EQUAL(classify_header(content_length_header), header_content_length);
+    BOOST_CHECK_EQUAL(classify_header(""), unknown_header);
+    BOOST_CHECK_EQUAL(classify_header("Content-Typ"), unknown_header);
+    BOOST_CHECK_EQUAL(classify_header("Content-Typf"), unknown_header);
+    BOOST_CHECK_EQUAL(classify_header("X-Host"), unknown_header);
+    BOOST_CHECK_EQUAL(classify_header("Hose"), unknown_header);
+}
+
 } // namespace http 
 
 
@@ -7,7 +7,9 @@
 #include "http/response.h"
 #include "http/filter.h"
 #include "http/parser.h"
+#include "http/scan.h"
 #include "tools/split.h"
+#include "tools/buffer_pool.h"
 #include <algorithm>
 #include <cassert>
 #include <cstring>
@@ -15,82 +17,233 @@
 
 namespace http {
 
+    const std::size_t message::initial_buffer_size;
+    const std::size_t message::default_max_buffer_size;
+
     //////////////////////////
     // class request_header
     template <class Type>
     message_base<Type>::message_base()
-        : write_ptr_(0)
+        : buffer_(0)
+        , buffer_size_(0)
+        , max_buffer_size_(default_max_buffer_size)
+        , write_ptr_(0)
         , parse_ptr_(0)
         , read_ptr_(0)
         , error_(parsing)
         , parser_state_(expect_request_line)
     {
+        clear_headers();
     }
     
     template <class Type>
     message_base<Type>::message_base(const Type& old_header, std::size_t& remaining, copy_trailing_buffer_t)
-        : write_ptr_(0)
+        : buffer_(0)
+        , buffer_size_(0)
+        , max_buffer_size_(old_header.max_buffer_size_)
+        , write_ptr_(0)
         , parse_ptr_(0)
         , read_ptr_(0)
         , error_(parsing)
         , parser_state_(expect_request_line)
     {
-        std::copy(&old_header.buffer_[old_header.parse_ptr_], &old_header.buffer_[old_header.write_ptr_], &buffer_[0]);
+        clear_headers();
         remaining = old_header.write_ptr_ - old_header.parse_ptr_;
 
         // the last request_header must have signaled a buffer-full error
-        assert(remaining != sizeof buffer_);
+        assert(remaining == 0 || remaining < old_header.max_buffer_size_);
+
+        if ( remaining )
+        {
+            grow(remaining);
+            std::copy(old_header.buffer_ + old_header.parse_ptr_, old_header.buffer_ + old_header.write_ptr_, buffer_);
+        }
     }
 
     template <class Type>
     message_base<Type>::message_base(const boost::asio::const_buffers_1& old_body, std::size_t& remaining)
-    	: write_ptr_(0)
+        : buffer_(0)
+        , buffer_size_(0)
+        , max_buffer_size_(default_max_buffer_size)
+    	, write_ptr_(0)
     	, parse_ptr_(0)
     	, read_ptr_(0)
     	, error_(parsing)
     	, parser_state_(expect_request_line)
     {
-    	const char* const buffer = boost::asio::buffer_cast< const char* >( old_body );
-    	const std::size_t size   = boost::asio::buffer_size( old_body );
-
-    	if ( size > sizeof buffer_ )
-    		throw std::runtime_error( "unable to store old_body" );
-
-    	std::copy( buffer, buffer + size, &buffer_[0]);
-    	remaining = size;
+        reset(old_body, remaining);
     }
     
     template <class Type>
     message_base<Type>::message_base(const char* source)
-        : write_ptr_(0)
+        : buffer_(0)
+        , buffer_size_(0)
+        , max_buffer_size_(default_max_buffer_size)
+        , write_ptr_(0)
         , parse_ptr_(0)
         , read_ptr_(0)
         , error_( parsing )
         , parser_state_(expect_request_line)
     {
-        const std::size_t max = std::min(sizeof buffer_, std::strlen(source));
-        std::strncpy(buffer_, source, max);
+        clear_headers();
+        const std::size_t max = std::min(max_buffer_size_, std::strlen(source));
+
+        if ( max )
+        {
+            grow(max);
+            std::copy(source, source + max, buffer_);
+        }
 
         parse(max);
     }
 
+    template <class Type>
+    message_base<Type>::~message_base()
+    {
+        tools::buffer_pool::shared().release(buffer_, buffer_size_);
+    }
+
+    template <class Type>
+    void message_base<Type>::reset()
+    {
+        write_ptr_     = 0;
+        parse_ptr_     = 0;
+        read_ptr_      = 0;
+        error_         = parsing;
+        start_line_    = tools::substring();
+        parser_state_  = expect_request_line;
+        clear_headers();
+    }
+
+    template <class Type>
+    void message_base<Type>::reset(const Type& old_header, std::size_t& remaining, copy_trailing_buffer_t)
+    {
+        remaining = old_header.write_ptr_ - old_header.parse_ptr_;
+
+        // the last request_header must have signaled a buffer-full error
+        assert(remaining == 0 || remaining < old_header.max_buffer_size_);
+
+        if ( &old_header == this )
+        {
+            if ( remaining )
+                std::memmove(buffer_, buffer_ + parse_ptr_, remaining);
+
+            reset();
+        }
+        else
+        {
+            reset();
+
+            if ( remaining > buffer_size_ )
+                grow(remaining);
+
+            std::copy(old_header.buffer_ + old_header.parse_ptr_, old_header.buffer_ + old_header.write_ptr_, buffer_);
+        }
+    }
+
+    template <class Type>
+    void message_base<Type>::reset(const boost::asio::const_buffers_1& old_body, std::size_t& remaining)
+    {
+    	const char* const buffer = boost::asio::buffer_cast< const char* >( old_body );
+    	const std::size_t size   = boost::asio::buffer_size( old_body );
+
+    	if ( size > max_buffer_size_ )
+    		throw std::runtime_error( "unable to store old_body" );
+
+    	reset();
+
+    	if ( size > buffer_size_ )
+    	    grow(size);
+
+    	std::copy( buffer, buffer + size, buffer_);
+    	remaining = size;
+    }
+
+    template <class Type>
+    void message_base<Type>::grow(std::size_t min_size)
+    {
+        assert(min_size > buffer_size_);
+
+        std::size_t new_size = std::max(min_size, buffer_size_ == 0 ? initial_buffer_size : 2 * buffer_size_);
+
+        if ( new_size > max_buffer_size_ )
+            new_size = std::max(min_size, max_buffer_size_);
+
+        char* const new_buffer = tools::buffer_pool::shared().allocate(new_size);
+        std::copy(buffer_, buffer_ + write_ptr_, new_buffer);
+
+        tools::buffer_pool::shared().release(buffer_, buffer_size_);
+        buffer_      = new_buffer;
+        buffer_size_ = new_size;
+
+        // all parsed substrings refer to the old buffer. Instead of moving them, the stored data is parsed
+        // again with the next call to parse(). As the buffer grows exponentially, this costs linear time.
+        if ( parse_ptr_ != 0 || read_ptr_ != 0 )
+        {
+            parse_ptr_     = 0;
+            read_ptr_      = 0;
+            start_line_    = tools::substring();
+            parser_state_  = expect_request_line;
+            clear_headers();
+        }
+    }
+
     template <class Type>
     std::pair<char*, std::size_t> message_base<Type>::read_buffer()
     {
-        assert(write_ptr_ <= sizeof buffer_);
-        return std::make_pair(&buffer_[write_ptr_], sizeof buffer_ - write_ptr_);
+        assert(write_ptr_ < max_buffer_size_);
+
+        if ( write_ptr_ == buffer_size_ )
+            grow(write_ptr_ + 1);
+
+        const std::size_t size = std::min(buffer_size_, max_buffer_size_);
+        assert(write_ptr_ < size);
+
+        return std::make_pair(buffer_ + write_ptr_, size - write_ptr_);
     }
     
     template <class Type>
     std::pair<char*, std::size_t> message_base<Type>::unparsed_buffer()  
     {
-        return std::make_pair(&buffer_[parse_ptr_], write_ptr_ - parse_ptr_);
+        return std::make_pair(buffer_ + parse_ptr_, write_ptr_ - parse_ptr_);
     }
 
     template <class Type>
     std::pair<const char*, std::size_t> message_base<Type>::unparsed_buffer() const
     {
-        return std::make_pair(&buffer_[parse_ptr_], write_ptr_ - parse_ptr_);
+        return std::make_pair(static_cast< const char* >(buffer_ + parse_ptr_), write_ptr_ - parse_ptr_);
+    }
+
+    template <class Type>
+    std::size_t message_base<Type>::max_buffer_size() const
+    {
+        return max_buffer_size_;
+    }
+
+    template <class Type>
+    void message_base<Type>::max_buffer_size( std::size_t new_max )
+    {
+        assert(new_max != 0);
+        max_buffer_size_ = new_max;
+    }
+
+    template <class Type>
+    std::size_t message_base<Type>::buffer_size() const
+    {
+        return buffer_size_;
+    }
+
+    template <class Type>
+    void message_base<Type>::release_buffer()
+    {
+        if ( write_ptr_ != 0 )
+            return;
+
+        tools::buffer_pool::shared().release(buffer_, buffer_size_);
+        buffer_      = 0;
+        buffer_size_ = 0;
+
+        header_list_t().swap(headers_);
     }
 
     template <class Type>
@@ -100,7 +253,7 @@ namespace http {
         assert( error_ == parsing );
         write_ptr_ += size;
 
-        assert( write_ptr_ <= sizeof buffer_ );
+        assert( write_ptr_ <= buffer_size_ );
 
         for ( std::size_t i = read_ptr_; error_ == parsing && read_ptr_ != write_ptr_; )
         {
@@ -108,16 +261,15 @@ namespace http {
             assert(parse_ptr_ < write_ptr_);
             assert(parse_ptr_ <= read_ptr_);
 
-            // seek for CR         
-            for ( ; i != write_ptr_-1 && buffer_[i] != '\r'; ++i )
-                ;
+            // seek for CR
+            i = http::find_char(&buffer_[i], &buffer_[write_ptr_-1], '\r') - buffer_;
 
             // no \r found, restart seeking at the currently last buffer position
             if ( i == write_ptr_-1 )
             {
                 read_ptr_  = i;
 
-                if ( write_ptr_ == sizeof buffer_ )
+                if ( write_ptr_ >= max_buffer_size_ )
                     error_ = buffer_full;
 
                 return error_ != parsing;
@@ -138,7 +290,7 @@ namespace http {
             }
         }
 
-        if ( write_ptr_ == sizeof buffer_ && error_ == parsing )
+        if ( write_ptr_ >= max_buffer_size_ && error_ == parsing )
             error_ = buffer_full;
 
         return error_ != parsing;
@@ -201,6 +353,11 @@ namespace http {
         else if ( h.parse(start, end) )
         {
             headers_.push_back(h);
+
+            const known_header id = classify_header(h.name_.begin(), h.name_.end());
+
+            if ( id != unknown_header && known_headers_[id] == 0 )
+                known_headers_[id] = headers_.size();
         }
         else
         {
@@ -214,6 +371,13 @@ namespace http {
         error_ = syntax_error;
     }
 
+    template <class Type>
+    void message_base<Type>::clear_headers()
+    {
+        headers_.clear();
+        std::fill(known_headers_, known_headers_ + number_of_known_headers, 0u);
+    }
+
     template <class Type>
     typename message_base<Type>::error_code message_base<Type>::state() const
     {
@@ -244,15 +408,24 @@ namespace http {
     template <class Type>
     tools::substring message_base<Type>::text() const
     {
-        return tools::substring(&buffer_[0], &buffer_[parse_ptr_]);
+        return tools::substring(buffer_, buffer_ + parse_ptr_);
     }
 
     template <class Type>
     bool message_base<Type>::option_available(const char* header_name, const char* option) const
     {
-        assert(error_ == ok);
-        const header * const h = find_header(header_name);
+        return option_in_header(find_header(header_name), option);
+    }
 
+    template <class Type>
+    bool message_base<Type>::option_available(known_header header_name, const char* option) const
+    {
+        return option_in_header(find_header(header_name), option);
+    }
+
+    template <class Type>
+    bool message_base<Type>::option_in_header(const header* h, const char* option)
+    {
         if ( h == 0 )
             return false;
 
@@ -282,9 +455,30 @@ namespace http {
         return find_header_impl(header_name);
     }
 
+    template <class Type>
+    const typename message_base<Type>::header* message_base<Type>::find_header(known_header header_name) const
+    {
+        assert( error_ == ok );
+        return find_header_impl(header_name);
+    }
+
+    template <class Type>
+    const typename message_base<Type>::header* message_base<Type>::find_header_impl(known_header header_name) const
+    {
+        assert( header_name < number_of_known_headers );
+        const std::size_t index = known_headers_[header_name];
+
+        return index != 0 ? &headers_[index - 1] : 0;
+    }
+
     template <class Type>
     const typename message_base<Type>::header* message_base<Type>::find_header_impl(const char* header_name) const
     {
+        const known_header id = classify_header(header_name);
+
+        if ( id != unknown_header )
+            return find_header_impl(id);
+
         std::vector<header>::const_iterator h = headers_.begin();
         for ( ; h != headers_.end() && http::strcasecmp(h->name_.begin(), h->name_.end(), header_name) != 0; ++h )
             ;
@@ -295,7 +489,7 @@ namespace http {
     template <class Type>
     bool message_base<Type>::close_after_response() const
     {
-        return error_ != ok || milli_version() < 1001 || option_available("connection", "close");
+        return error_ != ok || milli_version() < 1001 || option_available(header_connection, "close");
     }
 
     template <class Type>
@@ -323,7 +517,7 @@ namespace http {
 
         // current_start now points to the end of the last header, if that was filtered out or
         // to the start of that part of the header that has to be included.
-        result.push_back(tools::substring(current_start, &buffer_[parse_ptr_]));
+        result.push_back(tools::substring(current_start, buffer_ + parse_ptr_));
 
         return result;
     }
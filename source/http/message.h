@@ -3,6 +3,7 @@
 
 #include "http/http.h"
 #include "http/header.h"
+#include "http/header_names.h"
 #include <boost/asio/buffer.hpp>
 #include <iosfwd>
 
@@ -26,6 +27,16 @@ namespace http
             /** parsing isn't finished jet */
             parsing
         };
+
+        /**
+         * @brief size of the buffer, that is allocated when the first data is received
+         */
+        static const std::size_t initial_buffer_size = 512u;
+
+        /**
+         * @brief default for the maximum size of a header
+         */
+        static const std::size_t default_max_buffer_size = 32u * 1024u;
     protected:
         ~message() {}
     };
@@ -88,8 +99,17 @@ namespace http
          */
         tools::substring        text() const;
 
+        /**
+         * @brief returns true, if the header with the given name contains the option in its comma separated list
+         *        of values. The comparison is not case sensitive.
+         */
         bool option_available(const char* header_name, const char* option) const;
 
+        /**
+         * @brief option_available() for a known header, without searching for the header
+         */
+        bool option_available(known_header header_name, const char* option) const;
+
         /**
          * @brief if there is a header with the given name a pointer to it will be returned.
          *
@@ -101,6 +121,11 @@ namespace http
          */
         const header* find_header(const char* header_name) const;
 
+        /**
+         * @brief find_header() for a known header, that takes constant time
+         */
+        const header* find_header(known_header header_name) const;
+
         /**
          * @brief returns true, if this is a 1.0 header, or in case of an 1.1 (or later)
          * header, the "Connection : close" header was found
@@ -125,6 +150,32 @@ namespace http
 
         const_iterator begin() const;
         const_iterator end() const;
+
+        /**
+         * @brief the buffer, that stores the received header, grows on demand up to this size. If a header
+         *        does not fit into max_buffer_size() bytes, parsing stops with buffer_full.
+         *
+         * The default is default_max_buffer_size.
+         */
+        std::size_t max_buffer_size() const;
+
+        /**
+         * @brief sets a new maximum buffer size
+         * @pre parsing was not started jet
+         */
+        void max_buffer_size( std::size_t new_max );
+
+        /**
+         * @brief the size of the currently allocated buffer
+         */
+        std::size_t buffer_size() const;
+
+        /**
+         * @brief releases all memory, that is used to store and parse the header, if no data was received.
+         *
+         * The memory is allocated again, when read_buffer() is called next.
+         */
+        void release_buffer();
     protected:
         message_base();
 
@@ -148,13 +199,34 @@ namespace http
          */
         explicit message_base(const char*);
 
-        ~message_base() {}
+        ~message_base();
+
+        /**
+         * @brief resets the message to the state of a default constructed message, without releasing the
+         *        memory, that was allocated to store the headers.
+         */
+        void reset();
+
+        /**
+         * @brief resets the message to the state of a message, that was constructed by the corresponding
+         *        copy_trailing_buffer constructor.
+         *
+         * old_header can be *this, the unparsed data is then moved to the front of the buffer.
+         */
+        void reset(const Type& old_header, std::size_t& remaining, copy_trailing_buffer_t);
+
+        /**
+         * @brief resets the message to the state of a message, that was constructed by the corresponding
+         *        constructor, taking the remaining data past the last body.
+         */
+        void reset(const boost::asio::const_buffers_1& old_body, std::size_t& remaining);
 
         bool parse_version(const tools::substring& version_text);
 
         // implementation of find_header that doesn't jet expects a fully, correctly parsed header, but instead
         // searchs the header parsed to far
         const header* find_header_impl(const char* header_name) const;
+        const header* find_header_impl(known_header header_name) const;
 
 
     private:
@@ -166,7 +238,20 @@ namespace http
 
         void parse_error();
 
-        char                        buffer_[ 4 * 1024 ];
+        // true, if h is not null and the option is one of the comma separated values of h
+        static bool option_in_header(const header* h, const char* option);
+
+        // removes all headers and the index of the known headers
+        void clear_headers();
+
+        // grows the buffer to at least min_size bytes. Stored data is copied and the parser state is reset, so
+        // that the stored data is parsed again by the next call to parse().
+        void grow(std::size_t min_size);
+
+        // the buffer is allocated from the shared tools::buffer_pool, when the first data is received
+        char*                       buffer_;
+        std::size_t                 buffer_size_;
+        std::size_t                 max_buffer_size_;
         std::size_t                 write_ptr_;
         std::size_t                 parse_ptr_; // already consumed including trailing CRLF
         std::size_t                 read_ptr_;  // read, but no CRLF found so far
@@ -182,6 +267,9 @@ namespace http
         } parser_state_;
 
         header_list_t               headers_;
+
+        // for every known header, the position of the first header with that name in headers_ plus one, or 0
+        std::size_t                 known_headers_[number_of_known_headers];
     };
 
 } // namespace http
@@ -9,6 +9,7 @@
 #include "tools/split.h"
 
 #include <boost/regex.hpp>
+#include <cstring>
 #include <sstream>
 
 namespace http {
@@ -115,25 +116,44 @@ namespace {
 }
 
 namespace {
-    template < class Iter >
-    std::string url_decode( Iter i, Iter end )
+    // copies the runs without a % sign (and without a + sign, if form encoded) in bulk and decodes the rest
+    char* decode( const char* begin, const char* end, char* output, bool form_encoded )
     {
-        std::string result;
-
-        for ( ; i != end; ++i )
+        for ( ;; )
         {
-            if ( *i != '%' )
+            const char* const run_end = form_encoded ? find_either( begin, end, '%', '+' ) : find_char( begin, end, '%' );
+
+            if ( output != begin )
+                std::memmove( output, begin, run_end - begin );
+
+            output += run_end - begin;
+            begin   = run_end;
+
+            if ( begin == end )
+                return output;
+
+            if ( *begin == '+' )
             {
-                result.push_back( *i );
+                *output = ' ';
+                ++begin;
             }
             else
             {
-                int value = read_nibble( ++i, end ) * 16;
-                value += read_nibble( ++i, end );
+                int value = read_nibble( begin + 1, end ) * 16;
+                value += read_nibble( begin + 2, end );
 
-                result.push_back( static_cast< char >( value ) );
+                *output = static_cast< char >( value );
+                begin += 3;
             }
+
+            ++output;
         }
+    }
+
+    std::string decode( const char* begin, const char* end, bool form_encoded )
+    {
+        std::string result( end - begin, '\0' );
+        result.resize( decode( begin, end, &result[ 0 ], form_encoded ) - &result[ 0 ] );
 
         return result;
     }
@@ -141,12 +161,17 @@ namespace {
 
 std::string url_decode(const std::string& s)
 {
-    return url_decode( s.begin(), s.end() );
+    return decode( s.data(), s.data() + s.size(), false );
 }
 
 std::string url_decode( const tools::substring& s )
 {
-    return url_decode( s.begin(), s.end() );
+    return decode( s.begin(), s.end(), false );
+}
+
+char* url_decode( const char* begin, const char* end, char* output )
+{
+    return decode( begin, end, output, false );
 }
 
 static bool special( char c )
@@ -178,26 +203,19 @@ std::string url_encode( const std::string& s )
     return out.str();
 }
 
-namespace {
-
-    template < class Iter >
-    std::string form_decode_impl( Iter begin, Iter end )
-    {
-        std::string result( begin, end );
-        std::replace( result.begin(), result.end(), '+', ' ' );
-
-        return url_decode( result.begin(), result.end() );
-    }
-}
-
 std::string form_decode( const std::string& s )
 {
-    return form_decode_impl( s.begin(), s.end() );
+    return decode( s.data(), s.data() + s.size(), true );
 }
 
 std::string form_decode( const tools::substring& s )
 {
-    return form_decode_impl( s.begin(), s.end() );
+    return decode( s.begin(), s.end(), true );
+}
+
+char* form_decode( const char* begin, const char* end, char* output )
+{
+    return decode( begin, end, output, true );
 }
 
 int strcasecmp(const char* begin1, const char* end1, const char* null_terminated_str)
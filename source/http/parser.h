@@ -15,6 +15,7 @@
 #include <utility>
 
 #include "tools/substring.h"
+#include "http/scan.h"
 
 #ifdef max
 #   undef max
@@ -44,6 +45,17 @@ Iter find_CRLS(Iter begin, Iter end) {
 	return cr_pos;
 }
 
+// finds a CRLS in a contiguous buffer, by scanning for CR with find_char()
+inline const char* find_CRLS(const char* begin, const char* end) {
+	
+	const char* cr_pos = find_char(begin, end, CR);
+	
+	while ( cr_pos != end && ( cr_pos+1 == end || *(cr_pos+1) != LS ) )
+		cr_pos = find_char(cr_pos+1, end, CR);
+	
+	return cr_pos;
+}
+
 inline bool is_space(char c) {
 	return c == SP || c == HT;
 }
@@ -202,6 +214,17 @@ std::string url_decode( const std::string& );
  */
 std::string url_decode( const tools::substring& );
 
+/**
+ * @brief decodes all encoded characters of [begin, end) into the buffer starting at output
+ *
+ * The decoded text is never longer than the encoded one, so output must point to at least end - begin characters.
+ * output may be equal to begin, to decode in place. Runs of characters without a % sign are copied in bulk.
+ *
+ * @return the end of the decoded text
+ * @throw bad_url if no valid hex number follows after a % sign
+ */
+char* url_decode( const char* begin, const char* end, char* output );
+
 /**
  * @brief encodes the given string
  * see rfc3986 for details
@@ -220,6 +243,13 @@ std::string form_decode( const std::string& );
  */
 std::string form_decode( const tools::substring& );
 
+/**
+ * @brief decodes all encoded characters of [begin, end) into the buffer starting at output
+ *
+ * Same as url_decode( const char*, const char*, char* ), but in addition all '+' are decoded to ' '.
+ */
+char* form_decode( const char* begin, const char* end, char* output );
+
 template <class Iter, typename SizeT>
 bool parse_number(Iter begin, Iter end, SizeT& r)
 {
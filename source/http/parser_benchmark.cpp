@@ -0,0 +1,111 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+#include "http/scan.h"
+#include "http/request.h"
+#include "http/response.h"
+#include "http/test_request_texts.h"
+#include "tools/elapse_timer.h"
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <cstring>
+#include <iostream>
+
+#if defined( __GNUC__ ) && ( defined( __x86_64__ ) || defined( __i386__ ) )
+#   include <x86intrin.h>
+#   define SIOUX_HTTP_BENCHMARK_RDTSC
+#endif
+
+/*
+ * measures the throughput of the header parser in bytes per cycle for every scan implementation, that is supported
+ * by the CPU. The scalar implementation is the byte by byte loop, that was used before. The input are the request and
+ * response headers from http/test_request_texts.h.
+ */
+namespace
+{
+    const unsigned iterations = 200000u;
+
+    const char* const requests[] = {
+        http::test::simple_get_11,
+        http::test::get_local_root_opera,
+        http::test::get_local_root_firefox,
+        http::test::get_local_root_internet_explorer,
+        http::test::simple_post
+    };
+
+    const char* const responses[] = {
+        http::test::cached_response_apache,
+        http::test::ok_response_header_apache
+    };
+
+    unsigned long long cycles()
+    {
+#ifdef SIOUX_HTTP_BENCHMARK_RDTSC
+        return __rdtsc();
+#else
+        return 0;
+#endif
+    }
+
+    // the message copies the text into its buffer and parses it, as a connection would do after a read
+    template < class Message >
+    std::size_t parse( const char* text )
+    {
+        const Message message( text );
+
+        return message.state() == http::message::ok ? message.text().size() : 0;
+    }
+
+    template < class Message, std::size_t S >
+    std::size_t parse_all( const char* const (&texts)[ S ] )
+    {
+        std::size_t bytes = 0;
+
+        for ( unsigned i = 0; i != iterations; ++i )
+        {
+            for ( std::size_t t = 0; t != S; ++t )
+                bytes += parse< Message >( texts[ t ] );
+        }
+
+        return bytes;
+    }
+
+    void measure( const char* name, http::scan_implementation implementation )
+    {
+        if ( !http::scan_implementation_supported( implementation ) )
+        {
+            std::cout << name << ": not supported" << std::endl;
+            return;
+        }
+
+        http::select_scan_implementation( implementation );
+
+        // fills the buffer pool
+        parse_all< http::request_header >( requests );
+
+        const tools::elapse_timer   time;
+        const unsigned long long    start = cycles();
+
+        const std::size_t bytes = parse_all< http::request_header >( requests ) + parse_all< http::response_header >( responses );
+
+        const unsigned long long                used    = cycles() - start;
+        const boost::posix_time::time_duration  elapsed = time.elapsed();
+
+        std::cout << name
+                  << ": elapsed: " << elapsed
+                  << "; bytes: " << bytes
+                  << "; ns per kB: " << elapsed.total_nanoseconds() * 1024 / bytes;
+
+        if ( used )
+            std::cout << "; bytes per cycle: " << static_cast< double >( bytes ) / static_cast< double >( used );
+
+        std::cout << std::endl;
+    }
+}
+
+int main()
+{
+    measure( "scalar", http::scan_scalar );
+    measure( "sse2", http::scan_sse2 );
+    measure( "avx2", http::scan_avx2 );
+}
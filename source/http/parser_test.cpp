@@ -40,6 +40,29 @@ BOOST_AUTO_TEST_CASE( url_decode_mixed_case_test )
     BOOST_CHECK_EQUAL( http::url_decode( "%4A%4b%4C%4d%4E" ), "JKLMN" );
 }
 
+BOOST_AUTO_TEST_CASE( url_decode_in_place )
+{
+    // long enough to have runs without % copied by the vectorized scan
+    char text[] = "message=%5B%7B%22channel%22%3A%22%2Fmeta%2Fhandshake%22%2C%22version%22%3A%221.0%22%7D%5D+x";
+    char* const end = http::url_decode( tools::begin( text ), tools::end( text ) - 1, tools::begin( text ) );
+
+    BOOST_CHECK_EQUAL( std::string( tools::begin( text ), end ),
+        "message=[{\"channel\":\"/meta/handshake\",\"version\":\"1.0\"}]+x" );
+}
+
+BOOST_AUTO_TEST_CASE( url_decode_into_buffer )
+{
+    const char text[] = "%20abc%ff%00%7f";
+    char       buffer[ sizeof text ];
+
+    char* const end = http::url_decode( tools::begin( text ), tools::end( text ) - 1, buffer );
+    BOOST_CHECK_EQUAL( std::string( buffer, end ), expected_text );
+
+    const char error[] = "abcdefghijklmnopqrstuvwxyz0123456789%a";
+    char       error_buffer[ sizeof error ];
+    BOOST_CHECK_THROW( http::url_decode( tools::begin( error ), tools::end( error ) - 1, error_buffer ), http::bad_url );
+}
+
 
 BOOST_AUTO_TEST_CASE( url_encode_test )
 {
@@ -158,3 +181,12 @@ BOOST_AUTO_TEST_CASE( form_decode_test )
 
     BOOST_CHECK_EQUAL( result, "  JK+");
 }
+
+BOOST_AUTO_TEST_CASE( form_decode_in_place )
+{
+    char text[] = "message=abcdefghijklmnopqrstuvwxyz+0123456789%2B%2b++abcdefghijklmnopqrstuvwxyz%41";
+    char* const end = http::form_decode( tools::begin( text ), tools::end( text ) - 1, tools::begin( text ) );
+
+    BOOST_CHECK_EQUAL( std::string( tools::begin( text ), end ),
+        "message=abcdefghijklmnopqrstuvwxyz 0123456789++  abcdefghijklmnopqrstuvwxyzA" );
+}
@@ -44,6 +44,24 @@ namespace http {
     {
     }
 
+    void request_header::reset()
+    {
+        static_cast< details::request_data& >( *this ) = details::request_data();
+        message_base< request_header >::reset();
+    }
+
+    void request_header::reset(const request_header& old_header, std::size_t& remaining, copy_trailing_buffer_t)
+    {
+        static_cast< details::request_data& >( *this ) = details::request_data();
+        message_base< request_header >::reset( old_header, remaining, copy_trailing_buffer );
+    }
+
+    void request_header::reset( const boost::asio::const_buffers_1& old_body, std::size_t& remaining )
+    {
+        static_cast< details::request_data& >( *this ) = details::request_data();
+        message_base< request_header >::reset( old_body, remaining );
+    }
+
     namespace {
         struct header_desc
         {
@@ -90,7 +108,7 @@ namespace http {
 
     message::error_code request_header::end_of_request()
     {
-        const header* const host_header = find_header_impl("host");
+        const header* const host_header = find_header_impl(header_host);
 
         if ( host_header == 0 )
             return bad_request();
@@ -148,7 +166,7 @@ namespace http {
 
     bool request_header::body_expected() const
     {
-        return find_header( content_length_header ) != 0 || find_header( transfer_encoding_header );
+        return find_header( header_content_length ) != 0 || find_header( header_transfer_encoding );
     }
 
     bool request_header::body_expected( http_method_code ) const
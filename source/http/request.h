@@ -70,6 +70,29 @@ namespace http
          */
         explicit request_header(const char*);
 
+        /**
+         * @brief puts a request_header into the same state as the corresponding constructor would do, without
+         *        freeing or allocating memory.
+         *
+         * This allows a request_header to be reused for the next request on a connection.
+         */
+        void reset();
+
+        /**
+         * @brief overload of reset() that takes the remaining data past the last read request header.
+         *
+         * old_header can be *this.
+         * @sa request_header(const request_header&, std::size_t&, copy_trailing_buffer_t)
+         */
+        void reset(const request_header& old_header, std::size_t& remaining, copy_trailing_buffer_t);
+
+        /**
+         * @brief overload of reset() that takes the remaining data past the last read request body.
+         *
+         * @sa request_header(const boost::asio::const_buffers_1&, std::size_t&)
+         */
+        void reset(const boost::asio::const_buffers_1& old_body, std::size_t& remaining);
+
         http::http_method_code  method() const;
 
         /**
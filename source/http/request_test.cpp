@@ -4,6 +4,7 @@
 #include "http/filter.h"
 #include <algorithm>
 #include <iterator>
+#include <string>
 
 using namespace http::test;
 
@@ -136,6 +137,59 @@ BOOST_AUTO_TEST_CASE(check_options_available)
     BOOST_CHECK(header.option_available("accept-encoding", "gzip"));
 }
 
+/**
+ * @test known headers are found by id and by name, the first header with a name is found
+ */
+BOOST_AUTO_TEST_CASE(find_known_headers)
+{
+    const http::request_header header(
+        "GET / HTTP/1.1\r\n"
+        "HOST: foo\r\n"
+        "content-length : 12\r\n"
+        "X-Content-Length: 13\r\n"
+        "Content-Length: 14\r\n"
+        "Connection: keep-alive, close\r\n"
+        "\r\n");
+
+    BOOST_REQUIRE_EQUAL(http::request_header::ok, header.state());
+
+    BOOST_REQUIRE(header.find_header(http::header_host));
+    BOOST_CHECK_EQUAL("foo", header.find_header(http::header_host)->value());
+    BOOST_CHECK_EQUAL(header.find_header(http::header_host), header.find_header("host"));
+
+    BOOST_REQUIRE(header.find_header(http::header_content_length));
+    BOOST_CHECK_EQUAL("12", header.find_header(http::header_content_length)->value());
+    BOOST_CHECK_EQUAL(header.find_header(http::header_content_length), header.find_header("Content-Length"));
+    BOOST_REQUIRE(header.find_header("x-content-length"));
+    BOOST_CHECK_EQUAL("13", header.find_header("x-content-length")->value());
+
+    BOOST_CHECK(!header.find_header(http::header_transfer_encoding));
+    BOOST_CHECK(header.option_available(http::header_connection, "close"));
+    BOOST_CHECK(!header.option_available(http::header_upgrade, "close"));
+    BOOST_CHECK(header.close_after_response());
+}
+
+/**
+ * @test the index of the known headers is cleared, when the header is reset
+ */
+BOOST_AUTO_TEST_CASE(known_headers_are_reset)
+{
+    http::request_header request(
+        "POST /foo HTTP/1.1\r\n"
+        "host: bar:8080\r\n"
+        "Transfer-Encoding: chunked\r\n"
+        "\r\n");
+
+    BOOST_REQUIRE_EQUAL(http::message::ok, request.state());
+    BOOST_CHECK(request.find_header(http::header_transfer_encoding));
+
+    request.reset();
+    BOOST_CHECK(feed_to_request(simple_get_11, request));
+    BOOST_REQUIRE_EQUAL(http::message::ok, request.state());
+    BOOST_CHECK(!request.find_header(http::header_transfer_encoding));
+    BOOST_CHECK_EQUAL("google.de", request.find_header(http::header_host)->value());
+}
+
 BOOST_AUTO_TEST_CASE(single_arguement_ctor)
 {
     const http::request_header header(
@@ -292,4 +346,125 @@ BOOST_AUTO_TEST_CASE(check_unparsed_buffer)
     BOOST_CHECK_EQUAL(3u, request.unparsed_buffer().second);
 }
 
+/**
+ * @test a reset request_header behaves like a default constructed one
+ */
+BOOST_AUTO_TEST_CASE(reset_request_header)
+{
+    http::request_header request(
+        "POST /foo HTTP/1.1\r\n"
+        "host: bar:8080\r\n"
+        "\r\n");
+
+    BOOST_REQUIRE_EQUAL(http::message::ok, request.state());
+
+    request.reset();
+    BOOST_CHECK(request.empty());
+    BOOST_CHECK_EQUAL(http::message::parsing, request.state());
+
+    BOOST_CHECK(feed_to_request(simple_get_11, request));
+    BOOST_CHECK_EQUAL(http::message::ok, request.state());
+    BOOST_CHECK_EQUAL(http::http_get, request.method());
+    BOOST_CHECK_EQUAL(80u, request.port());
+    BOOST_CHECK_EQUAL(http::request_header(simple_get_11).headers().size(), request.headers().size());
+}
+
+/**
+ * @test resetting a request_header from itself, keeps the data past the header
+ */
+BOOST_AUTO_TEST_CASE(reset_request_header_with_trailing_data)
+{
+    http::request_header request(
+        "GET / HTTP/1.1\r\n"
+        "host: foo\r\n"
+        "\r\n"
+        "GET /bar HTTP/1.1\r\n"
+        "host: bar\r\n"
+        "\r\n");
+
+    BOOST_REQUIRE_EQUAL(http::message::ok, request.state());
+    BOOST_CHECK_EQUAL("/", request.uri());
+
+    std::size_t remaining = 0;
+    request.reset(request, remaining, http::request_header::copy_trailing_buffer);
+
+    BOOST_REQUIRE(remaining != 0);
+    BOOST_CHECK(request.parse(remaining));
+    BOOST_CHECK_EQUAL(http::message::ok, request.state());
+    BOOST_CHECK_EQUAL("/bar", request.uri());
+    BOOST_CHECK_EQUAL("bar", request.host());
+    BOOST_CHECK_EQUAL(1u, request.headers().size());
+}
+
+namespace {
+    std::string request_with_large_cookie(std::size_t cookie_size)
+    {
+        return "GET / HTTP/1.1\r\n"
+               "host: foo\r\n"
+               "cookie: " + std::string(cookie_size, 'a') + "\r\n"
+               "\r\n";
+    }
+
+    // feeds the text to the header in chunks of at most 100 bytes
+    void feed_text(const std::string& text, http::request_header& header)
+    {
+        for ( std::string::size_type pos = 0; pos != text.size(); )
+        {
+            const std::pair<char*, std::size_t> mem = header.read_buffer();
+            const std::size_t size = std::min(std::min(mem.second, std::size_t(100)), text.size() - pos);
+
+            std::copy(text.begin() + pos, text.begin() + pos + size, mem.first);
+            pos += size;
+
+            if ( header.parse(size) )
+                return;
+        }
+    }
+}
 
+/**
+ * @test the buffer of a request header starts small and grows on demand
+ */
+BOOST_AUTO_TEST_CASE(header_buffer_grows_on_demand)
+{
+    http::request_header request;
+    BOOST_CHECK_EQUAL(0u, request.buffer_size());
+
+    feed_text(request_with_large_cookie(10 * 1024), request);
+
+    BOOST_REQUIRE_EQUAL(http::message::ok, request.state());
+    BOOST_CHECK_EQUAL("foo", request.host());
+    BOOST_REQUIRE(request.find_header("cookie"));
+    const tools::substring cookie = request.find_header("cookie")->value();
+    BOOST_CHECK_EQUAL(std::string(10 * 1024, 'a'), std::string(cookie.begin(), cookie.end()));
+    BOOST_CHECK_EQUAL(request_with_large_cookie(10 * 1024), std::string(request.text().begin(), request.text().end()));
+}
+
+/**
+ * @test a small request only allocates a small buffer
+ */
+BOOST_AUTO_TEST_CASE(small_header_uses_small_buffer)
+{
+    http::request_header request;
+    feed_text(request_with_large_cookie(10), request);
+
+    BOOST_REQUIRE_EQUAL(http::message::ok, request.state());
+    BOOST_CHECK_EQUAL(http::message::initial_buffer_size, request.buffer_size());
+}
+
+/**
+ * @test a header that exceeds max_buffer_size() results in buffer_full
+ */
+BOOST_AUTO_TEST_CASE(header_exceeds_max_buffer_size)
+{
+    http::request_header request;
+    request.max_buffer_size(2048);
+
+    feed_text(request_with_large_cookie(4 * 1024), request);
+    BOOST_CHECK_EQUAL(http::message::buffer_full, request.state());
+
+    http::request_header larger;
+    larger.max_buffer_size(5 * 1024);
+    feed_text(request_with_large_cookie(4 * 1024), larger);
+    BOOST_CHECK_EQUAL(http::message::ok, larger.state());
+}
@@ -0,0 +1,244 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+#include "http/scan.h"
+#include <atomic>
+#include <cassert>
+
+#if defined( __SSE2__ ) || defined( _M_X64 )
+#   include <emmintrin.h>
+#   define SIOUX_HTTP_SCAN_SSE2
+#endif
+
+// AVX2 code is compiled with a function attribute, so that the library runs on CPUs without AVX2
+#if defined( SIOUX_HTTP_SCAN_SSE2 ) && defined( __GNUC__ ) && ( defined( __x86_64__ ) || defined( __i386__ ) )
+#   include <immintrin.h>
+#   define SIOUX_HTTP_SCAN_AVX2
+#endif
+
+namespace http {
+
+    namespace {
+        typedef const char* ( *finder_t )( const char*, const char*, char );
+        typedef const char* ( *either_finder_t )( const char*, const char*, char, char );
+
+        const char* find_scalar( const char* begin, const char* end, char c )
+        {
+            for ( ; begin != end && *begin != c; ++begin )
+                ;
+
+            return begin;
+        }
+
+        const char* find_either_scalar( const char* begin, const char* end, char a, char b )
+        {
+            for ( ; begin != end && *begin != a && *begin != b; ++begin )
+                ;
+
+            return begin;
+        }
+
+#ifdef SIOUX_HTTP_SCAN_SSE2
+        inline unsigned first_bit( unsigned mask )
+        {
+#   ifdef __GNUC__
+            return __builtin_ctz( mask );
+#   else
+            unsigned result = 0;
+            for ( ; ( mask & 1u ) == 0; mask >>= 1 )
+                ++result;
+
+            return result;
+#   endif
+        }
+
+        const char* find_sse2( const char* begin, const char* end, char c )
+        {
+            const __m128i pattern = _mm_set1_epi8( c );
+
+            for ( ; end - begin >= 16; begin += 16 )
+            {
+                const __m128i  chunk = _mm_loadu_si128( reinterpret_cast< const __m128i* >( begin ) );
+                const unsigned mask  = _mm_movemask_epi8( _mm_cmpeq_epi8( chunk, pattern ) );
+
+                if ( mask )
+                    return begin + first_bit( mask );
+            }
+
+            return find_scalar( begin, end, c );
+        }
+
+        const char* find_either_sse2( const char* begin, const char* end, char a, char b )
+        {
+            const __m128i pattern_a = _mm_set1_epi8( a );
+            const __m128i pattern_b = _mm_set1_epi8( b );
+
+            for ( ; end - begin >= 16; begin += 16 )
+            {
+                const __m128i  chunk = _mm_loadu_si128( reinterpret_cast< const __m128i* >( begin ) );
+                const unsigned mask  = _mm_movemask_epi8(
+                    _mm_or_si128( _mm_cmpeq_epi8( chunk, pattern_a ), _mm_cmpeq_epi8( chunk, pattern_b ) ) );
+
+                if ( mask )
+                    return begin + first_bit( mask );
+            }
+
+            return find_either_scalar( begin, end, a, b );
+        }
+#endif
+
+#ifdef SIOUX_HTTP_SCAN_AVX2
+        __attribute__(( target( "avx2" ) ))
+        const char* find_avx2( const char* begin, const char* end, char c )
+        {
+            const __m256i pattern = _mm256_set1_epi8( c );
+
+            for ( ; end - begin >= 32; begin += 32 )
+            {
+                const __m256i  chunk = _mm256_loadu_si256( reinterpret_cast< const __m256i* >( begin ) );
+                const unsigned mask  = _mm256_movemask_epi8( _mm256_cmpeq_epi8( chunk, pattern ) );
+
+                if ( mask )
+                    return begin + first_bit( mask );
+            }
+
+            return find_sse2( begin, end, c );
+        }
+
+        __attribute__(( target( "avx2" ) ))
+        const char* find_either_avx2( const char* begin, const char* end, char a, char b )
+        {
+            const __m256i pattern_a = _mm256_set1_epi8( a );
+            const __m256i pattern_b = _mm256_set1_epi8( b );
+
+            for ( ; end - begin >= 32; begin += 32 )
+            {
+                const __m256i  chunk = _mm256_loadu_si256( reinterpret_cast< const __m256i* >( begin ) );
+                const unsigned mask  = _mm256_movemask_epi8(
+                    _mm256_or_si256( _mm256_cmpeq_epi8( chunk, pattern_a ), _mm256_cmpeq_epi8( chunk, pattern_b ) ) );
+
+                if ( mask )
+                    return begin + first_bit( mask );
+            }
+
+            return find_either_sse2( begin, end, a, b );
+        }
+#endif
+
+        finder_t finder( scan_implementation implementation )
+        {
+            switch ( implementation )
+            {
+#ifdef SIOUX_HTTP_SCAN_SSE2
+            case scan_sse2:
+                return &find_sse2;
+#endif
+#ifdef SIOUX_HTTP_SCAN_AVX2
+            case scan_avx2:
+                return &find_avx2;
+#endif
+            default:
+                return &find_scalar;
+            }
+        }
+
+        either_finder_t either_finder( scan_implementation implementation )
+        {
+            switch ( implementation )
+            {
+#ifdef SIOUX_HTTP_SCAN_SSE2
+            case scan_sse2:
+                return &find_either_sse2;
+#endif
+#ifdef SIOUX_HTTP_SCAN_AVX2
+            case scan_avx2:
+                return &find_either_avx2;
+#endif
+            default:
+                return &find_either_scalar;
+            }
+        }
+
+        scan_implementation fastest_implementation()
+        {
+            if ( scan_implementation_supported( scan_avx2 ) )
+                return scan_avx2;
+
+            if ( scan_implementation_supported( scan_sse2 ) )
+                return scan_sse2;
+
+            return scan_scalar;
+        }
+
+        const char* find_first_call( const char* begin, const char* end, char c );
+        const char* find_either_first_call( const char* begin, const char* end, char a, char b );
+
+        // starts with a function, that chooses the implementation at the first call, so the choice does not depend
+        // on the order of static initialization
+        std::atomic< finder_t >             current_finder( &find_first_call );
+        std::atomic< either_finder_t >      current_either_finder( &find_either_first_call );
+        std::atomic< scan_implementation >  current_implementation( scan_scalar );
+
+        const char* find_first_call( const char* begin, const char* end, char c )
+        {
+            select_scan_implementation( fastest_implementation() );
+
+            return current_finder.load( std::memory_order_relaxed )( begin, end, c );
+        }
+
+        const char* find_either_first_call( const char* begin, const char* end, char a, char b )
+        {
+            select_scan_implementation( fastest_implementation() );
+
+            return current_either_finder.load( std::memory_order_relaxed )( begin, end, a, b );
+        }
+    }
+
+    bool scan_implementation_supported( scan_implementation implementation )
+    {
+        switch ( implementation )
+        {
+        case scan_scalar:
+            return true;
+#ifdef SIOUX_HTTP_SCAN_SSE2
+        case scan_sse2:
+            return true;
+#endif
+#ifdef SIOUX_HTTP_SCAN_AVX2
+        case scan_avx2:
+            return __builtin_cpu_supports( "avx2" );
+#endif
+        default:
+            return false;
+        }
+    }
+
+    scan_implementation current_scan_implementation()
+    {
+        if ( current_finder.load( std::memory_order_relaxed ) == &find_first_call )
+            select_scan_implementation( fastest_implementation() );
+
+        return current_implementation.load( std::memory_order_relaxed );
+    }
+
+    void select_scan_implementation( scan_implementation implementation )
+    {
+        assert( scan_implementation_supported( implementation ) );
+
+        current_implementation.store( implementation, std::memory_order_relaxed );
+        current_finder.store( finder( implementation ), std::memory_order_relaxed );
+        current_either_finder.store( either_finder( implementation ), std::memory_order_relaxed );
+    }
+
+    const char* find_char( const char* begin, const char* end, char c )
+    {
+        return current_finder.load( std::memory_order_relaxed )( begin, end, c );
+    }
+
+    const char* find_either( const char* begin, const char* end, char a, char b )
+    {
+        return current_either_finder.load( std::memory_order_relaxed )( begin, end, a, b );
+    }
+
+} // namespace http
@@ -0,0 +1,58 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+#ifndef SIOUX_SOURCE_HTTP_SCAN_H
+#define SIOUX_SOURCE_HTTP_SCAN_H
+
+namespace http {
+
+    /**
+     * @brief the implementations available to scan a buffer for a single character
+     */
+    enum scan_implementation
+    {
+        scan_scalar,
+        scan_sse2,
+        scan_avx2
+    };
+
+    /**
+     * @brief returns true, if the implementation is compiled in and supported by the current CPU
+     */
+    bool scan_implementation_supported( scan_implementation implementation );
+
+    /**
+     * @brief the implementation, that is used by find_char() and find_either()
+     *
+     * By default, this is the fastest implementation supported by the current CPU, chosen at the first call
+     * of find_char() or find_either().
+     */
+    scan_implementation current_scan_implementation();
+
+    /**
+     * @brief changes the implementation used by find_char() and find_either(); intended for tests and benchmarks
+     * @pre scan_implementation_supported( implementation )
+     */
+    void select_scan_implementation( scan_implementation implementation );
+
+    /**
+     * @brief returns a pointer to the first occurrence of c in [begin, end) or end, if c was not found
+     *
+     * Compares 16 (SSE2) or 32 (AVX2) characters at once.
+     */
+    const char* find_char( const char* begin, const char* end, char c );
+
+    inline char* find_char( char* begin, char* end, char c )
+    {
+        return const_cast< char* >( find_char( static_cast< const char* >( begin ), static_cast< const char* >( end ), c ) );
+    }
+
+    /**
+     * @brief returns a pointer to the first occurrence of a or b in [begin, end) or end, if neither was found
+     */
+    const char* find_either( const char* begin, const char* end, char a, char b );
+
+} // namespace http
+
+#endif // include guard
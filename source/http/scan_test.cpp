@@ -0,0 +1,158 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+#include <boost/test/unit_test.hpp>
+#include "http/scan.h"
+#include "http/parser.h"
+#include "http/request.h"
+#include "http/test_request_texts.h"
+#include "tools/iterators.h"
+#include <algorithm>
+#include <vector>
+
+namespace {
+    const http::scan_implementation all_implementations[] = { http::scan_scalar, http::scan_sse2, http::scan_avx2 };
+
+    // selects every supported implementation for the life time of the object and restores the current one afterwards
+    struct restore_implementation
+    {
+        restore_implementation() : old( http::current_scan_implementation() ) {}
+        ~restore_implementation() { http::select_scan_implementation( old ); }
+
+        const http::scan_implementation old;
+    };
+}
+
+/**
+ * @test find_char() finds the first occurrence for every position of the character and for every alignment of the
+ *       buffer, with every supported implementation.
+ */
+BOOST_FIXTURE_TEST_CASE( find_char_finds_first_occurrence, restore_implementation )
+{
+    BOOST_CHECK( http::scan_implementation_supported( http::scan_scalar ) );
+
+    std::vector< char > buffer( 100, 'a' );
+
+    for ( const http::scan_implementation* impl = tools::begin( all_implementations ); impl != tools::end( all_implementations ); ++impl )
+    {
+        if ( !http::scan_implementation_supported( *impl ) )
+            continue;
+
+        http::select_scan_implementation( *impl );
+        BOOST_CHECK_EQUAL( http::current_scan_implementation(), *impl );
+
+        for ( std::size_t begin = 0; begin != 8; ++begin )
+        {
+            for ( std::size_t end = begin; end != buffer.size(); ++end )
+            {
+                const char* const first = &buffer[ 0 ] + begin;
+                const char* const last  = &buffer[ 0 ] + end;
+
+                BOOST_CHECK( http::find_char( first, last, '\r' ) == last );
+
+                for ( std::size_t pos = begin; pos != end; ++pos )
+                {
+                    buffer[ pos ] = '\r';
+
+                    // a second occurrence must not be found
+                    if ( pos + 1 != end )
+                        buffer[ pos + 1 ] = '\r';
+
+                    BOOST_CHECK( http::find_char( first, last, '\r' ) == &buffer[ 0 ] + pos );
+
+                    buffer[ pos ] = 'a';
+                    buffer[ pos + 1 ] = 'a';
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @test characters with the highest bit set are found
+ */
+BOOST_FIXTURE_TEST_CASE( find_char_finds_non_ascii, restore_implementation )
+{
+    std::vector< char > buffer( 64, '\x7f' );
+    buffer[ 40 ] = '\xff';
+
+    for ( const http::scan_implementation* impl = tools::begin( all_implementations ); impl != tools::end( all_implementations ); ++impl )
+    {
+        if ( !http::scan_implementation_supported( *impl ) )
+            continue;
+
+        http::select_scan_implementation( *impl );
+        BOOST_CHECK( http::find_char( &buffer[ 0 ], &buffer[ 0 ] + buffer.size(), '\xff' ) == &buffer[ 40 ] );
+    }
+}
+
+/**
+ * @test find_either() finds the first occurrence of any of both characters for every position, with every supported
+ *       implementation.
+ */
+BOOST_FIXTURE_TEST_CASE( find_either_finds_first_occurrence, restore_implementation )
+{
+    std::vector< char > buffer( 100, 'a' );
+    const char* const   first = &buffer[ 0 ];
+    const char* const   last  = &buffer[ 0 ] + buffer.size();
+
+    for ( const http::scan_implementation* impl = tools::begin( all_implementations ); impl != tools::end( all_implementations ); ++impl )
+    {
+        if ( !http::scan_implementation_supported( *impl ) )
+            continue;
+
+        http::select_scan_implementation( *impl );
+
+        BOOST_CHECK( http::find_either( first, last, '%', '+' ) == last );
+
+        for ( std::size_t pos = 0; pos != buffer.size(); ++pos )
+        {
+            buffer[ pos ] = pos % 2 ? '%' : '+';
+
+            // a later occurrence of the other character must not be found
+            if ( pos + 1 != buffer.size() )
+                buffer[ pos + 1 ] = pos % 2 ? '+' : '%';
+
+            BOOST_CHECK( http::find_either( first, last, '%', '+' ) == first + pos );
+            BOOST_CHECK( http::find_either( first + pos + 1, last, '%', '+' ) == ( pos + 1 != buffer.size() ? first + pos + 1 : last ) );
+
+            buffer[ pos ] = 'a';
+            if ( pos + 1 != buffer.size() )
+                buffer[ pos + 1 ] = 'a';
+        }
+    }
+}
+
+/**
+ * @test find_CRLS() skips CRs without LF
+ */
+BOOST_AUTO_TEST_CASE( find_crls_in_buffer )
+{
+    const char text[] = "abc\rdef\r\rghijklmnopqrstuvwxyz0123456789\r\nxyz\r";
+    const char* const end = tools::end( text ) - 1;
+
+    BOOST_CHECK( http::find_CRLS( tools::begin( text ), end ) == tools::begin( text ) + 39 );
+    BOOST_CHECK( http::find_CRLS( tools::begin( text ) + 41, end ) == end );
+}
+
+/**
+ * @test all implementations parse a request header to the same result
+ */
+BOOST_FIXTURE_TEST_CASE( parse_with_every_implementation, restore_implementation )
+{
+    for ( const http::scan_implementation* impl = tools::begin( all_implementations ); impl != tools::end( all_implementations ); ++impl )
+    {
+        if ( !http::scan_implementation_supported( *impl ) )
+            continue;
+
+        http::select_scan_implementation( *impl );
+
+        const http::request_header request( http::test::get_local_root_firefox );
+
+        BOOST_REQUIRE_EQUAL( request.state(), http::request_header::ok );
+        BOOST_CHECK_EQUAL( request.headers().size(), 8u );
+        BOOST_REQUIRE( request.find_header( "Keep-Alive" ) );
+        BOOST_CHECK_EQUAL( request.find_header( "Keep-Alive" )->value(), "115" );
+    }
+}
@@ -47,6 +47,25 @@ namespace json
         virtual void to_json(std::vector<boost::asio::const_buffer>& const_buffer_sequence) const = 0;
         virtual type_code code() const = 0;
         virtual const char* name() const = 0;
+
+        // true, if this or a contained value refers to a block of a parser
+        virtual bool shares_text() const
+        {
+            return false;
+        }
+
+        // a copy of this, where all strings and numbers own their text; only called, if shares_text() is true
+        virtual boost::shared_ptr<impl> own_text() const
+        {
+            assert( !"own_text() called for a value, that doesn't share text" );
+            return boost::shared_ptr<impl>();
+        }
+
+    protected:
+        static bool text_shared(const value& v)
+        {
+            return v.pimpl_->shares_text();
+        }
     };
 
     namespace {
@@ -64,12 +83,88 @@ namespace json
             virtual ~impl_visitor() {}
         };
 
-        bool less_impl(const std::vector<char>& lhs, const std::vector<char>& rhs)
+        /*
+         * the serialized text of a string or a number. The text is either owned, or it is a slice of a
+         * shared block of memory, that was filled by a parser.
+         */
+        class text
+        {
+        public:
+            text()
+                : owned_()
+                , block_()
+                , offset_(0)
+                , size_(0)
+            {
+            }
+
+            explicit text(std::vector<char>& t)
+                : owned_()
+                , block_()
+                , offset_(0)
+                , size_(t.size())
+            {
+                owned_.swap(t);
+            }
+
+            text(const boost::shared_ptr<const std::vector<char> >& block, std::size_t offset, std::size_t size)
+                : owned_()
+                , block_(block)
+                , offset_(offset)
+                , size_(size)
+            {
+                assert(offset + size <= block->size());
+            }
+
+            const char* begin() const
+            {
+                if ( block_.get() )
+                    return &(*block_)[0] + offset_;
+
+                return owned_.empty() ? 0 : &owned_[0];
+            }
+
+            const char* end() const
+            {
+                return begin() + size_;
+            }
+
+            std::size_t size() const
+            {
+                return size_;
+            }
+
+            boost::asio::const_buffer buffer() const
+            {
+                return boost::asio::const_buffer(begin(), size_);
+            }
+
+            // true, if the text is a slice of a shared block
+            bool shared() const
+            {
+                return block_.get() != 0;
+            }
+
+            // a copy of the text, that owns the text
+            text owned_copy() const
+            {
+                std::vector<char> copy(begin(), end());
+                return text(copy);
+            }
+
+        private:
+            std::vector<char>                           owned_;
+            boost::shared_ptr<const std::vector<char> > block_;
+            std::size_t                                 offset_;
+            std::size_t                                 size_;
+        };
+
+        bool less_impl(const text& lhs, const text& rhs)
         {
             if ( lhs.size() != rhs.size() )
                 return lhs.size() < rhs.size();
 
-            const std::pair<std::vector<char>::const_iterator, std::vector<char>::const_iterator> found =
+            const std::pair<const char*, const char*> found =
                 std::mismatch(lhs.begin(), lhs.end(), rhs.begin());
 
             return found.first != lhs.end() && *found.first < *found.second;
@@ -79,8 +174,13 @@ namespace json
         {
         public:
             explicit string_impl( std::vector<char>& v )
+                : data_( v )
+            {
+            }
+
+            explicit string_impl( const text& t )
+                : data_( t )
             {
-                data_.swap( v );
             }
 
             string_impl( const char* begin, const char* end )
@@ -143,50 +243,52 @@ namespace json
 
             void init( const char* s, const char* end )
             {
-                data_.push_back('\"');
+                std::vector<char> encoded;
+                encoded.push_back('\"');
 
                 for ( ; cont( s, end ); ++s )
                 {
                     switch ( *s )
                     {
                     case '\"' :
-                        data_.push_back('\\');
-                        data_.push_back('\"');
+                        encoded.push_back('\\');
+                        encoded.push_back('\"');
                         break;
                     case '\\' :
-                        data_.push_back('\\');
-                        data_.push_back('\\');
+                        encoded.push_back('\\');
+                        encoded.push_back('\\');
                         break;
 /* @todo Until the compare bug is fixed                    case '/' :
-                        data_.push_back('\\');
-                        data_.push_back('/');
+                        encoded.push_back('\\');
+                        encoded.push_back('/');
                         break;*/
                     case '\b' :
-                        data_.push_back('\\');
-                        data_.push_back('b');
+                        encoded.push_back('\\');
+                        encoded.push_back('b');
                         break;
                     case '\f' :
-                        data_.push_back('\\');
-                        data_.push_back('f');
+                        encoded.push_back('\\');
+                        encoded.push_back('f');
                         break;
                     case '\n' :
-                        data_.push_back('\\');
-                        data_.push_back('n');
+                        encoded.push_back('\\');
+                        encoded.push_back('n');
                         break;
                     case '\r' :
-                        data_.push_back('\\');
-                        data_.push_back('r');
+                        encoded.push_back('\\');
+                        encoded.push_back('r');
                         break;
                     case '\t' :
-                        data_.push_back('\\');
-                        data_.push_back('t');
+                        encoded.push_back('\\');
+                        encoded.push_back('t');
                         break;
                     default:
-                        data_.push_back(*s);
+                        encoded.push_back(*s);
                     }
                 }
 
-                data_.push_back('\"');
+                encoded.push_back('\"');
+                data_ = text( encoded );
             }
 
             void visit(const impl_visitor& v) const 
@@ -201,7 +303,17 @@ namespace json
 
             void to_json(std::vector<boost::asio::const_buffer>& const_buffer_sequence) const
             {
-                const_buffer_sequence.push_back(boost::asio::buffer(data_));
+                const_buffer_sequence.push_back(data_.buffer());
+            }
+
+            bool shares_text() const
+            {
+                return data_.shared();
+            }
+
+            boost::shared_ptr<value::impl> own_text() const
+            {
+                return boost::shared_ptr<value::impl>(new string_impl(data_.owned_copy()));
             }
 
             type_code code() const
@@ -214,7 +326,7 @@ namespace json
                 return "string";
             }
 
-            std::vector<char>   data_;
+            text    data_;
         };
 
         ///////////////////////////////////////
@@ -223,16 +335,24 @@ namespace json
         {
         public:
             explicit number_impl(std::vector<char>& buffer)
+                : data_(buffer)
+            {
+            }
+
+            explicit number_impl(const text& t)
+                : data_(t)
             {
-                data_.swap(buffer);
             }
 
             explicit number_impl(int val)
                 : data_()   
             {
+                std::vector<char> digits;
+
                 if ( val == 0 )
                 {
-                    data_.push_back('0');
+                    digits.push_back('0');
+                    data_ = text(digits);
                     return;
                 }
 
@@ -246,18 +366,21 @@ namespace json
 
                 for ( ; val != 0; val = val / 10)
                 {
-                    data_.insert(data_.begin(), (val % 10) + '0');
+                    digits.insert(digits.begin(), (val % 10) + '0');
                 }
 
                 if ( negativ )
-                    data_.insert(data_.begin(), '-');
+                    digits.insert(digits.begin(), '-');
+
+                data_ = text(digits);
             }
 
             explicit number_impl(double val)
                 : data_()
             {
                 const std::string s = tools::as_string(val);
-                data_.insert(data_.begin(), s.begin(), s.end());
+                std::vector<char> data(s.begin(), s.end());
+                data_ = text(data);
             }
 
             bool operator<(const number_impl& rhs) const
@@ -267,7 +390,7 @@ namespace json
 
             int to_int() const
             {
-                const tools::basic_substring<std::vector<char>::const_iterator> s(data_.begin(), data_.end());
+                const tools::basic_substring<const char*> s(data_.begin(), data_.end());
                 return boost::lexical_cast<int>(s);
             }
         private:
@@ -283,7 +406,17 @@ namespace json
 
             void to_json(std::vector<boost::asio::const_buffer>& const_buffer_sequence) const
             {
-                const_buffer_sequence.push_back(boost::asio::buffer(data_));
+                const_buffer_sequence.push_back(data_.buffer());
+            }
+
+            bool shares_text() const
+            {
+                return data_.shared();
+            }
+
+            boost::shared_ptr<value::impl> own_text() const
+            {
+                return boost::shared_ptr<value::impl>(new number_impl(data_.owned_copy()));
             }
 
             type_code code() const 
@@ -296,7 +429,7 @@ namespace json
                 return "number";
             }
 
-            std::vector<char>   data_;
+            text    data_;
         };
 
         ////////////////////
@@ -412,6 +545,27 @@ namespace json
                 const_buffer_sequence.push_back(boost::asio::buffer(close));
             }
 
+            bool shares_text() const
+            {
+                for ( list_t::const_iterator i = members_.begin(); i != members_.end(); ++i )
+                {
+                    if ( text_shared(i->first) || text_shared(i->second) )
+                        return true;
+                }
+
+                return false;
+            }
+
+            boost::shared_ptr<value::impl> own_text() const
+            {
+                const boost::shared_ptr<object_impl> result(new object_impl);
+
+                for ( list_t::const_iterator i = members_.begin(); i != members_.end(); ++i )
+                    result->add(i->first.own_text().upcast<string>(), i->second.own_text());
+
+                return result;
+            }
+
             type_code code() const
             {
                 return object_code;
@@ -535,6 +689,28 @@ namespace json
                 const_buffer_sequence.push_back(boost::asio::buffer(close));
             }
 
+            bool shares_text() const
+            {
+                for ( list_t::const_iterator i = members_.begin(); i != members_.end(); ++i )
+                {
+                    if ( text_shared(*i) )
+                        return true;
+                }
+
+                return false;
+            }
+
+            boost::shared_ptr<value::impl> own_text() const
+            {
+                const boost::shared_ptr<array_impl> result(new array_impl);
+                result->members_.reserve(members_.size());
+
+                for ( list_t::const_iterator i = members_.begin(); i != members_.end(); ++i )
+                    result->add(i->own_text());
+
+                return result;
+            }
+
             type_code code() const
             {
                 return array_code;
@@ -1193,6 +1369,13 @@ namespace json
         pimpl_.swap( other.pimpl_ );
     }
 
+    value value::own_text() const
+    {
+        return pimpl_->shares_text()
+            ? value( pimpl_->own_text() )
+            : *this;
+    }
+
     value::value(impl* p)
         : pimpl_(p)
     {
@@ -1276,10 +1459,22 @@ namespace json
     }
 
     parser::parser()
+        : block_size_( 0 )
+        , block_()
+        , token_start_( 0 )
     {
         state_.push( idle_parsing );
     }
 
+    parser::parser( std::size_t block_size )
+        : block_size_( block_size )
+        , block_()
+        , token_start_( 0 )
+    {
+        assert( block_size != 0 );
+        state_.push( idle_parsing );
+    }
+
     static const char* eat_white_space(const char* begin, const char* end)
     {
         for ( ; begin != end && ( *begin == ' ' || *begin == '\t' || *begin == '\n' || *begin == '\r' ); ++begin )
@@ -1447,14 +1642,14 @@ namespace json
 
             if ( !stop )
             {
-                buffer_.push_back(*begin);
+                token_append(*begin);
                 ++begin;
             }
         }
 
         if ( stop )
         {
-            value_parsed(value(new number_impl(buffer_)));
+            value_parsed(token_to_number());
         }
 
         return begin;
@@ -1604,11 +1799,11 @@ namespace json
             {
             case start_string_parsing: 
                 assert(*begin == '\"');
-                assert(buffer_.empty());
+                assert(token_size() == 0);
 
                 state_.top() = string_parsing;
 
-                buffer_.push_back(*begin);
+                token_append(*begin);
                 ++begin;
                 break;
             case string_parsing:
@@ -1617,15 +1812,15 @@ namespace json
                     for ( ; p != end && *p != '\"' && *p != '\\'; ++p )
                         ;
 
-                    buffer_.insert( buffer_.end(), begin, p );
+                    token_append( begin, p );
                     begin = p;
 
                     if ( begin != end )
                     {
-                        buffer_.push_back( *begin );
+                        token_append( *begin );
                         if ( *begin == '\"' )
                         {
-                            value_parsed( value( new string_impl( buffer_ ) ) );
+                            value_parsed( token_to_string() );
                             stop = true;
                         }
                         else 
@@ -1657,7 +1852,7 @@ namespace json
                         state_.top() = string_parsing;
                     }
 
-                    buffer_.push_back(*begin);
+                    token_append(*begin);
                     ++begin;
                 }
                 break;
@@ -1670,7 +1865,7 @@ namespace json
                     if (!std::isxdigit(*begin))
                         throw parse_error("Hex-Digit expected.");
 
-                    buffer_.push_back(*begin);
+                    token_append(*begin);
                     ++begin;
 
                     ++state_.top();
@@ -1714,6 +1909,68 @@ namespace json
         result_.push( v );
     }
 
+    void parser::token_append( const char* begin, const char* end )
+    {
+        if ( block_size_ == 0 )
+        {
+            buffer_.insert( buffer_.end(), begin, end );
+            return;
+        }
+
+        const std::size_t size = end - begin;
+
+        // the block must never be reallocated, as already parsed values refer to it
+        if ( !block_.get() || block_->capacity() - block_->size() < size )
+        {
+            const std::size_t token = token_size();
+            block_ptr new_block( new std::vector< char > );
+            new_block->reserve( std::max( block_size_, 2 * ( token + size ) ) );
+
+            if ( block_.get() )
+                new_block->insert( new_block->end(), block_->begin() + token_start_, block_->end() );
+
+            block_.swap( new_block );
+            token_start_ = 0;
+        }
+
+        block_->insert( block_->end(), begin, end );
+    }
+
+    void parser::token_append( char c )
+    {
+        token_append( &c, &c + 1 );
+    }
+
+    std::size_t parser::token_size() const
+    {
+        if ( block_size_ == 0 )
+            return buffer_.size();
+
+        return block_.get() ? block_->size() - token_start_ : 0;
+    }
+
+    value parser::token_to_string()
+    {
+        if ( block_size_ == 0 )
+            return value( new string_impl( buffer_ ) );
+
+        const std::size_t start = token_start_;
+        token_start_ = block_->size();
+
+        return value( new string_impl( text( block_, start, token_start_ - start ) ) );
+    }
+
+    value parser::token_to_number()
+    {
+        if ( block_size_ == 0 )
+            return value( new number_impl( buffer_ ) );
+
+        const std::size_t start = token_start_;
+        token_start_ = block_->size();
+
+        return value( new number_impl( text( block_, start, token_start_ - start ) ) );
+    }
+
     value parser::result() const   
     {
         assert( state_.empty() );
@@ -1730,7 +1987,7 @@ namespace json
             if ( !is_complete_number( state_.top() ) )
                 throw parse_error( "incomplete json number" );
 
-            value_parsed( value( new number_impl( buffer_ ) ) );
+            value_parsed( token_to_number() );
         }
 
         if ( !state_.empty() || result_.size() != 1 )
@@ -124,6 +124,16 @@ namespace json
          * @exception none _
          */
         void swap( value& other );
+
+        /**
+         * @brief returns a value, equal to this, where all strings and numbers own their text
+         *
+         * Values parsed by a parser with a block size keep the parser's blocks alive. Values, that are kept
+         * longer than the parsed request, should be copied by this function, so that a small value doesn't keep
+         * a whole block alive. If this doesn't refer to any block, this is returned without copying.
+         * @sa parser::parser( std::size_t block_size )
+         */
+        value own_text() const;
     protected:
         explicit value(impl*);
         explicit value(const boost::shared_ptr<impl>& impl);
@@ -480,12 +490,30 @@ namespace json
 
     /**
      * @brief a state full json parser
+     *
+     * By default, the text of every parsed string and number is copied into memory, that is owned by the
+     * parsed value. A parser constructed with a block size, collects the text of all strings and numbers in
+     * shared, reference counted blocks of memory instead and the parsed values refer to slices of these
+     * blocks. This avoids one allocation per string and number, but a block is only released, when the last
+     * value referring to the block is destroyed. Values, that outlive the parsed request, should be copied
+     * with value::own_text().
      */
     class parser
     {
     public:
         parser();
 
+        /**
+         * @brief constructs a parser, that collects the text of parsed strings and numbers in shared blocks
+         *        of at least block_size bytes.
+         */
+        explicit parser( std::size_t block_size );
+
+        /**
+         * @brief block size, suitable to parse request bodies read from a connection
+         */
+        static const std::size_t default_block_size = 4096u;
+
         /**
          * @brief tries to parse a json value by consuming the sequence [begin, end)
          *
@@ -502,6 +530,32 @@ namespace json
             return parse( &buffer[ 0 ], &buffer[ 0 ] + buffer.size() );
         }
 
+        /**
+         * @brief parses the buffers of the given buffer sequence in order, as if parse() would be called for
+         *        every single buffer.
+         *
+         * Values and tokens can span buffer boundaries. Parsing stops at the end of a parsed value.
+         * @return see parse(); first is false, if not all buffers where consumed
+         */
+        template < class ConstBufferSequence >
+        std::pair< bool, bool > parse_buffers( const ConstBufferSequence& buffers )
+        {
+            typename ConstBufferSequence::const_iterator buffer = buffers.begin();
+            std::pair< bool, bool > result( true, state_.empty() );
+
+            for ( ; buffer != buffers.end() && !result.second; ++buffer )
+            {
+                const char* const begin = boost::asio::buffer_cast< const char* >( *buffer );
+                result = parse( begin, begin + boost::asio::buffer_size( *buffer ) );
+            }
+
+            // a value was parsed before all buffers where consumed
+            for ( ; buffer != buffers.end() && result.first; ++buffer )
+                result.first = boost::asio::buffer_size( *buffer ) == 0;
+
+            return result;
+        }
+
         /**
          * @brief indicates that no more data will follow
          *
@@ -528,9 +582,24 @@ namespace json
 
         void value_parsed( const value& );
 
+        // collecting the text of the currently parsed string or number
+        void token_append( const char* begin, const char* end );
+        void token_append( char c );
+        std::size_t token_size() const;
+        value token_to_string();
+        value token_to_number();
+
+        typedef boost::shared_ptr< std::vector< char > > block_ptr;
+
         std::vector< char >   buffer_;
         std::stack< value >   result_;
         std::stack< int >     state_;
+
+        // 0, if every value owns its text
+        const std::size_t     block_size_;
+        block_ptr             block_;
+        // start of the current token within block_
+        std::size_t           token_start_;
     };
 
     /**
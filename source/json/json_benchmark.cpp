@@ -0,0 +1,105 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+#include "json/json.h"
+#include "tools/elapse_timer.h"
+#include <boost/asio/buffer.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+/*
+ * compares the default parser with a parser, that collects the text of strings and numbers in shared blocks,
+ * by parsing ./source/json/fixtures.json. The block parser is fed with chunks of the size of a typical TCP
+ * segment, as it would be when parsing directly from a connections read buffer.
+ */
+namespace
+{
+    std::size_t allocations = 0;
+}
+
+void* operator new( std::size_t size )
+{
+    ++allocations;
+
+    if ( void* const result = std::malloc( size ? size : 1 ) )
+        return result;
+
+    throw std::bad_alloc();
+}
+
+void operator delete( void* p ) throw()
+{
+    std::free( p );
+}
+
+namespace
+{
+    const unsigned      iterations = 1000u;
+    const std::size_t   chunk_size = 1460u;
+
+    typedef std::vector< boost::asio::const_buffer > buffer_list;
+
+    buffer_list split( const std::vector< char >& text )
+    {
+        buffer_list result;
+
+        for ( std::size_t pos = 0; pos < text.size(); pos += chunk_size )
+            result.push_back( boost::asio::buffer( &text[ pos ], std::min( chunk_size, text.size() - pos ) ) );
+
+        return result;
+    }
+
+    void report( const char* name, const tools::elapse_timer& time, std::size_t allocs )
+    {
+        const boost::posix_time::time_duration elapsed = time.elapsed();
+
+        std::cout << name
+                  << ": elapsed: " << elapsed
+                  << "; per parse: " << elapsed.total_microseconds() / iterations << "us"
+                  << "; allocations per parse: " << allocs / iterations << std::endl;
+    }
+}
+
+int main()
+{
+    std::ifstream input( "./source/json/fixtures.json" );
+    const std::vector< char > text( ( std::istreambuf_iterator< char >( input ) ), std::istreambuf_iterator< char >() );
+    const buffer_list chunks = split( text );
+
+    std::cout << "fixture size: " << text.size() << "; chunks: " << chunks.size() << std::endl;
+
+    {
+        const std::size_t start_allocations = allocations;
+        const tools::elapse_timer time;
+
+        for ( unsigned i = 0; i != iterations; ++i )
+        {
+            json::parser parser;
+            parser.parse( &text[ 0 ], &text[ 0 ] + text.size() );
+            parser.flush();
+        }
+
+        report( "default parser", time, allocations - start_allocations );
+    }
+
+    {
+        const std::size_t start_allocations = allocations;
+        const tools::elapse_timer time;
+
+        for ( unsigned i = 0; i != iterations; ++i )
+        {
+            json::parser parser( json::parser::default_block_size );
+            parser.parse_buffers( chunks );
+            parser.flush();
+        }
+
+        report( "block parser", time, allocations - start_allocations );
+    }
+}
@@ -653,3 +653,116 @@ BOOST_AUTO_TEST_CASE( std_to_json_string )
     BOOST_CHECK_EQUAL( s.to_std_string(), std );
     BOOST_CHECK_EQUAL( json::string( std::string() ).to_std_string(), std::string() );
 }
+
+/*
+ * a parser that collects the text of the tokens in shared blocks, must yield the same results. Tiny blocks
+ * force tokens to be moved into new blocks while being parsed.
+ */
+BOOST_AUTO_TEST_CASE( parse_into_shared_blocks )
+{
+    const std::string test_json = "[[],12.1e12,21,\"Hallo\\u1234\",{\"a\":true,\"b\":false},{},null,\"a longer string\",-4]";
+    const json::value expected = json::parse( test_json );
+
+    for ( std::size_t block_size = 1; block_size != 64; ++block_size )
+    {
+        for ( std::string::size_type split = 0; split != test_json.size(); ++split )
+        {
+            json::parser p( block_size );
+            p.parse( test_json.data(), test_json.data() + split );
+            p.parse( test_json.data() + split, test_json.data() + test_json.size() );
+            p.flush();
+
+            BOOST_CHECK_EQUAL( expected, p.result() );
+            BOOST_CHECK_EQUAL( test_json, p.result().to_json() );
+        }
+    }
+}
+
+/*
+ * values parsed into a block must stay valid after the parser is destroyed
+ */
+BOOST_AUTO_TEST_CASE( blocks_outlive_parser )
+{
+    json::value result = json::null();
+
+    {
+        json::parser p( 4096 );
+        const std::string text = "{\"a\":\"b\",\"c\":42}";
+        p.parse( text.begin(), text.end() );
+        p.flush();
+        result = p.result();
+    }
+
+    BOOST_CHECK_EQUAL( result, json::parse_single_quoted( "{'a':'b','c':42}" ) );
+    BOOST_CHECK_EQUAL( 42, result.upcast< json::object >().at( json::string( "c" ) ).upcast< json::number >().to_int() );
+}
+
+namespace {
+    // address of the serialized text of the value
+    const char* text_address( const json::value& v )
+    {
+        std::vector< boost::asio::const_buffer > buffers;
+        v.to_json( buffers );
+
+        return boost::asio::buffer_cast< const char* >( buffers.front() );
+    }
+}
+
+/*
+ * own_text() copies values, that refer to a block, and returns all other values unchanged
+ */
+BOOST_AUTO_TEST_CASE( own_text_detaches_values_from_blocks )
+{
+    const std::string text = "{\"a\":[\"b\",42],\"c\":true}";
+
+    json::parser p( 4096 );
+    p.parse( text.begin(), text.end() );
+    p.flush();
+
+    const json::value   parsed = p.result();
+    const json::value   owned  = parsed.own_text();
+    const json::value&  parsed_b = parsed.upcast< json::object >().at( "a" ).upcast< json::array >().at( 0 );
+    const json::value&  owned_b  = owned.upcast< json::object >().at( "a" ).upcast< json::array >().at( 0 );
+
+    BOOST_CHECK_EQUAL( parsed, owned );
+    BOOST_CHECK_EQUAL( text, owned.to_json() );
+    BOOST_CHECK( text_address( parsed_b ) != text_address( owned_b ) );
+
+    const json::value not_parsed = json::parse( text );
+    const json::value& not_parsed_b = not_parsed.upcast< json::object >().at( "a" ).upcast< json::array >().at( 0 );
+
+    BOOST_CHECK( text_address( not_parsed_b ) == text_address(
+        not_parsed.own_text().upcast< json::object >().at( "a" ).upcast< json::array >().at( 0 ) ) );
+}
+
+BOOST_AUTO_TEST_CASE( parse_buffer_sequence )
+{
+    const std::string first  = "{\"a\":[1,2";
+    const std::string second = "3],\"bc";
+    const std::string third  = "d\":null}   ";
+
+    std::vector< boost::asio::const_buffer > buffers;
+    buffers.push_back( boost::asio::buffer( first ) );
+    buffers.push_back( boost::asio::buffer( second ) );
+    buffers.push_back( boost::asio::buffer( third ) );
+
+    json::parser p( 16 );
+    BOOST_CHECK( p.parse_buffers( buffers ) == std::make_pair( true, true ) );
+    p.flush();
+
+    BOOST_CHECK_EQUAL( p.result(), json::parse_single_quoted( "{'a':[1,23],'bcd':null}" ) );
+}
+
+BOOST_AUTO_TEST_CASE( parse_buffer_sequence_stops_at_end_of_value )
+{
+    const std::string first  = "[1,2]";
+    const std::string second = "[3]";
+
+    std::vector< boost::asio::const_buffer > buffers;
+    buffers.push_back( boost::asio::buffer( first ) );
+    buffers.push_back( boost::asio::buffer( second ) );
+
+    json::parser p;
+    BOOST_CHECK( p.parse_buffers( buffers ) == std::make_pair( false, true ) );
+    BOOST_CHECK_EQUAL( p.result(), json::parse( "[1,2]" ) );
+}
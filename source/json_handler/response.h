@@ -1,5 +1,6 @@
 #include "server/response.h"
 #include "http/http.h"
+#include "http/body_decoder.h"
 #include "http/request.h"
 #include "json/json.h"
 
@@ -73,9 +74,8 @@ namespace json
 
     private:
         void body_read_handler(
-            const boost::system::error_code& error,
-            const char* buffer,
-            std::size_t bytes_read_and_decoded );
+            const boost::system::error_code&    error,
+            const http::body_buffers&           buffers );
 
         void response_written( const boost::system::error_code& ec, std::size_t size );
 
@@ -94,25 +94,28 @@ namespace json
 
     template < class Connection >
     void response< Connection >::body_read_handler(
-        const boost::system::error_code& error,
-        const char* buffer,
-        std::size_t bytes_read_and_decoded )
+        const boost::system::error_code&    error,
+        const http::body_buffers&           buffers )
     {
         server::close_connection_guard< Connection > guard( *connection_, *this );
 
         if ( !error )
         {
-            if ( bytes_read_and_decoded == 0 )
+            if ( buffers.empty() )
             {
                 parser_.flush();
                 build_response( parser_.result() );
 
-                connection_->async_write(
+                connection_->async_write_last(
                     response_, boost::bind( &response::response_written, this->shared_from_this(), _1, _2 ), *this );
             }
             else
             {
-                parser_.parse( buffer, buffer + bytes_read_and_decoded );
+                for ( http::body_buffers::const_iterator b = buffers.begin(); b != buffers.end(); ++b )
+                {
+                    const char* const buffer = boost::asio::buffer_cast< const char* >( *b );
+                    parser_.parse( buffer, buffer + boost::asio::buffer_size( *b ) );
+                }
             }
 
             guard.dismiss();
@@ -126,13 +129,13 @@ namespace json
 
         if ( request_->body_expected() )
         {
-            connection_->async_read_body( boost::bind( &response::body_read_handler, this->shared_from_this(), _1, _2, _3 ) );
+            connection_->async_read_body_buffers( boost::bind( &response::body_read_handler, this->shared_from_this(), _1, _2 ) );
         }
         else
         {
             build_response( json::null() );
 
-            connection_->async_write(
+            connection_->async_write_last(
                 response_, boost::bind( &response::response_written, this->shared_from_this(), _1, _2 ), *this );
         }
 
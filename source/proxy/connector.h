@@ -274,7 +274,7 @@ namespace proxy
         boost::shared_ptr<connection> in_use;
         in_use = find_and_remove(in_use_connections_, con);
 
-        if ( header && !header->option_available("connection", "close") )
+        if ( header && !header->option_available(http::header_connection, "close") )
         {
             in_use->timer_.expires_from_now(config_->max_idle_time());
             in_use->timer_.async_wait(
@@ -6,6 +6,7 @@
 #include "server/connection.h"
 #include "http/request.h"
 #include "http/response.h"
+#include "http/decode_stream.h"
 
 #include "proxy/test_connector.h"
 #include "proxy/test_traits.h"
@@ -389,6 +390,9 @@ BOOST_AUTO_TEST_CASE(content_length_proxy_request)
     BOOST_CHECK(compare_buffers(proxy_response, client_received, std::cerr));
 }
 
+/**
+ * @test a body, that is delimited by the orgin closing the connection, is forwarded as chunked body to a HTTP/1.1 client
+ */
 BOOST_AUTO_TEST_CASE(close_connection_length_proxy_request)
 {    
     const char response_text[] =
@@ -396,7 +400,8 @@ BOOST_AUTO_TEST_CASE(close_connection_length_proxy_request)
 
     boost::minstd_rand      random;
 
-    std::vector<char> proxy_response = random_body(random, 10000);
+    const std::vector<char> body = random_body(random, 10000);
+    std::vector<char> proxy_response = body;
     proxy_response.insert(proxy_response.begin(), begin(response_text), end(response_text));
 
     boost::asio::io_service queue;
@@ -410,8 +415,11 @@ BOOST_AUTO_TEST_CASE(close_connection_length_proxy_request)
 
     const std::vector<char> client_received = simulate_sized_proxy<1024>(proxy, client_connection);
 
-    BOOST_CHECK_EQUAL(proxy_response.size(), client_received.size());
-    BOOST_CHECK(compare_buffers(proxy_response, client_received, std::cerr));
+    const http::decoded_response_stream_t responses = http::decode_stream< http::response_header >(client_received);
+
+    BOOST_REQUIRE_EQUAL(1u, responses.size());
+    BOOST_CHECK(responses.front().first->option_available("Transfer-Encoding", "chunked"));
+    BOOST_CHECK(compare_buffers(body, responses.front().second, std::cerr));
 }
 
 BOOST_AUTO_TEST_CASE(request_an_other_connection_when_the_first_was_falty)
@@ -6,10 +6,12 @@
 #define SIOUX_SOURCE_SERVER_PROXY_RESPONSE_H
 
 #include "proxy/connector.h"
+#include "server/chunked_writer.h"
 #include "server/response.h"
 #include "server/transfer_buffer.h"
 #include "server/timeout.h"
 #include "server/error_code.h"
+#include "http/chunk_encoder.h"
 #include "http/request.h"
 #include "http/response.h"
 #include <boost/enable_shared_from_this.hpp>
@@ -23,6 +25,9 @@ namespace proxy
 {
     /**
      * @brief forwards the request to an other server and answers with the answer of that server
+     *
+     * If the orgin server signals the end of the response body by closing the connection, the body is forwarded
+     * as chunked body to HTTP/1.1 clients, so that the connection to the client can be kept alive.
      */
     template < class Connection, std::size_t BodyBufferSize = 1024 >
     class response : public server::async_response,
@@ -51,6 +56,10 @@ namespace proxy
             , outbuffers_()
             , proxy_socket_(0)
             , response_body_exists_(false)
+            , chunked_body_(false)
+            , chunk_encoder_()
+            , chunk_size_(0)
+            , last_chunk_written_(false)
             , reading_body_from_orgin_(false)
             , writing_body_to_client_(false)
             , restart_counter_(0)
@@ -103,6 +112,7 @@ namespace proxy
         void issue_read(const boost::asio::mutable_buffers_1& buffer);
 
         void issue_write(const boost::asio::const_buffers_1& buffer);
+        void issue_chunked_write(const boost::asio::const_buffers_1& buffer);
 
         void orgin_timeout(const boost::system::error_code& error);
 
@@ -124,6 +134,12 @@ namespace proxy
     
         bool                                            response_body_exists_;
 
+        // the body from the orgin is delimited by closing the connection and is forwarded as chunked body
+        bool                                            chunked_body_;
+        http::chunk_encoder                             chunk_encoder_;
+        std::size_t                                     chunk_size_;
+        bool                                            last_chunk_written_;
+
         // keep track of whether a read or write is already issued
         bool                                            reading_body_from_orgin_;
         bool                                            writing_body_to_client_;
@@ -259,6 +275,16 @@ namespace proxy
         error_guard fail(*connection_, *this, http::http_bad_gateway);
         reading_body_from_orgin_ = false;
 
+        if ( error == boost::asio::error::eof && chunked_body_ )
+        {
+            // the orgin closed the connection to indicate the end of the body
+            body_buffer_.data_written(0);
+            issue_write(body_buffer_.read_buffer());
+
+            fail.dismiss();
+            return;
+        }
+
         if ( error )
         {
             connection_->trait().log_error(*this, "response::handle_read_from_orgin", error, bytes_transferred);
@@ -280,10 +306,15 @@ namespace proxy
             {
                 if ( response_header_from_proxy_.state() == http::message::ok )
                 {
-                    forward_header();
-
                     response_body_exists_ = response_header_from_proxy_.body_expected(request_->method());
 
+                    chunked_body_ = response_body_exists_
+                        && !response_header_from_proxy_.option_available(http::header_transfer_encoding, "chunked")
+                        && response_header_from_proxy_.find_header(http::header_content_length) == 0
+                        && server::chunked_response_possible(*request_);
+
+                    forward_header();
+
                     if ( response_body_exists_ )        
                     {
                         body_buffer_.start(response_header_from_proxy_);
@@ -348,9 +379,16 @@ namespace proxy
 
         if ( !error )
         {
-            body_buffer_.data_read(bytes_transferred);
+            // bytes_transferred includes the chunk framing
+            body_buffer_.data_read(chunked_body_ ? chunk_size_ : bytes_transferred);
 
-            if ( body_buffer_.transmission_done() )
+            if ( chunked_body_ && last_chunk_written_ )
+            {
+                // the orgin closed the connection at the end of the body
+                connector_.dismiss_connection(proxy_socket_);
+                proxy_socket_ = 0;
+            }
+            else if ( body_buffer_.transmission_done() && !chunked_body_ )
             {
                 // all is done here!
                 connector_.release_connection(proxy_socket_, response_header_from_proxy_);
@@ -408,7 +446,11 @@ namespace proxy
     template <class Connection, std::size_t BodyBufferSize>
     void response<Connection, BodyBufferSize>::issue_write(const boost::asio::const_buffers_1& buffer)
     {
-        if ( !writing_body_to_client_ && buffer_size(buffer) != 0 )
+        if ( chunked_body_ )
+        {
+            issue_chunked_write(buffer);
+        }
+        else if ( !writing_body_to_client_ && buffer_size(buffer) != 0 )
         {
             writing_body_to_client_ = true;
             connection_->async_write_some(
@@ -422,13 +464,61 @@ namespace proxy
         }
     }
 
+    template <class Connection, std::size_t BodyBufferSize>
+    void response<Connection, BodyBufferSize>::issue_chunked_write(const boost::asio::const_buffers_1& buffer)
+    {
+        if ( writing_body_to_client_ || last_chunk_written_ )
+            return;
+
+        chunk_size_ = buffer_size(buffer);
+
+        http::chunk_encoder::buffers_type chunk;
+
+        if ( chunk_size_ != 0 )
+        {
+            chunk = chunk_encoder_.chunk(*buffer.begin());
+        }
+        else if ( body_buffer_.transmission_done() )
+        {
+            chunk = chunk_encoder_.last_chunk(boost::asio::const_buffer());
+            last_chunk_written_ = true;
+        }
+        else
+        {
+            return;
+        }
+
+        writing_body_to_client_ = true;
+        connection_->async_write(
+            chunk,
+            boost::bind(&response::handle_body_written,
+                    this->shared_from_this(),
+                    boost::asio::placeholders::error,
+                    boost::asio::placeholders::bytes_transferred),
+            *this
+        );
+    }
+
     template <class Connection, std::size_t BodyBufferSize>
     void response<Connection, BodyBufferSize>::forward_header()
     {
+        static const char transfer_encoding[] = "Transfer-Encoding: chunked\r\n";
+
         // filter all connection headers
         outbuffers_ = filtered_header(response_header_from_proxy_);
         writing_body_to_client_ = true;
 
+        if ( chunked_body_ )
+        {
+            // insert the header in front of the empty line, that terminates the header
+            const tools::substring last = outbuffers_.back();
+            const tools::substring::iterator empty_line = last.end() - ( *( last.end() - 2 ) == '\r' ? 2 : 1 );
+
+            outbuffers_.back() = tools::substring(last.begin(), empty_line);
+            outbuffers_.push_back(tools::substring(transfer_encoding, transfer_encoding + sizeof transfer_encoding - 1));
+            outbuffers_.push_back(tools::substring(empty_line, last.end()));
+        }
+
         connection_->async_write(
                 outbuffers_, 
                 boost::bind(
@@ -445,7 +535,7 @@ namespace proxy
     {
         http::filter                    unused_headers(connection_headers_to_be_removed_);
 
-        const http::header* const connection_header = header.find_header("connection");
+        const http::header* const connection_header = header.find_header(http::header_connection);
         
         if ( connection_header != 0 )
         {
@@ -12,6 +12,7 @@ namespace pubsub
         : node_timeout_()
         , min_update_period_()
         , max_update_size_(70u)
+        , fan_out_batch_size_(0)
     	, authorization_required_(true)
     {
     }
@@ -31,6 +32,11 @@ namespace pubsub
         return min_update_period_;
     }
 
+    void configuration::min_update_period(const boost::posix_time::time_duration& new_period)
+    {
+        min_update_period_ = new_period;
+    }
+
     unsigned configuration::max_update_size() const
     {
         return max_update_size_;
@@ -41,6 +47,16 @@ namespace pubsub
         max_update_size_ = new_size;
     }
 
+    unsigned configuration::fan_out_batch_size() const
+    {
+        return fan_out_batch_size_;
+    }
+
+    void configuration::fan_out_batch_size( unsigned new_size )
+    {
+        fan_out_batch_size_ = new_size;
+    }
+
     bool configuration::authorization_required() const
     {
         return authorization_required_;
@@ -56,6 +72,7 @@ namespace pubsub
         out << "node_timeout: " << node_timeout_;
         out << "\nmin_update_period: " << min_update_period_;
         out << "\nmax_update_size: " << max_update_size_;
+        out << "\nfan_out_batch_size: " << fan_out_batch_size_;
         out << "\nauthorization_required: " << authorization_required_;
     }
 
@@ -74,6 +91,12 @@ namespace pubsub
         return *this;
     }
 
+    const configurator& configurator::min_update_period(const boost::posix_time::time_duration& d) const
+    {
+        config_.min_update_period(d);
+        return *this;
+    }
+
     const configurator& configurator::authorization_required() const
     {
         config_.authorization_required(true);
@@ -92,6 +115,12 @@ namespace pubsub
         return *this;
     }
 
+    const configurator& configurator::fan_out_batch_size( unsigned s ) const
+    {
+        config_.fan_out_batch_size( s );
+        return *this;
+    }
+
     configurator::operator configuration() const
     {
         return config_;
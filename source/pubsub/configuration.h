@@ -20,6 +20,10 @@ namespace pubsub
 
         /**
          * @brief the time, that a node without subscriber should stay in the data model
+         *
+         * A node, that had no subscribers for this time, is removed from the data model. A new subscription to that
+         * node requires a new validation, authorization and initialization of the node. The default is a zero
+         * duration, which keeps unused nodes in the data model forever.
          */
         boost::posix_time::time_duration    node_timeout() const;
 
@@ -34,10 +38,18 @@ namespace pubsub
          *        be published.
          *
          * If at the time, where the update was made, the time isn't elapsed, the update
-         * will be published, when the time elapses.
+         * will be published, when the time elapses. All updates that are made within the
+         * period are coalesced, so that subscribers will be notified just once about the
+         * latest version. A period of 0 (the default) publishes every update immediately.
          */
         boost::posix_time::time_duration    min_update_period() const;
 
+        /**
+         * @brief sets the minimum update period to a new value
+         * @post min_update_period() returns new_period
+         */
+        void min_update_period(const boost::posix_time::time_duration& new_period);
+
         /**
          * @brief the ratio of update costs to full nodes data size in %
          */
@@ -48,6 +60,24 @@ namespace pubsub
          */
         void max_update_size( unsigned );
 
+        /**
+         * @brief the maximum number of subscribers, that are notified about a node update by a single handler
+         *
+         * If 0 (the default), all subscribers are notified synchronously from within root::update_node().
+         * Otherwise, a snapshot of the node is taken and the notifications are posted in batches of at most
+         * fan_out_batch_size() subscribers to the io_service of the root, so that root::update_node() returns
+         * immediately. At maximum, one such notification per node is in flight. Updates that arrive while
+         * the subscribers are notified, are coalesced into a single, further notification with the
+         * latest version of the node.
+         */
+        unsigned fan_out_batch_size() const;
+
+        /**
+         * @brief sets the maximum number of subscribers, that are notified by a single handler
+         * @post fan_out_batch_size() returns new_size
+         */
+        void fan_out_batch_size( unsigned new_size );
+
         /**
          * @brief returns true, if the configured nodes require authorization to be accessed
          */
@@ -68,6 +98,7 @@ namespace pubsub
         boost::posix_time::time_duration    node_timeout_;
         boost::posix_time::time_duration    min_update_period_;
         unsigned                            max_update_size_;
+        unsigned                            fan_out_batch_size_;
         bool                                authorization_required_;
     };
 
@@ -84,9 +115,11 @@ namespace pubsub
     {
     public:
         const configurator& node_timeout(const boost::posix_time::time_duration&) const;
+        const configurator& min_update_period(const boost::posix_time::time_duration&) const;
         const configurator& authorization_required() const;
         const configurator& authorization_not_required() const;
         const configurator& max_update_size( unsigned ) const;
+        const configurator& fan_out_batch_size( unsigned ) const;
 
         operator configuration() const;
     private:
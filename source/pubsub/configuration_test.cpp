@@ -35,6 +35,18 @@ BOOST_AUTO_TEST_CASE(configure_node_timeout_by_configurator)
 	BOOST_CHECK_EQUAL(boost::posix_time::millisec(42), config.node_timeout());
 }
 
+BOOST_AUTO_TEST_CASE(configure_min_update_period)
+{
+	BOOST_CHECK_EQUAL(boost::posix_time::time_duration(), configuration().min_update_period());
+
+	configuration config;
+	config.min_update_period(boost::posix_time::millisec(250));
+	BOOST_CHECK_EQUAL(boost::posix_time::millisec(250), config.min_update_period());
+
+	config = configurator().min_update_period(boost::posix_time::seconds(2));
+	BOOST_CHECK_EQUAL(boost::posix_time::seconds(2), config.min_update_period());
+}
+
 BOOST_AUTO_TEST_CASE(configure_authorization_required)
 {
     configuration c1;
@@ -71,3 +83,16 @@ BOOST_AUTO_TEST_CASE( change_max_update_size )
     c1.max_update_size( 55u );
     BOOST_CHECK_EQUAL( 55u, c1.max_update_size() );
 }
+
+BOOST_AUTO_TEST_CASE( change_fan_out_batch_size )
+{
+    // default is synchronous notification
+    BOOST_CHECK_EQUAL( 0u, configuration().fan_out_batch_size() );
+
+    configuration c1;
+    c1.fan_out_batch_size( 100u );
+    BOOST_CHECK_EQUAL( 100u, c1.fan_out_batch_size() );
+
+    c1 = configurator().fan_out_batch_size( 12u );
+    BOOST_CHECK_EQUAL( 12u, c1.fan_out_batch_size() );
+}
@@ -4,24 +4,125 @@
 
 #include "pubsub/key.h"
 #include <ostream>
+#include <boost/functional/hash.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/unordered_map.hpp>
+#include <boost/weak_ptr.hpp>
 
 namespace pubsub {
 
+    namespace {
+        const std::string unnamed_domain;
+        const std::size_t unnamed_domain_hash = boost::hash_value(unnamed_domain);
+    }
+
+    namespace details {
+        struct interned_domain_name
+        {
+            explicit interned_domain_name(const std::string& n)
+                : name(n)
+                , hash(boost::hash_value(n))
+            {
+            }
+
+            const std::string   name;
+            const std::size_t   hash;
+        };
+    }
+
+    namespace {
+        /*
+         * all names of living domains. The entries are removed by the deleter of the last domain referring to an
+         * entry; the raw pointer identifies the entry, a deleter is allowed to remove, as a new entry for the same
+         * name could have been added, after the last reference to the old entry was released.
+         */
+        class name_table
+        {
+        public:
+            typedef details::interned_domain_name interned_name;
+
+            boost::shared_ptr<const interned_name> intern(const std::string& name)
+            {
+                boost::mutex::scoped_lock lock(mutex_);
+
+                entry& e = names_[name];
+                boost::shared_ptr<const interned_name> result = e.name.lock();
+
+                if ( !result )
+                {
+                    interned_name* const new_name = new interned_name(name);
+                    result.reset(new_name, release_name(*this));
+
+                    e.name = result;
+                    e.ptr  = new_name;
+                }
+
+                return result;
+            }
+
+        private:
+            struct release_name
+            {
+                explicit release_name(name_table& table) : table_(&table) {}
+
+                void operator()(const interned_name* name) const
+                {
+                    table_->release(name);
+                }
+
+                name_table* table_;
+            };
+
+            void release(const interned_name* name)
+            {
+                {
+                    boost::mutex::scoped_lock lock(mutex_);
+                    const map_t::iterator pos = names_.find(name->name);
+
+                    if ( pos != names_.end() && pos->second.ptr == name )
+                        names_.erase(pos);
+                }
+
+                delete name;
+            }
+
+            struct entry
+            {
+                entry() : name(), ptr(0) {}
+
+                boost::weak_ptr<const interned_name>    name;
+                const interned_name*                    ptr;
+            };
+
+            typedef boost::unordered_map<std::string, entry> map_t;
+
+            boost::mutex    mutex_;
+            map_t           names_;
+        };
+
+        name_table& names()
+        {
+            // never destroyed, as domains with static storage duration might release their names very late
+            static name_table* const table = new name_table;
+            return *table;
+        }
+    }
+
     /////////////////////
     // class key_domain
     key_domain::key_domain()
+        : domain_name_()
     {
     }
 
-   
     key_domain::key_domain(const std::string& name)
-        : domain_name_(name)
+        : domain_name_(name.empty() ? boost::shared_ptr<const details::interned_domain_name>() : names().intern(name))
     {
     }
 
     bool key_domain::operator<(const key_domain& rhs) const
     {
-        return domain_name_ < rhs.domain_name_;
+        return domain_name_ != rhs.domain_name_ && name() < rhs.name();
     }
 
     bool key_domain::operator==(const key_domain& rhs) const
@@ -31,12 +132,17 @@ namespace pubsub {
 
     bool key_domain::operator!=(const key_domain& rhs) const
     {
-        return domain_name_ != rhs.domain_name_;
+        return !(*this == rhs);
     }
 
     const std::string& key_domain::name() const
     {
-        return domain_name_;
+        return domain_name_.get() ? domain_name_->name : unnamed_domain;
+    }
+
+    std::size_t key_domain::hash() const
+    {
+        return domain_name_.get() ? domain_name_->hash : unnamed_domain_hash;
     }
 
     std::ostream& operator<<(std::ostream& out, const key_domain& k)
@@ -44,6 +150,11 @@ namespace pubsub {
         return out << k.name();
     }
 
+    std::size_t hash_value(const key_domain& d)
+    {
+        return d.hash();
+    }
+
     //////////////
     // class key
     key::key()
@@ -88,5 +199,13 @@ namespace pubsub {
         return out;
     }
 
+    std::size_t hash_value(const key& k)
+    {
+        std::size_t result = hash_value(k.domain());
+        boost::hash_combine(result, k.value());
+
+        return result;
+    }
+
 } // namespace pubsub
 
@@ -7,11 +7,23 @@
 
 #include <string>
 #include <iosfwd>
+#include <cstddef>
+#include <boost/shared_ptr.hpp>
 
 namespace pubsub
 {
+    namespace details {
+        struct interned_domain_name;
+    }
+
     /**
      * @brief describes what valid values a key can have
+     *
+     * Domain names are interned: all domains with the same name share a single, reference counted copy of the
+     * name and its hash value, so that comparing two domains for equality is a pointer comparison. The name is
+     * looked up in a process wide table, guarded by a mutex, only when a domain is constructed from a name.
+     * The table contains only the names of domains, that are alive; a name is removed from the table together
+     * with the last domain referring to it.
      */
     class key_domain
     {
@@ -33,6 +45,8 @@ namespace pubsub
 
         /**
          * @brief returns true, if both domains have the same name
+         *
+         * This is a pointer comparison.
          */
         bool operator==(const key_domain& rhs) const;
 
@@ -42,8 +56,14 @@ namespace pubsub
         bool operator!=(const key_domain& rhs) const;
 
         const std::string& name() const;
+
+        /**
+         * @brief the hash value of the name, calculated once, when the name was interned
+         */
+        std::size_t hash() const;
     private:
-        std::string domain_name_;
+        // null for the unnamed domain
+        boost::shared_ptr<const details::interned_domain_name> domain_name_;
     };
 
     /**
@@ -52,6 +72,12 @@ namespace pubsub
      */
     std::ostream& operator<<(std::ostream&, const key_domain&);
 
+    /**
+     * @brief hash value of a domain, compatible with boost::hash
+     * @relates key_domain
+     */
+    std::size_t hash_value(const key_domain&);
+
     /**
      * @brief key 
      */
@@ -86,6 +112,12 @@ namespace pubsub
      * @relates key
      */
     std::ostream& operator<<(std::ostream& out, const key& k);
+
+    /**
+     * @brief hash value of a key, compatible with boost::hash
+     * @relates key
+     */
+    std::size_t hash_value(const key& k);
 }
 
 #endif // include guard
@@ -3,6 +3,7 @@
 // Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
 
 #include <boost/test/unit_test.hpp>
+#include <boost/functional/hash.hpp>
 #include "pubsub/key.h"
 #include "tools/test_order.h"
 
@@ -21,3 +22,39 @@ BOOST_AUTO_TEST_CASE(key_domain_order_test)
 
     BOOST_CHECK( tools::check_weak_order( values.begin(), values.end() ) );
 }
+
+/**
+ * @test copies of a domain share the name, domains with the same name compare equal
+ */
+BOOST_AUTO_TEST_CASE(key_domain_copies_share_the_name)
+{
+    const key_domain domain("shared");
+    const key_domain copy(domain);
+
+    BOOST_CHECK_EQUAL(&domain.name(), &copy.name());
+    BOOST_CHECK_EQUAL(domain, key_domain("shared"));
+    BOOST_CHECK_NE(domain, key_domain("other"));
+    BOOST_CHECK_EQUAL(key_domain(), key_domain(""));
+    BOOST_CHECK_EQUAL(hash_value(domain), hash_value(key_domain("shared")));
+}
+
+/**
+ * @test domains, that are constructed independently with the same name, share the interned name and hash. The name
+ *       is interned again, after the last domain referring to it was destroyed.
+ */
+BOOST_AUTO_TEST_CASE(key_domain_names_are_interned)
+{
+    {
+        const key_domain first("interned");
+        const key_domain second(std::string("inter") + "ned");
+
+        BOOST_CHECK_EQUAL(&first.name(), &second.name());
+        BOOST_CHECK_EQUAL(first.hash(), boost::hash_value(std::string("interned")));
+        BOOST_CHECK_EQUAL(hash_value(first), hash_value(second));
+    }
+
+    const key_domain again("interned");
+    BOOST_CHECK_EQUAL(again.name(), "interned");
+    BOOST_CHECK_EQUAL(again, key_domain("interned"));
+    BOOST_CHECK_EQUAL(key_domain().hash(), boost::hash_value(std::string()));
+}
@@ -8,19 +8,13 @@
 #include <algorithm>
 #include <cstdlib>
 #include <limits>
+#include <boost/functional/hash.hpp>
+#include <boost/thread/mutex.hpp>
 
 namespace pubsub {
 
     namespace 
     {
-        struct compare_domains : std::binary_function<std::string, std::string, bool>
-        {
-            bool operator()(const std::string& lhs, const std::string& rhs) const
-            {
-                return key_domain(lhs) < key_domain(rhs);
-            }
-        };
-
         struct to_domain
         {
             key_domain operator()(const json::string& s) const
@@ -33,7 +27,16 @@ namespace pubsub {
 
     ////////////////////
     // class node_name
+    namespace {
+        std::size_t calculate_hash(const node_name::key_list& keys)
+        {
+            return boost::hash_range(keys.begin(), keys.end());
+        }
+    }
+
     node_name::node_name()
+        : keys_()
+        , hash_(calculate_hash(keys_))
     {
     }
 
@@ -45,6 +48,8 @@ namespace pubsub {
     }
 
     node_name::node_name(const json::object& keys)
+        : keys_()
+        , hash_(0)
     {
         const std::vector<json::string> json_key_names = keys.keys();
         std::vector<key_domain>         domains;
@@ -56,11 +61,13 @@ namespace pubsub {
         {
             keys_.push_back(key(*k, convert_to_str(keys.at(json::string(k->name().c_str())))));
         }
+
+        hash_ = calculate_hash(keys_);
     }
 
     bool node_name::operator==(const node_name& rhs) const
     {
-        if ( keys_.size() != rhs.keys_.size() )
+        if ( hash_ != rhs.hash_ || keys_.size() != rhs.keys_.size() )
             return false;
 
         key_list::const_iterator lhs_begin = keys_.begin();
@@ -128,6 +135,8 @@ namespace pubsub {
         else
         	keys_.insert( pos, k );
 
+        hash_ = calculate_hash( keys_ );
+
     	return *this;
     }
 
@@ -165,12 +174,22 @@ namespace pubsub {
         return result;
     }
 
+    std::size_t node_name::hash() const
+    {
+        return hash_;
+    }
+
     std::ostream& operator<<(std::ostream& out, const node_name& name)
     {   
         name.print(out);
         return out;
     }
 
+    std::size_t hash_value(const node_name& name)
+    {
+        return name.hash();
+    }
+
     ///////////////////////
     // class node_version
     node_version::node_version()
@@ -246,12 +265,117 @@ namespace pubsub {
         return out;
     }
 
+    namespace details {
+        // payloads build for a single version of a node
+        class payload_cache
+        {
+        public:
+            bool find(const void* tag, std::size_t missing_updates, json::value& payload) const
+            {
+                boost::mutex::scoped_lock lock(mutex_);
+
+                const list_t::const_iterator pos = std::find_if(payloads_.begin(), payloads_.end(), match(tag, missing_updates));
+
+                if ( pos == payloads_.end() )
+                    return false;
+
+                payload = pos->payload;
+
+                return true;
+            }
+
+            // if an other thread added a payload in the meantime, that payload is returned
+            json::value add(const void* tag, std::size_t missing_updates, const json::value& payload)
+            {
+                boost::mutex::scoped_lock lock(mutex_);
+
+                const list_t::const_iterator pos = std::find_if(payloads_.begin(), payloads_.end(), match(tag, missing_updates));
+
+                if ( pos != payloads_.end() )
+                    return pos->payload;
+
+                const entry new_entry = { tag, missing_updates, payload };
+                payloads_.push_back(new_entry);
+
+                return payload;
+            }
+
+            void clear()
+            {
+                boost::mutex::scoped_lock lock(mutex_);
+                payloads_.clear();
+            }
+
+        private:
+            struct entry
+            {
+                const void*     tag;
+                std::size_t     missing_updates;
+                json::value     payload;
+            };
+
+            struct match
+            {
+                match(const void* t, std::size_t m) : tag(t), missing_updates(m) {}
+
+                bool operator()(const entry& e) const
+                {
+                    return e.tag == tag && e.missing_updates == missing_updates;
+                }
+
+                const void*     tag;
+                std::size_t     missing_updates;
+            };
+
+            typedef std::vector<entry> list_t;
+
+            mutable boost::mutex    mutex_;
+            list_t                  payloads_;
+        };
+    }
+
     ///////////////
     // class node
+    node::update_range::update_range()
+        : begin_()
+        , end_()
+        , size_(0)
+    {
+    }
+
+    node::update_range::update_range(update_iterator begin, update_iterator end)
+        : begin_(begin)
+        , end_(end)
+        , size_(end - begin)
+    {
+    }
+
+    node::update_iterator node::update_range::begin() const
+    {
+        return begin_;
+    }
+
+    node::update_iterator node::update_range::end() const
+    {
+        return end_;
+    }
+
+    bool node::update_range::empty() const
+    {
+        return size_ == 0;
+    }
+
+    std::size_t node::update_range::size() const
+    {
+        return size_;
+    }
+
     node::node(const node_version& first_version, const json::value& first_versions_data)
-        : data_(first_versions_data)
+        : data_(first_versions_data.own_text())
         , version_(first_version)
         , updates_()
+        , updates_elements_size_(0)
+        , payloads_(new details::payload_cache)
     {
     }
 
@@ -262,7 +386,7 @@ namespace pubsub {
 
     node_version node::oldest_version() const
     {
-        return version_ - updates_.length();
+        return version_ - updates_.size();
     }
 
     const json::value& node::data() const
@@ -272,12 +396,27 @@ namespace pubsub {
 
     std::pair<bool, json::value> node::get_update_from(const node_version& known_version) const
     {
-        const int distance = version_ - known_version;
+        const update_range updates = updates_from(known_version);
 
-        if ( distance <= 0 || distance > static_cast<int>(updates_.length()) ) 
+        if ( updates.empty() ) 
             return std::make_pair(false, data_);
 
-        return std::make_pair(true, json::array(updates_, distance, updates_.length() - distance));
+        json::array result;
+
+        for ( update_iterator update = updates.begin(); update != updates.end(); ++update )
+            result.add(*update);
+
+        return std::make_pair(true, result);
+    }
+
+    node::update_range node::updates_from(const node_version& known_version) const
+    {
+        const int distance = version_ - known_version;
+
+        if ( distance <= 0 || distance > static_cast<int>(updates_.size()) ) 
+            return update_range();
+
+        return update_range(updates_.end() - distance, updates_.end());
     }
 
     bool node::update(const json::value& new_data, unsigned keep_update_size_percent)
@@ -285,36 +424,88 @@ namespace pubsub {
         if ( new_data == data_ )
             return false;
 
-        const std::size_t max_size = new_data.size() * keep_update_size_percent / 100;
+        // the node keeps its data for longer than the request, the data was parsed from
+        const json::value owned_data = new_data.own_text();
+
+        const std::size_t max_size = owned_data.size() * keep_update_size_percent / 100;
 
         if ( max_size != 0 )
         {
-            std::pair<bool, json::value> update_instruction = delta(data_, new_data, max_size);
+            std::pair<bool, json::value> update_instruction = delta(data_, owned_data, max_size);
 
             if ( update_instruction.first )
-                updates_.insert(updates_.length(), update_instruction.second);
+                add_update(update_instruction.second);
 
         }
 
-        data_ = new_data;
+        data_ = owned_data;
         ++version_;
 
+        // copies of the node, that still share the cache, keep the payloads of the old version
+        if ( payloads_.unique() )
+            payloads_->clear();
+        else
+            payloads_.reset(new details::payload_cache);
+
         remove_old_versions(max_size);
 
         return true;
     }
 
+    bool node::find_payload(const void* tag, std::size_t missing_updates, json::value& payload) const
+    {
+        return payloads_->find(tag, missing_updates, payload);
+    }
+
+    json::value node::add_payload(const void* tag, std::size_t missing_updates, const json::value& payload) const
+    {
+        return payloads_->add(tag, missing_updates, payload);
+    }
+
+    std::size_t node::size() const
+    {
+        return data_.size() + updates_size();
+    }
+
+    void node::add_update(const json::value& update)
+    {
+        if ( updates_.full() )
+            updates_.set_capacity(std::max<std::size_t>(2 * updates_.capacity(), 4u));
+
+        updates_.push_back(update);
+        updates_elements_size_ += update.size();
+    }
+
     void node::remove_old_versions(std::size_t max_size)
     {
-        while ( !updates_.empty() && updates_.size() > max_size )
-            updates_.erase(0, 1u);
+        while ( !updates_.empty() && updates_size() > max_size )
+        {
+            updates_elements_size_ -= updates_.front().size();
+            updates_.pop_front();
+        }
+    }
+
+    std::size_t node::updates_size() const
+    {
+        // brackets and commas between the elements
+        return updates_elements_size_ + ( updates_.empty() ? 2u : updates_.size() + 1u );
     }
 
     void node::print( std::ostream& out ) const
     {
         out << "data: " << data_;
         out << "\nversion: " << version_;
-        out << "\nupdates: " << updates_;
+        out << "\nupdates: [";
+
+        for ( update_list::const_iterator update = updates_.begin(); update != updates_.end(); ++update )
+        {
+            if ( update != updates_.begin() )
+                out << ",";
+
+            out << *update;
+        }
+
+        out << "]";
     }
 
     std::ostream& operator<<( std::ostream& out, const node& n )
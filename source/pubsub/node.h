@@ -10,11 +10,20 @@
 #include <deque>
 #include <iosfwd>
 #include <boost/cstdint.hpp>
+#include <boost/circular_buffer.hpp>
+#include <boost/shared_ptr.hpp>
 
 namespace pubsub
 {
+    namespace details {
+        class payload_cache;
+    }
+
     /**
      * @brief a node_name is a complete list of keys to address a single node
+     *
+     * The hash value of the name is calculated, when the name is constructed or changed, so that hashing a
+     * name and comparing two names with different hash values doesn't have to look at the keys.
      */
     class node_name
     {
@@ -72,8 +81,14 @@ namespace pubsub
          * @brief turns this into a json representation
          */
         json::object to_json() const;
+
+        /**
+         * @brief the precalculated hash value of the name
+         */
+        std::size_t hash() const;
     private:
-        key_list keys_;
+        key_list    keys_;
+        std::size_t hash_;
     };
 
     /**
@@ -82,6 +97,15 @@ namespace pubsub
      */
     std::ostream& operator<<(std::ostream& out, const node_name& name);
 
+    /**
+     * @brief hash value of a node_name, compatible with boost::hash
+     *
+     * Names that compare equal, have equal hash values. The hash value is precalculated and returned in
+     * constant time.
+     * @relates node_name
+     */
+    std::size_t hash_value(const node_name& name);
+
     /**
      * @brief version of a node
      */
@@ -159,10 +183,51 @@ namespace pubsub
      *
      * The responsibility of this class is to keep the nodes data with the nodes data
      * version and possible existing updates from older versions to the current version.
+     *
+     * The updates are kept in a ring buffer, ordered from the oldest to the newest update. A copy
+     * of a node doesn't share the list of kept updates with the original, so that updating the
+     * original node doesn't change the copy.
      */
     class node
     {
+        typedef boost::circular_buffer<json::value> update_list;
     public:
+        typedef update_list::const_iterator update_iterator;
+
+        /**
+         * @brief a range of updates, that have to be applied in order, to update a nodes data from a known
+         *        version to the current version.
+         *
+         * The range refers to the updates stored in the node and is valid until the node is changed or destroyed.
+         */
+        class update_range
+        {
+        public:
+            /**
+             * @brief an empty range; begin() and end() must not be used on an empty range
+             */
+            update_range();
+
+            update_range(update_iterator begin, update_iterator end);
+
+            update_iterator begin() const;
+            update_iterator end() const;
+
+            /**
+             * @brief returns true, if the range doesn't contain any update
+             */
+            bool empty() const;
+
+            /**
+             * @brief returns the number of updates in the range
+             */
+            std::size_t size() const;
+        private:
+            update_iterator begin_;
+            update_iterator end_;
+            std::size_t     size_;
+        };
+
         /** 
          * @brief constructs the node from a current version and it's data
          */
@@ -184,6 +249,32 @@ namespace pubsub
          */
         std::pair<bool, json::value> get_update_from(const node_version& known_version) const;
 
+        /**
+         * @brief same as get_update_from(), but instead of copying the updates into a new array, the range of the
+         *        kept updates is returned.
+         *
+         * If no delta between known_version and the current version is deliverable, the returned range is empty.
+         * Every element of the range is an array of update operations, that can be passed to json::update().
+         */
+        update_range updates_from(const node_version& known_version) const;
+
+        /**
+         * @brief returns a payload, that was build for the current version of this node, or builds and caches it.
+         *
+         * All subscribers that know the same version of a node, get the very same messages. To build such a
+         * message just once per node version, the message is cached, together with the given tag and the
+         * number of updates, the receiver is missing (0 for receivers, that get the full data). The cache is
+         * shared with copies of the node. When the node changes, the cache is cleared, or, if copies of the
+         * node still share the cache, the node starts with a new cache.
+         *
+         * @param tag identifies the kind of payload. Every kind of payload should use the address of a distinct object.
+         * @param updates the updates, that the receiver is missing, as returned by updates_from()
+         * @param build function object without arguments, building the payload, when it's not cached.
+         * @attention the returned payload is shared and must not be altered.
+         */
+        template < class Builder >
+        json::value payload(const void* tag, const update_range& updates, Builder build) const;
+
         /**
          * @brief changes the current nodes data and increments the current version.
          *
@@ -201,18 +292,47 @@ namespace pubsub
          */
         bool update(const json::value& new_data, unsigned keep_update_size_percent);
 
+        /**
+         * @brief approximated size of the node in bytes
+         *
+         * The size is the sum of the serialized sizes of the current data and the kept updates.
+         */
+        std::size_t size() const;
+
         /**
          * @brief prints the given node in a human readable manner onto the given stream.
          */
         void print( std::ostream& out ) const;
     private:
+        bool find_payload(const void* tag, std::size_t missing_updates, json::value& payload) const;
+        json::value add_payload(const void* tag, std::size_t missing_updates, const json::value& payload) const;
+
+        void add_update(const json::value& update);
         void remove_old_versions(std::size_t max_size);
 
+        // serialized size of updates_, as if updates_ would be a json::array
+        std::size_t updates_size() const;
+
         json::value     data_;
         node_version    version_;
-        json::array     updates_;
+        update_list     updates_;
+        // the sum of the serialized sizes of all elements in updates_
+        std::size_t     updates_elements_size_;
+
+        boost::shared_ptr<details::payload_cache>   payloads_;
     };
 
+    template < class Builder >
+    json::value node::payload(const void* tag, const update_range& updates, Builder build) const
+    {
+        json::value result = json::null();
+
+        if ( find_payload(tag, updates.size(), result) )
+            return result;
+
+        return add_payload(tag, updates.size(), build());
+    }
+
     /**
      * @brief prints the given node in a human readable manner onto the given stream.
      * @relates node
@@ -16,6 +16,7 @@ namespace pubsub
         public:
             virtual bool in_filter(const node_name&) const = 0;
             virtual void print(std::ostream&) const = 0;
+            virtual void add_requirements(std::vector<key>& keys, std::vector<key_domain>& domains) const = 0;
             virtual ~filter() {}
         };
 
@@ -34,6 +35,11 @@ namespace pubsub
                 out << "has_domain(" << domain_ << ")";
             }
 
+            virtual void add_requirements(std::vector<key>&, std::vector<key_domain>& domains) const
+            {
+                domains.push_back(domain_);
+            }
+
             const key_domain domain_;
         };
 
@@ -54,6 +60,11 @@ namespace pubsub
                 out << "has_key(" << key_ << ")";
             }
 
+            virtual void add_requirements(std::vector<key>& keys, std::vector<key_domain>&) const
+            {
+                keys.push_back(key_);
+            }
+
             const key key_;
         };
     }
@@ -74,6 +85,12 @@ namespace pubsub
             return filter == filters_.end();
         }
 
+        void requirements(std::vector<key>& keys, std::vector<key_domain>& domains) const
+        {
+            for ( filter_list::const_iterator i = filters_.begin(); i != filters_.end(); ++i )
+                (*i)->add_requirements(keys, domains);
+        }
+
         void add_filter(std::auto_ptr<filter> filter)
         {
             filters_.push_back(filter.get());
@@ -121,6 +138,37 @@ namespace pubsub
         return pimpl_->in_group(name);
     }
 
+    std::vector<key> node_group::required_keys() const
+    {
+        std::vector<key>        keys;
+        std::vector<key_domain> domains;
+        pimpl_->requirements(keys, domains);
+
+        return keys;
+    }
+
+    std::vector<key_domain> node_group::required_domains() const
+    {
+        std::vector<key>        keys;
+        std::vector<key_domain> domains;
+        pimpl_->requirements(keys, domains);
+
+        std::vector<key_domain> result;
+
+        for ( std::vector<key_domain>::const_iterator d = domains.begin(); d != domains.end(); ++d )
+        {
+            bool domain_of_key = false;
+
+            for ( std::vector<key>::const_iterator k = keys.begin(); k != keys.end() && !domain_of_key; ++k )
+                domain_of_key = k->domain() == *d;
+
+            if ( !domain_of_key )
+                result.push_back(*d);
+        }
+
+        return result;
+    }
+
     bool node_group::operator==(const node_group& rhs) const
     {
         return pimpl_.get() == rhs.pimpl_.get();
@@ -7,6 +7,7 @@
 
 #include <boost/shared_ptr.hpp>
 #include <iosfwd>
+#include <vector>
 
 namespace pubsub
 {
@@ -41,6 +42,20 @@ namespace pubsub
 
         bool in_group(const node_name&) const;
 
+        /**
+         * @brief the keys, that a node_name must contain to be in the group
+         *
+         * Intended to build indices over groups.
+         */
+        std::vector<key> required_keys() const;
+
+        /**
+         * @brief the domains, that a node_name must contain to be in the group
+         *
+         * The domains of the required_keys() are not part of the result.
+         */
+        std::vector<key_domain> required_domains() const;
+
         /**
          * @brief returns true, if the rhs node_group is constructed or copied from the very same
          *        node_group. 
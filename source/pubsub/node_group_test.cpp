@@ -121,3 +121,25 @@ BOOST_AUTO_TEST_CASE(has_key_has_domain_group_test)
     BOOST_CHECK(!filter_b_2_has_a.in_group(pubsub::node_name()));
     BOOST_CHECK(!filter_b_2_has_a.in_group(b_2_c_2));
 }
+
+/**
+ * @test the keys and domains, a node name must have to be in a group
+ */
+BOOST_AUTO_TEST_CASE(node_group_requirements_test)
+{
+    BOOST_CHECK(pubsub::node_group().required_keys().empty());
+    BOOST_CHECK(pubsub::node_group().required_domains().empty());
+
+    const pubsub::node_group group(
+        has_domain(pubsub::key_domain("a")).
+        has_key(pubsub::key(pubsub::key_domain("b"), "2")).
+        has_domain(pubsub::key_domain("b")));
+
+    const std::vector<pubsub::key>          keys    = group.required_keys();
+    const std::vector<pubsub::key_domain>   domains = group.required_domains();
+
+    BOOST_REQUIRE_EQUAL(1u, keys.size());
+    BOOST_CHECK_EQUAL(pubsub::key(pubsub::key_domain("b"), "2"), keys[0]);
+    BOOST_REQUIRE_EQUAL(1u, domains.size());
+    BOOST_CHECK_EQUAL(pubsub::key_domain("a"), domains[0]);
+}
@@ -114,6 +114,29 @@ BOOST_AUTO_TEST_CASE(node_update)
     BOOST_CHECK(check_update(version1, version4, node.get_update_from(current_version-3)));
 }
 
+/**
+ * @test updating a node must not change a copy of that node
+ */
+BOOST_AUTO_TEST_CASE(node_copy_is_independent)
+{
+    const pubsub::node_version  first_version;
+    pubsub::node                node(first_version, version1);
+
+    node.update(version2, 1000u);
+    const pubsub::node          copy(node);
+
+    node.update(version3, 1000u);
+
+    pubsub::node_version        second_version(first_version);
+    ++second_version;
+
+    BOOST_CHECK_EQUAL(version2, copy.data());
+    BOOST_CHECK_EQUAL(second_version, copy.current_version());
+    BOOST_CHECK_EQUAL(first_version, copy.oldest_version());
+    BOOST_CHECK(check_update(version1, version2, copy.get_update_from(first_version)));
+    BOOST_CHECK(check_update(version1, version3, node.get_update_from(first_version)));
+}
+
 BOOST_AUTO_TEST_CASE(node_update_limit)
 {
     pubsub::node_version        current_version;
@@ -148,6 +171,83 @@ BOOST_AUTO_TEST_CASE(node_update_limit)
     }
 }
 
+/**
+ * @test the range of updates refers to the kept updates and is empty, if no update is known
+ */
+BOOST_AUTO_TEST_CASE(node_updates_from_range)
+{
+    const pubsub::node_version  first_version;
+    pubsub::node_version        current_version(first_version);
+    pubsub::node                node(current_version, version1);
+
+    BOOST_CHECK(node.updates_from(first_version).empty());
+
+    // more updates than the initial capacity of the ring buffer
+    for ( unsigned i = 0 ; i != 10; ++i )
+    {
+        node.update(i % 2 == 0 ? version2 : version1, 1000000u);
+        ++current_version;
+    }
+
+    BOOST_CHECK(node.updates_from(current_version).empty());
+    BOOST_CHECK_EQUAL(10u, node.updates_from(first_version).size());
+    BOOST_CHECK_EQUAL(3u, node.updates_from(current_version - 3).size());
+
+    json::value data = json::parse(version1.to_json());
+    const pubsub::node::update_range updates = node.updates_from(first_version);
+
+    for ( pubsub::node::update_iterator update = updates.begin(); update != updates.end(); ++update )
+        data = json::update(data, *update);
+
+    BOOST_CHECK_EQUAL(version1, data);
+}
+
+namespace {
+    struct count_builds
+    {
+        explicit count_builds(unsigned& c) : count(c) {}
+
+        json::value operator()() const
+        {
+            ++count;
+            return json::number(static_cast<int>(count));
+        }
+
+        unsigned& count;
+    };
+}
+
+/**
+ * @test payloads are build once per node version, tag and number of missing updates
+ */
+BOOST_AUTO_TEST_CASE(node_payloads_are_cached_per_version)
+{
+    static const char tag = 0;
+    static const char other_tag = 0;
+
+    const pubsub::node_version  first_version;
+    pubsub::node                node(first_version, version1);
+    unsigned                    builds = 0;
+
+    BOOST_CHECK_EQUAL(json::number(1), node.payload(&tag, pubsub::node::update_range(), count_builds(builds)));
+    BOOST_CHECK_EQUAL(json::number(1), node.payload(&tag, pubsub::node::update_range(), count_builds(builds)));
+    BOOST_CHECK_EQUAL(json::number(2), node.payload(&other_tag, pubsub::node::update_range(), count_builds(builds)));
+
+    node.update(version2, 1000u);
+    const pubsub::node          copy(node);
+
+    BOOST_CHECK_EQUAL(json::number(3), node.payload(&tag, node.updates_from(first_version), count_builds(builds)));
+    BOOST_CHECK_EQUAL(json::number(3), copy.payload(&tag, copy.updates_from(first_version), count_builds(builds)));
+    BOOST_CHECK_EQUAL(json::number(4), node.payload(&tag, pubsub::node::update_range(), count_builds(builds)));
+    BOOST_CHECK_EQUAL(4u, builds);
+
+    // the copy keeps the payloads of its version, when the node changes
+    node.update(version3, 1000u);
+    BOOST_CHECK_EQUAL(json::number(4), copy.payload(&tag, pubsub::node::update_range(), count_builds(builds)));
+    BOOST_CHECK_EQUAL(json::number(5), node.payload(&tag, pubsub::node::update_range(), count_builds(builds)));
+    BOOST_CHECK_EQUAL(5u, builds);
+}
+
 BOOST_AUTO_TEST_CASE(node_equal_data)
 {
     const pubsub::node_version  current_version;
@@ -193,3 +293,34 @@ BOOST_AUTO_TEST_CASE( node_add_keys )
 
 	BOOST_CHECK_EQUAL( name1, name2 );
 }
+
+/**
+ * @test node_names that compare equal, must have equal hash values
+ */
+BOOST_AUTO_TEST_CASE( node_name_hash_value )
+{
+    const pubsub::node_name name1( json::parse_single_quoted( "{ 'a': '1', 'b': 'b' }" ).upcast< json::object >() );
+    const pubsub::node_name name2( json::parse_single_quoted( "{ 'b': 'b', 'a': '1' }" ).upcast< json::object >() );
+    const pubsub::node_name name3( json::parse_single_quoted( "{ 'a': '1', 'b': 'c' }" ).upcast< json::object >() );
+
+    BOOST_CHECK_EQUAL( name1, name2 );
+    BOOST_CHECK_EQUAL( hash_value( name1 ), hash_value( name2 ) );
+    BOOST_CHECK_NE( hash_value( name1 ), hash_value( name3 ) );
+    BOOST_CHECK_EQUAL( hash_value( pubsub::node_name() ), hash_value( pubsub::node_name() ) );
+}
+
+/**
+ * @test the precalculated hash value must follow changes to the name
+ */
+BOOST_AUTO_TEST_CASE( node_name_hash_follows_add )
+{
+    const pubsub::node_name expected( json::parse_single_quoted( "{ 'a': '1', 'b': 'b' }" ).upcast< json::object >() );
+    pubsub::node_name       name;
+
+    name.add( pubsub::key( pubsub::key_domain( "b" ), "b" ) );
+    BOOST_CHECK_NE( hash_value( expected ), hash_value( name ) );
+
+    name.add( pubsub::key( pubsub::key_domain( "a" ), "1" ) );
+    BOOST_CHECK_EQUAL( expected, name );
+    BOOST_CHECK_EQUAL( hash_value( expected ), hash_value( name ) );
+}
@@ -10,109 +10,409 @@
 #include "pubsub/subscribed_node.h"
 #include "tools/asstring.h"
 #include <vector>
-#include <map>
+#include <algorithm>
+#include <stdexcept>
+#include <boost/noncopyable.hpp>
+#include <boost/weak_ptr.hpp>
+#include <boost/functional/hash.hpp>
+#include <boost/unordered_map.hpp>
 #include <boost/enable_shared_from_this.hpp>
 #include <boost/thread/mutex.hpp>
 #include <boost/bind.hpp>
+#include <boost/asio/deadline_timer.hpp>
+#include <boost/asio/placeholders.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
 
 namespace pubsub {
 namespace {
 
+	/*
+	 * list of configurations in the order they where added. To find the first configuration that applies to a node
+	 * name, without testing every node_group, the configurations are indexed by one of the keys or, if there is
+	 * no required key, by one of the domains a node name must contain to be in the group. Only the groups, that are
+	 * indexed by a key or by a domain of the node name and the groups without any requirement have to be tested.
+	 */
 	class configuration_list
     {
     public:
         explicit configuration_list(const configuration& default_configuration)
             : default_(new configuration(default_configuration))
+            , next_sequence_(0)
         {
         }
 
         void add_configuration(const node_group& node_name, const configuration& new_config)
         {
-            const list_t::value_type new_value(node_name, boost::shared_ptr<const configuration>(new configuration(new_config)));
-            configurations_.push_back(new_value);
+            const entry_ptr new_entry(new entry(node_name, new_config, next_sequence_++));
+
+            index_of(*new_entry).push_back(new_entry);
+            configurations_.push_back(new_entry);
         }
 
         void remove_configuration(const node_group& node_name)
         {
             list_t::iterator pos = configurations_.begin();
 
-            for ( ; pos != configurations_.end() && pos->first == node_name; ++pos )
+            for ( ; pos != configurations_.end() && (*pos)->group != node_name; ++pos )
                 ;
 
             if ( pos == configurations_.end() )
                 throw std::runtime_error("no such configuration: " + tools::as_string(node_name));
 
+            const entry& old_entry = **pos;
+
+            if ( !old_entry.keys.empty() )
+            {
+                remove_from_index(by_key_, old_entry.keys.front(), *pos);
+            }
+            else if ( !old_entry.domains.empty() )
+            {
+                remove_from_index(by_domain_, old_entry.domains.front(), *pos);
+            }
+            else
+            {
+                unconstrained_.erase(std::find(unconstrained_.begin(), unconstrained_.end(), *pos));
+            }
+
             configurations_.erase(pos);
         }
 
         boost::shared_ptr<const configuration> get_configuration(const node_name& name) const
         {
-            list_t::const_iterator pos = configurations_.begin();
+            const entry* result = 0;
+            find_first_match(unconstrained_, name, result);
 
-            for ( ; pos != configurations_.end() && !pos->first.in_group(name); ++pos )
-                ;
+            for ( node_name::key_list::const_iterator k = name.keys().begin(); k != name.keys().end(); ++k )
+            {
+                const by_key_t::const_iterator key_index = by_key_.find(*k);
+
+                if ( key_index != by_key_.end() )
+                    find_first_match(key_index->second, name, result);
+
+                const by_domain_t::const_iterator domain_index = by_domain_.find(k->domain());
 
-            return pos == configurations_.end()
+                if ( domain_index != by_domain_.end() )
+                    find_first_match(domain_index->second, name, result);
+            }
+
+            return result == 0
                 ? default_
-                : pos->second;
+                : result->config;
         }
 
     private:
-        typedef std::vector<std::pair<node_group, boost::shared_ptr<const configuration> > > list_t;
+        struct entry
+        {
+            entry(const node_group& g, const configuration& c, unsigned long s)
+                : group(g)
+                , config(new configuration(c))
+                , sequence(s)
+                , keys(g.required_keys())
+                , domains(g.required_domains())
+            {
+            }
+
+            const node_group                                group;
+            const boost::shared_ptr<const configuration>    config;
+            // the position in the order of configurations
+            const unsigned long                             sequence;
+            const std::vector<key>                          keys;
+            const std::vector<key_domain>                   domains;
+        };
+
+        typedef boost::shared_ptr<const entry> entry_ptr;
+        // ordered by entry::sequence
+        typedef std::vector<entry_ptr> list_t;
+        typedef boost::unordered_map<key, list_t, boost::hash<key> > by_key_t;
+        typedef boost::unordered_map<key_domain, list_t, boost::hash<key_domain> > by_domain_t;
+
+        list_t& index_of(const entry& e)
+        {
+            if ( !e.keys.empty() )
+                return by_key_[e.keys.front()];
+
+            if ( !e.domains.empty() )
+                return by_domain_[e.domains.front()];
+
+            return unconstrained_;
+        }
+
+        // updates result, if index contains a matching entry, that was added before result
+        static void find_first_match(const list_t& index, const node_name& name, const entry*& result)
+        {
+            for ( list_t::const_iterator e = index.begin();
+                e != index.end() && ( result == 0 || (*e)->sequence < result->sequence ); ++e )
+            {
+                if ( (*e)->group.in_group(name) )
+                {
+                    result = e->get();
+                    return;
+                }
+            }
+        }
+
+        template < class Index >
+        static void remove_from_index(Index& index, const typename Index::key_type& k, const entry_ptr& old_entry)
+        {
+            const typename Index::iterator pos = index.find(k);
+            assert(pos != index.end());
+
+            list_t& entries = pos->second;
+            entries.erase(std::find(entries.begin(), entries.end(), old_entry));
+
+            if ( entries.empty() )
+                index.erase(pos);
+        }
+
         list_t                                          configurations_;
+        list_t                                          unconstrained_;
+        by_key_t                                        by_key_;
+        by_domain_t                                     by_domain_;
         const boost::shared_ptr<const configuration>    default_;
+        unsigned long                                   next_sequence_;
+    };
+
+    const std::size_t number_of_shards = 64u;
+
+    // minimum delay, before the eviction of a node, that could not be evicted, is retried
+    const boost::posix_time::time_duration eviction_retry_delay = boost::posix_time::millisec(100);
+
+    /*
+     * nodes by name, partitioned into shards by the precalculated hash value of the node name. Every shard has its own
+     * mutex, so that operations on nodes that are located in different shards do not contend on a common lock.
+     */
+    class node_table : boost::noncopyable
+    {
+    public:
+        typedef boost::shared_ptr<subscribed_node> node_ptr;
+
+        node_ptr find(const node_name& name) const
+        {
+            const shard& s = shard_by_name(name);
+            boost::mutex::scoped_lock   lock(s.mutex);
+
+            const node_list_t::const_iterator pos = s.nodes.find(name);
+
+            return pos == s.nodes.end() ? node_ptr() : pos->second;
+        }
+
+        /*
+         * returns the named node. If there is no such node, a new node is created by calling create() and the
+         * second member of the result will be true. create() is called while the shard is locked.
+         */
+        template < class Factory >
+        std::pair<node_ptr, bool> find_or_create(const node_name& name, Factory create)
+        {
+            shard& s = shard_by_name(name);
+            boost::mutex::scoped_lock   lock(s.mutex);
+
+            const node_list_t::iterator pos = s.nodes.find(name);
+
+            if ( pos != s.nodes.end() )
+                return std::make_pair(pos->second, false);
+
+            const node_ptr new_node = create();
+            s.nodes.insert(std::make_pair(name, new_node));
+
+            return std::make_pair(new_node, true);
+        }
+
+        /*
+         * removes the named node, if pred(node) returns true. pred() is called while the shard is locked.
+         * Returns the removed node, or a null pointer, if nothing was removed.
+         */
+        template < class Predicate >
+        node_ptr remove_if(const node_name& name, Predicate pred)
+        {
+            shard& s = shard_by_name(name);
+            boost::mutex::scoped_lock   lock(s.mutex);
+
+            const node_list_t::iterator pos = s.nodes.find(name);
+
+            if ( pos == s.nodes.end() || !pred(pos->second) )
+                return node_ptr();
+
+            const node_ptr result = pos->second;
+            s.nodes.erase(pos);
+
+            return result;
+        }
+
+    private:
+        typedef boost::unordered_map<node_name, node_ptr, boost::hash<node_name> > node_list_t;
+
+        struct shard
+        {
+            mutable boost::mutex    mutex;
+            node_list_t             nodes;
+        };
+
+        shard& shard_by_name(const node_name& name)
+        {
+            return shards_[hash_value(name) % number_of_shards];
+        }
+
+        const shard& shard_by_name(const node_name& name) const
+        {
+            return shards_[hash_value(name) % number_of_shards];
+        }
+
+        shard   shards_[number_of_shards];
+    };
+
+    /*
+     * reverse index of the nodes, a subscriber is subscribed to. With this index, unsubscribing a subscriber from
+     * all of its nodes does not have to visit every node in the tree. Like the node_table, the index is partitioned
+     * into shards; here by the address of the subscriber.
+     *
+     * The nodes are referenced weakly. The subscribers are referenced by the owning pointer, so that an entry can not
+     * be inherited by a new subscriber, that happens to reuse the address of a destroyed subscriber. Entries of
+     * failed subscriptions are removed by the root.
+     */
+    class subscriber_index : boost::noncopyable
+    {
+    public:
+        typedef std::vector<std::pair<node_name, boost::shared_ptr<subscribed_node> > > node_list;
+
+        void add(const boost::shared_ptr<subscriber>& user, const node_name& name,
+            const boost::shared_ptr<subscribed_node>& node)
+        {
+            shard& s = shard_by_subscriber(user);
+            boost::mutex::scoped_lock   lock(s.mutex);
+
+            s.subscribers[user][name] = node;
+        }
+
+        void remove(const boost::shared_ptr<subscriber>& user, const node_name& name)
+        {
+            shard& s = shard_by_subscriber(user);
+            boost::mutex::scoped_lock   lock(s.mutex);
+
+            const subscriber_list_t::iterator pos = s.subscribers.find(user);
+
+            if ( pos == s.subscribers.end() )
+                return;
+
+            pos->second.erase(name);
+
+            if ( pos->second.empty() )
+                s.subscribers.erase(pos);
+        }
+
+        /*
+         * removes all entries of the given subscriber from the index and returns the nodes, that still exist,
+         * together with their names
+         */
+        node_list remove_all(const boost::shared_ptr<subscriber>& user)
+        {
+            node_list result;
+            nodes_by_name_t nodes;
+
+            {
+                shard& s = shard_by_subscriber(user);
+                boost::mutex::scoped_lock   lock(s.mutex);
+
+                const subscriber_list_t::iterator pos = s.subscribers.find(user);
+
+                if ( pos == s.subscribers.end() )
+                    return result;
+
+                nodes.swap(pos->second);
+                s.subscribers.erase(pos);
+            }
+
+            result.reserve(nodes.size());
+
+            for ( nodes_by_name_t::const_iterator node = nodes.begin(); node != nodes.end(); ++node )
+            {
+                const boost::shared_ptr<subscribed_node> existing_node = node->second.lock();
+
+                if ( existing_node.get() )
+                    result.push_back(std::make_pair(node->first, existing_node));
+            }
+
+            return result;
+        }
+
+    private:
+        typedef boost::unordered_map<node_name, boost::weak_ptr<subscribed_node>, boost::hash<node_name> > nodes_by_name_t;
+        typedef boost::unordered_map<boost::shared_ptr<subscriber>, nodes_by_name_t,
+            boost::hash<boost::shared_ptr<subscriber> > > subscriber_list_t;
+
+        struct shard
+        {
+            boost::mutex        mutex;
+            subscriber_list_t   subscribers;
+        };
+
+        shard& shard_by_subscriber(const boost::shared_ptr<subscriber>& user)
+        {
+            return shards_[boost::hash<const subscriber*>()(user.get()) % number_of_shards];
+        }
+
+        shard   shards_[number_of_shards];
     };
 }
 
-	class root::impl
+	class root::impl : public node_owner, public boost::enable_shared_from_this<root::impl>
     {
     public:
         impl(boost::asio::io_service& io_queue, adapter& adapter, const configuration& default_configuration)
             : queue_(io_queue)
             , adapter_(adapter)
             , configurations_(default_configuration)
+            , evicted_nodes_(0)
+            , evicted_bytes_(0)
         {
         }
 
         void add_configuration(const node_group& node_name, const configuration& new_config)
         {
-            boost::mutex::scoped_lock   lock(mutex_);
+            boost::mutex::scoped_lock   lock(configuration_mutex_);
             configurations_.add_configuration(node_name, new_config);
         }
 
         void remove_configuration(const node_group& node_name)
         {
-            boost::mutex::scoped_lock   lock(mutex_);
+            boost::mutex::scoped_lock   lock(configuration_mutex_);
             configurations_.remove_configuration(node_name);
         }
 
         void subscribe(const boost::shared_ptr<subscriber>& s, const node_name& node_name)
         {
-        	boost::shared_ptr<subscribed_node>			node;
-        	boost::shared_ptr<validation_call_back>		validate;
-        	boost::shared_ptr<authorization_call_back>	authorizer;
+        	std::pair<boost::shared_ptr<subscribed_node>, bool> node_and_created;
+        	subscribed_node::add_result                         added;
 
+        	// a node, that is evicted concurrently, doesn't accept new subscribers. The next lookup will not find
+        	// the evicted node anymore.
+        	do
         	{
-                boost::mutex::scoped_lock   lock(mutex_);
-                const node_list_t::iterator pos = nodes_.find(node_name);
+        	    node_and_created = nodes_.find_or_create(node_name, boost::bind(&impl::create_node, this, boost::cref(node_name)));
+        	    assert( node_and_created.first.get() );
 
-                if ( pos != nodes_.end() )
-                {
-                	node = pos->second;
+        	    subscriptions_.add( s, node_name, node_and_created.first );
+        	    added = node_and_created.first->add_subscriber(s, adapter_, queue_, node_name );
+        	}
+        	while ( added == subscribed_node::node_evicted );
 
-                	if ( node->authorization_required() )
-                		authorizer = create_authorizer( node, node_name, s, queue_, adapter_ );
-                }
-                else
-                {
-                	node.reset( new subscribed_node( configurations_.get_configuration( node_name ) ) );
-                	validate = create_validator( node, node_name, s, queue_, adapter_ );
-                	nodes_.insert( std::make_pair( node_name, node ) );
-                }
-            }
+        	if ( added == subscribed_node::node_in_error_state )
+        	{
+        	    subscriptions_.remove( s, node_name );
+        	    return;
+        	}
+
+        	boost::shared_ptr<subscribed_node>			node = node_and_created.first;
+        	boost::shared_ptr<validation_call_back>		validate;
+        	boost::shared_ptr<authorization_call_back>	authorizer;
 
-        	assert( node.get() );
-        	node->add_subscriber(s, adapter_, queue_, node_name );
+        	if ( node_and_created.second )
+        	{
+        	    validate = create_validator( node, node_name, s, queue_, adapter_, owner() );
+        	}
+        	else if ( node->authorization_required() )
+        	{
+        	    authorizer = create_authorizer( node, node_name, s, queue_, adapter_, owner() );
+        	}
 
         	if ( validate.get() )
         	{
@@ -126,58 +426,168 @@ namespace {
 
         void update_node(const node_name& node_name, const json::value& new_data)
         {
-        	boost::shared_ptr<subscribed_node>		node;
-
-        	{
-				boost::mutex::scoped_lock   lock(mutex_);
-				const node_list_t::iterator pos = nodes_.find(node_name);
-
-				if ( pos != nodes_.end() )
-					node = pos->second;
-        	}
+        	const boost::shared_ptr<subscribed_node> node = nodes_.find(node_name);
 
         	if ( node.get() )
         	{
-        		node->change_data(node_name, new_data);
+        		node->change_data(node_name, new_data, queue_);
 			}
         }
 
         bool unsubscribe(const boost::shared_ptr<subscriber>& user, const node_name& node_name)
         {
-            boost::mutex::scoped_lock   lock(mutex_);
-            const node_list_t::iterator pos = nodes_.find(node_name);
+            subscriptions_.remove(user, node_name);
+            const boost::shared_ptr<subscribed_node> node = nodes_.find(node_name);
 
-            if ( pos != nodes_.end() )
-            {
-            	return pos->second->remove_subscriber(user);
-            }
+            if ( !node.get() || !node->remove_subscriber(user) )
+                return false;
+
+            schedule_eviction(node_name, *node);
 
-            return false;
+            return true;
         }
 
         unsigned unsubscribe_all( const boost::shared_ptr<subscriber>& user )
         {
+            const subscriber_index::node_list nodes = subscriptions_.remove_all( user );
             unsigned result = 0;
 
-            boost::mutex::scoped_lock   lock(mutex_);
-
-            for ( node_list_t::iterator node = nodes_.begin(), end = nodes_.end(); node != end; ++node )
+            for ( subscriber_index::node_list::const_iterator node = nodes.begin(); node != nodes.end(); ++node )
             {
                 if ( node->second->remove_subscriber( user ) )
+                {
+                    schedule_eviction( node->first, *node->second );
                     ++result;
+                }
             }
 
             return result;
         }
 
+        std::size_t evicted_nodes() const
+        {
+            boost::mutex::scoped_lock   lock(statistics_mutex_);
+            return evicted_nodes_;
+        }
+
+        std::size_t evicted_bytes() const
+        {
+            boost::mutex::scoped_lock   lock(statistics_mutex_);
+            return evicted_bytes_;
+        }
+
+        void subscriptions_failed(const node_name& name, const subscribed_node& node,
+            const node_owner::subscriber_list& users)
+        {
+            for ( node_owner::subscriber_list::const_iterator user = users.begin(); user != users.end(); ++user )
+                subscriptions_.remove(*user, name);
+
+            schedule_eviction(name, node);
+        }
+
     private:
+        typedef boost::shared_ptr<boost::asio::deadline_timer> timer_ptr;
+        typedef boost::unordered_map<node_name, timer_ptr, boost::hash<node_name> > eviction_timers_t;
+
+        boost::weak_ptr<node_owner> owner()
+        {
+            return boost::weak_ptr<node_owner>(shared_from_this());
+        }
+
+        // starts a timer to remove the node from the tree, when the node stays unused for the configured timeout.
+        // There is at most one pending timer per node; a timer, that fires too early, is restarted by evict_node().
+        // A zero node timeout disables eviction.
+        void schedule_eviction(const node_name& name, const subscribed_node& node)
+        {
+            if ( node.node_timeout() == boost::posix_time::time_duration() || !node.unused() )
+                return;
+
+            boost::mutex::scoped_lock   lock(eviction_mutex_);
+            timer_ptr& timer = eviction_timers_[name];
+
+            if ( timer.get() )
+                return;
+
+            timer.reset(new boost::asio::deadline_timer(queue_, node.node_timeout()));
+            async_wait_for_eviction(*timer, name);
+        }
+
+        // the handler references this weakly, so that a handler, that is already queued, when this gets destroyed,
+        // does not access a destroyed object
+        void async_wait_for_eviction(boost::asio::deadline_timer& timer, const node_name& name)
+        {
+            timer.async_wait(boost::bind(&impl::eviction_timeout,
+                boost::weak_ptr<impl>(shared_from_this()), boost::asio::placeholders::error, name));
+        }
+
+        static void eviction_timeout(const boost::weak_ptr<impl>& self, const boost::system::error_code& error,
+            const node_name& name)
+        {
+            const boost::shared_ptr<impl> existing_self = self.lock();
+
+            if ( error != boost::asio::error::operation_aborted && existing_self.get() )
+                existing_self->evict_node(name);
+        }
+
+        void evict_node(const node_name& name)
+        {
+            boost::mutex::scoped_lock   eviction_lock(eviction_mutex_);
+            const eviction_timers_t::iterator timer = eviction_timers_.find(name);
+            assert( timer != eviction_timers_.end() );
+
+            const boost::shared_ptr<subscribed_node> node = nodes_.remove_if(name,
+                boost::bind(&subscribed_node::evict, _1, boost::posix_time::microsec_clock::universal_time()));
+
+            if ( !node.get() )
+            {
+                // the node was used again, after the timer was started, or the node has a pending notification
+                const boost::shared_ptr<subscribed_node> unused_node = nodes_.find(name);
+
+                if ( unused_node.get() && unused_node->unused() )
+                {
+                    timer->second->expires_from_now(std::max(unused_node->node_timeout(), eviction_retry_delay));
+                    async_wait_for_eviction(*timer->second, name);
+                }
+                else
+                {
+                    eviction_timers_.erase(timer);
+                }
+
+                return;
+            }
+
+            eviction_timers_.erase(timer);
+            eviction_lock.unlock();
+
+            const std::size_t size = node->data_size();
+
+            boost::mutex::scoped_lock   lock(statistics_mutex_);
+            ++evicted_nodes_;
+            evicted_bytes_ += size;
+        }
+
+        boost::shared_ptr<subscribed_node> create_node(const node_name& name)
+        {
+            boost::mutex::scoped_lock   lock(configuration_mutex_);
+
+            return boost::shared_ptr<subscribed_node>(
+                new subscribed_node( configurations_.get_configuration( name ) ) );
+        }
+
         boost::asio::io_service&                queue_;
         adapter&                                adapter_;
 
-        boost::mutex                            mutex_;
+        boost::mutex                            configuration_mutex_;
         configuration_list                      configurations_;
-        typedef std::map<node_name, boost::shared_ptr<subscribed_node> > node_list_t;
-        node_list_t                             nodes_;
+        node_table                              nodes_;
+        subscriber_index                        subscriptions_;
+
+        boost::mutex                            eviction_mutex_;
+        eviction_timers_t                       eviction_timers_;
+
+        mutable boost::mutex                    statistics_mutex_;
+        std::size_t                             evicted_nodes_;
+        std::size_t                             evicted_bytes_;
     };
 
     root::root(boost::asio::io_service& io_queue, adapter& adapter, const configuration& default_configuration)
@@ -185,6 +595,10 @@ namespace {
     {
     }
 
+    root::~root()
+    {
+    }
+
     void root::add_configuration(const node_group& node_name, const configuration& new_config)
     {
         pimpl_->add_configuration(node_name, new_config);
@@ -215,4 +629,14 @@ namespace {
         pimpl_->update_node(node_name, new_data);
     }
 
+    std::size_t root::evicted_nodes() const
+    {
+        return pimpl_->evicted_nodes();
+    }
+
+    std::size_t root::evicted_bytes() const
+    {
+        return pimpl_->evicted_bytes();
+    }
+
 }
@@ -6,6 +6,7 @@
 #define SIOUX_SOURCE_PUBSUB_ROOT_H
 
 #include <boost/shared_ptr.hpp>
+#include <cstddef>
 
 namespace boost {
     namespace asio {
@@ -47,6 +48,13 @@ namespace pubsub
          */
         root(boost::asio::io_service& io_queue, adapter& adapter, const configuration& default_configuration);
 
+        /**
+         * @brief cancels all pending node evictions
+         *
+         * Handlers of the io_queue, that are still pending, when the root is destroyed, will not access the destroyed root.
+         */
+        ~root();
+
         /**
          * @brief adds or changes the configuration of the given group of nodes
          *
@@ -90,13 +98,26 @@ namespace pubsub
          */
         void update_node(const node_name& node_name, const json::value& new_data);
 
+        /**
+         * @brief number of nodes, that where removed from the tree, because they had no subscribers for the
+         *        configured node timeout
+         *
+         * @sa configuration::node_timeout()
+         */
+        std::size_t evicted_nodes() const;
+
+        /**
+         * @brief approximated number of bytes, that where reclaimed by evicting nodes from the tree
+         */
+        std::size_t evicted_bytes() const;
+
     private:
         // no copy, no assignment; not implemented
         root(const root&);
         root& operator=(const root&);
 
         class impl;
-        impl*   pimpl_;
+        boost::shared_ptr<impl> pimpl_;
     };
 
 } // namespace pubsub
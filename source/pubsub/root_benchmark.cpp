@@ -0,0 +1,112 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+#include "pubsub/root.h"
+#include "pubsub/pubsub.h"
+#include "pubsub/node.h"
+#include "pubsub/configuration.h"
+#include "tools/elapse_timer.h"
+#include "tools/asstring.h"
+#include <boost/asio/io_service.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/bind.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <iostream>
+#include <vector>
+
+/*
+ * measures the throughput of root::update_node() with a growing number of threads, that update disjoint sets of
+ * nodes. Every node has a single subscriber.
+ */
+namespace
+{
+    class synchronous_adapter : public pubsub::adapter
+    {
+    private:
+        virtual void validate_node( const pubsub::node_name&, const boost::shared_ptr< pubsub::validation_call_back >& result )
+        {
+            result->is_valid();
+        }
+
+        virtual void authorize( const boost::shared_ptr< pubsub::subscriber >&, const pubsub::node_name&,
+            const boost::shared_ptr< pubsub::authorization_call_back >& result )
+        {
+            result->is_authorized();
+        }
+
+        virtual void node_init( const pubsub::node_name&, const boost::shared_ptr< pubsub::initialization_call_back >& result )
+        {
+            result->initial_value( json::number( 0 ) );
+        }
+    };
+
+    class null_subscriber : public pubsub::subscriber
+    {
+    private:
+        virtual void on_update( const pubsub::node_name&, const pubsub::node& )
+        {
+        }
+    };
+
+    const unsigned number_of_nodes        = 10000u;
+    const unsigned updates_per_thread     = 200000u;
+
+    pubsub::node_name node_name_by_index( unsigned index )
+    {
+        return pubsub::node_name().add( pubsub::key( pubsub::key_domain( "id" ), tools::as_string( index ) ) );
+    }
+
+    void update_nodes( pubsub::root& root, const std::vector< pubsub::node_name >& names, unsigned thread, unsigned threads )
+    {
+        unsigned node = thread;
+
+        for ( unsigned update = 0; update != updates_per_thread; ++update )
+        {
+            root.update_node( names[ node ], json::number( static_cast< int >( update ) ) );
+
+            node += threads;
+            if ( node >= names.size() )
+                node = thread;
+        }
+    }
+}
+
+int main()
+{
+    boost::asio::io_service             queue;
+    synchronous_adapter                 adapter;
+    pubsub::root                        root( queue, adapter, pubsub::configurator().authorization_not_required() );
+
+    const boost::shared_ptr< pubsub::subscriber > subscriber( new null_subscriber );
+    std::vector< pubsub::node_name >    names;
+
+    for ( unsigned index = 0; index != number_of_nodes; ++index )
+    {
+        names.push_back( node_name_by_index( index ) );
+        root.subscribe( subscriber, names.back() );
+    }
+
+    queue.run();
+
+    std::cout << "nodes: " << number_of_nodes << "; updates per thread: " << updates_per_thread << std::endl;
+
+    for ( unsigned threads = 1; threads <= 16; threads *= 2 )
+    {
+        boost::thread_group     workers;
+        const tools::elapse_timer time;
+
+        for ( unsigned thread = 0; thread != threads; ++thread )
+            workers.create_thread( boost::bind( update_nodes, boost::ref( root ), boost::cref( names ), thread, threads ) );
+
+        workers.join_all();
+
+        const boost::posix_time::time_duration elapsed = time.elapsed();
+        const double updates_per_second = static_cast< double >( threads ) * updates_per_thread
+            / ( static_cast< double >( elapsed.total_microseconds() ) / 1000000.0 );
+
+        std::cout << "threads: " << threads
+                  << "; elapsed: " << elapsed
+                  << "; updates/s: " << static_cast< unsigned long >( updates_per_second ) << std::endl;
+    }
+}
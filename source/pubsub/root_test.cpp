@@ -7,8 +7,11 @@
 #include "pubsub/root.h"
 #include "pubsub/test_helper.h"
 #include "pubsub/configuration.h"
+#include "pubsub/node_group.h"
+#include "pubsub/key.h"
 #include "tools/io_service.h"
 #include <boost/asio/io_service.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
 
 using namespace pubsub;
 
@@ -414,6 +417,89 @@ BOOST_AUTO_TEST_CASE(notify_subscribed_node)
     BOOST_CHECK(test_user(subscriber).not_on_update_called());
 }
 
+/**
+ * @test with a configured fan out batch size, subscribers are notified asynchronous and updates, that arrive
+ *       while a notification is pending, are coalesced.
+ */
+BOOST_AUTO_TEST_CASE(asynchronous_fan_out_of_updates)
+{
+    boost::asio::io_service                 queue;
+    test::adapter                           adapter;
+    pubsub::root                            root(queue, adapter,
+        configurator().authorization_not_required().fan_out_batch_size(2u));
+
+    std::vector< boost::shared_ptr< ::pubsub::subscriber> > subscribers;
+    for ( int i = 0; i != 5; ++i )
+        subscribers.push_back( boost::shared_ptr< ::pubsub::subscriber>(new test::subscriber) );
+
+    adapter.answer_validation_request(random_node_name, true);
+    adapter.answer_initialization_request(random_node_name, json::number(42));
+
+    for ( std::size_t i = 0; i != subscribers.size(); ++i )
+        root.subscribe(subscribers[i], random_node_name);
+
+    tools::run(queue);
+
+    for ( std::size_t i = 0; i != subscribers.size(); ++i )
+        BOOST_CHECK(test_user(subscribers[i]).on_update_called(random_node_name, json::number(42)));
+
+    root.update_node(random_node_name, json::number(43));
+
+    // no notification before the queue is run
+    for ( std::size_t i = 0; i != subscribers.size(); ++i )
+        BOOST_CHECK(test_user(subscribers[i]).not_on_update_called());
+
+    root.update_node(random_node_name, json::number(44));
+    root.update_node(random_node_name, json::number(45));
+    BOOST_CHECK( root.unsubscribe(subscribers.back(), random_node_name) );
+
+    tools::run(queue);
+
+    for ( std::size_t i = 0; i != subscribers.size() - 1; ++i )
+    {
+        BOOST_CHECK(test_user(subscribers[i]).on_update_called(random_node_name, json::number(43)));
+        BOOST_CHECK(test_user(subscribers[i]).on_update_called(random_node_name, json::number(45)));
+        BOOST_CHECK(test_user(subscribers[i]).not_on_update_called());
+    }
+
+    BOOST_CHECK(test_user(subscribers.back()).not_on_update_called());
+}
+
+/**
+ * @test updates within the min_update_period must be coalesced and published, when the period elapsed
+ */
+BOOST_AUTO_TEST_CASE(updates_are_coalesced_within_min_update_period)
+{
+    boost::asio::io_service                 queue;
+    test::adapter                           adapter;
+    pubsub::root                            root(queue, adapter,
+        configurator().authorization_not_required().min_update_period(boost::posix_time::millisec(50)));
+
+    boost::shared_ptr< ::pubsub::subscriber> subscriber(new test::subscriber);
+
+    adapter.answer_validation_request(random_node_name, true);
+    adapter.answer_initialization_request(random_node_name, json::number(42));
+
+    root.subscribe(subscriber, random_node_name);
+    tools::run(queue);
+
+    BOOST_CHECK(test_user(subscriber).on_update_called(random_node_name, json::number(42)));
+
+    const boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+
+    root.update_node(random_node_name, json::number(43));
+    root.update_node(random_node_name, json::number(44));
+
+    // the period is not elapsed since the initial data was published
+    BOOST_CHECK(test_user(subscriber).not_on_update_called());
+
+    tools::run(queue);
+
+    BOOST_CHECK(test_user(subscriber).on_update_called(random_node_name, json::number(44)));
+    BOOST_CHECK(test_user(subscriber).not_on_update_called());
+    BOOST_CHECK_GE(boost::posix_time::microsec_clock::universal_time() - start, boost::posix_time::millisec(40));
+}
+
 /**
  *  @test while a node is in the state of being validated, an other subscription on the same node must be held until the validation
  *        is finished.
@@ -554,6 +640,280 @@ BOOST_AUTO_TEST_CASE( unsubscribe_all )
     BOOST_CHECK( subscriber.unique() );
 }
 
+/**
+ * @test unsubscribe_all() only counts the subscriptions that are still active
+ */
+BOOST_AUTO_TEST_CASE( unsubscribe_all_after_unsubscribe )
+{
+    boost::asio::io_service                 queue;
+    test::adapter                           adapter;
+    pubsub::root                            root(queue, adapter, configurator().authorization_not_required() );
+
+    boost::shared_ptr< ::pubsub::subscriber> subscriber(new test::subscriber);
+    boost::shared_ptr< ::pubsub::subscriber> other_subscriber(new test::subscriber);
+
+    adapter.answer_validation_request(random_node_name, true);
+    adapter.answer_validation_request(other_node_name, true);
+    adapter.answer_initialization_request(random_node_name, json::number(42));
+    adapter.answer_initialization_request(other_node_name, json::number(43));
+    root.subscribe(subscriber, random_node_name);
+    root.subscribe(subscriber, other_node_name);
+    root.subscribe(other_subscriber, other_node_name);
+
+    tools::run(queue);
+
+    BOOST_CHECK( root.unsubscribe( subscriber, random_node_name ) );
+    BOOST_CHECK_EQUAL( 1u, root.unsubscribe_all( subscriber ) );
+    BOOST_CHECK_EQUAL( 0u, root.unsubscribe_all( subscriber ) );
+    BOOST_CHECK( subscriber.unique() );
+
+    // the other subscriber is still subscribed
+    root.update_node(other_node_name, json::number(44));
+    tools::run(queue);
+    BOOST_CHECK(test_user(other_subscriber).on_update_called(other_node_name, json::number(44)));
+    BOOST_CHECK_EQUAL( 1u, root.unsubscribe_all( other_subscriber ) );
+}
+
+/**
+ * @test subscriptions, that failed, must not be kept by the root
+ */
+BOOST_AUTO_TEST_CASE( failed_subscriptions_are_not_kept )
+{
+    boost::asio::io_service                 queue;
+    test::adapter                           adapter;
+    pubsub::root                            root(queue, adapter, configurator().authorization_required() );
+
+    boost::shared_ptr< ::pubsub::subscriber> subscriber(new test::subscriber);
+    boost::shared_ptr< ::pubsub::subscriber> unauthorized_subscriber(new test::subscriber);
+    boost::shared_ptr< ::pubsub::subscriber> late_subscriber(new test::subscriber);
+
+    adapter.answer_validation_request(random_node_name, false);
+    root.subscribe(subscriber, random_node_name);
+
+    adapter.answer_validation_request(other_node_name, true);
+    adapter.answer_authorization_request(unauthorized_subscriber, other_node_name, false);
+    root.subscribe(unauthorized_subscriber, other_node_name);
+
+    tools::run(queue);
+    root.subscribe(late_subscriber, random_node_name);
+    tools::run(queue);
+
+    BOOST_CHECK(test_user(subscriber).on_invalid_node_subscription_called(random_node_name));
+    BOOST_CHECK(test_user(late_subscriber).on_invalid_node_subscription_called(random_node_name));
+    BOOST_CHECK(test_user(unauthorized_subscriber).on_unauthorized_node_subscription_called(other_node_name));
+
+    // the test adapter keeps a reference to the reported subscribers, until the report is checked
+    BOOST_CHECK( adapter.invalid_node_subscription_reported(random_node_name, subscriber) );
+    BOOST_CHECK( adapter.unauthorized_subscription_reported(other_node_name, unauthorized_subscriber) );
+
+    BOOST_CHECK( subscriber.unique() );
+    BOOST_CHECK( unauthorized_subscriber.unique() );
+    BOOST_CHECK( late_subscriber.unique() );
+
+    BOOST_CHECK_EQUAL( 0u, root.unsubscribe_all( subscriber ) );
+    BOOST_CHECK_EQUAL( 0u, root.unsubscribe_all( late_subscriber ) );
+    BOOST_CHECK_EQUAL( 0u, root.unsubscribe_all( unauthorized_subscriber ) );
+}
+
+/**
+ * @test a node without subscribers must be removed from the tree, when the node timeout elapsed
+ */
+BOOST_AUTO_TEST_CASE( unused_node_is_evicted_after_node_timeout )
+{
+    boost::asio::io_service                 queue;
+    test::adapter                           adapter;
+    pubsub::root                            root(queue, adapter,
+        configurator().authorization_not_required().node_timeout(boost::posix_time::millisec(10)) );
+
+    boost::shared_ptr< ::pubsub::subscriber> subscriber(new test::subscriber);
+
+    adapter.answer_validation_request(random_node_name, true);
+    adapter.answer_initialization_request(random_node_name, json::number(42));
+    root.subscribe(subscriber, random_node_name);
+    root.subscribe(subscriber, other_node_name);
+
+    tools::run(queue);
+    BOOST_CHECK(test_user(subscriber).on_update_called(random_node_name, json::number(42)));
+
+    BOOST_CHECK( root.unsubscribe(subscriber, random_node_name) );
+    BOOST_CHECK_EQUAL( 0u, root.evicted_nodes() );
+
+    tools::run(queue);
+    BOOST_CHECK_EQUAL( 1u, root.evicted_nodes() );
+    BOOST_CHECK_EQUAL( node(node_version(), json::number(42)).size(), root.evicted_bytes() );
+
+    // a new subscription to the evicted node results in a new validation
+    root.subscribe(subscriber, random_node_name);
+    BOOST_CHECK( adapter.validation_requested( random_node_name ) );
+}
+
+/**
+ * @test a node, that gets a new subscriber within the node timeout, must not be evicted
+ */
+BOOST_AUTO_TEST_CASE( node_is_not_evicted_when_resubscribed_within_node_timeout )
+{
+    boost::asio::io_service                 queue;
+    test::adapter                           adapter;
+    pubsub::root                            root(queue, adapter,
+        configurator().authorization_not_required().node_timeout(boost::posix_time::millisec(10)) );
+
+    boost::shared_ptr< ::pubsub::subscriber> subscriber(new test::subscriber);
+
+    adapter.answer_validation_request(random_node_name, true);
+    adapter.answer_initialization_request(random_node_name, json::number(42));
+    root.subscribe(subscriber, random_node_name);
+
+    tools::run(queue);
+    BOOST_CHECK(test_user(subscriber).on_update_called(random_node_name, json::number(42)));
+
+    BOOST_CHECK_EQUAL( 1u, root.unsubscribe_all(subscriber) );
+    root.subscribe(subscriber, random_node_name);
+    BOOST_CHECK(test_user(subscriber).on_update_called(random_node_name, json::number(42)));
+
+    tools::run(queue);
+    BOOST_CHECK_EQUAL( 0u, root.evicted_nodes() );
+    BOOST_CHECK( adapter.empty() );
+}
+
+/**
+ * @test without a configured node timeout, unused nodes stay in the tree
+ */
+BOOST_AUTO_TEST_CASE( node_is_not_evicted_without_node_timeout )
+{
+    boost::asio::io_service                 queue;
+    test::adapter                           adapter;
+    pubsub::root                            root(queue, adapter, configurator().authorization_not_required() );
+
+    boost::shared_ptr< ::pubsub::subscriber> subscriber(new test::subscriber);
+
+    adapter.answer_validation_request(random_node_name, true);
+    adapter.answer_initialization_request(random_node_name, json::number(42));
+    root.subscribe(subscriber, random_node_name);
+
+    tools::run(queue);
+    BOOST_CHECK( root.unsubscribe(subscriber, random_node_name) );
+
+    BOOST_CHECK_EQUAL( 0u, tools::run(queue) );
+    BOOST_CHECK_EQUAL( 0u, root.evicted_nodes() );
+
+    root.subscribe(subscriber, random_node_name);
+    BOOST_CHECK(test_user(subscriber).on_update_called(random_node_name, json::number(42)));
+    BOOST_CHECK( adapter.empty() );
+}
+
+/**
+ * @test a node, that lost its only subscriber due to a failed authorization, must be evicted
+ */
+BOOST_AUTO_TEST_CASE( node_is_evicted_after_failed_authorization )
+{
+    boost::asio::io_service                 queue;
+    test::adapter                           adapter;
+    pubsub::root                            root(queue, adapter,
+        configurator().authorization_required().node_timeout(boost::posix_time::millisec(10)) );
+
+    boost::shared_ptr< ::pubsub::subscriber> subscriber(new test::subscriber);
+
+    adapter.answer_validation_request(random_node_name, true);
+    adapter.answer_authorization_request(subscriber, random_node_name, false);
+    root.subscribe(subscriber, random_node_name);
+
+    tools::run(queue);
+    BOOST_CHECK(test_user(subscriber).on_unauthorized_node_subscription_called(random_node_name));
+    BOOST_CHECK_EQUAL( 1u, root.evicted_nodes() );
+}
+
+/**
+ * @test a node, that failed to validate, must be evicted
+ */
+BOOST_AUTO_TEST_CASE( invalid_node_is_evicted )
+{
+    boost::asio::io_service                 queue;
+    test::adapter                           adapter;
+    pubsub::root                            root(queue, adapter,
+        configurator().authorization_not_required().node_timeout(boost::posix_time::millisec(10)) );
+
+    boost::shared_ptr< ::pubsub::subscriber> subscriber(new test::subscriber);
+
+    adapter.answer_validation_request(random_node_name, false);
+    root.subscribe(subscriber, random_node_name);
+
+    tools::run(queue);
+    BOOST_CHECK(test_user(subscriber).on_invalid_node_subscription_called(random_node_name));
+    BOOST_CHECK_EQUAL( 1u, root.evicted_nodes() );
+}
+
+/**
+ * @test destroying a root with a pending node eviction must not result in the eviction beeing executed later
+ */
+BOOST_AUTO_TEST_CASE( pending_eviction_is_canceled_when_root_is_destroyed )
+{
+    boost::asio::io_service                 queue;
+    test::adapter                           adapter;
+    boost::shared_ptr< ::pubsub::subscriber> subscriber(new test::subscriber);
+
+    {
+        pubsub::root                        root(queue, adapter,
+            configurator().authorization_not_required().node_timeout(boost::posix_time::millisec(10)) );
+
+        adapter.answer_validation_request(random_node_name, true);
+        adapter.answer_initialization_request(random_node_name, json::number(42));
+        root.subscribe(subscriber, random_node_name);
+
+        tools::run(queue);
+        BOOST_CHECK( root.unsubscribe(subscriber, random_node_name) );
+
+        // a second unsubscribe / subscribe cycle must not start a second timer
+        root.subscribe(subscriber, random_node_name);
+        BOOST_CHECK( root.unsubscribe(subscriber, random_node_name) );
+    }
+
+    BOOST_CHECK_EQUAL( 1u, tools::run(queue) );
+}
+
+namespace {
+    // subscribes a new subscriber to a new, valid node and returns true, if the subscription had to be authorized
+    bool subscription_authorized(pubsub::root& root, test::adapter& adapter, boost::asio::io_service& queue, const char* name)
+    {
+        const node_name                             node(json::parse_single_quoted(name).upcast<json::object>());
+        const boost::shared_ptr< ::pubsub::subscriber>  subscriber(new test::subscriber);
+
+        adapter.answer_validation_request(node, true);
+        root.subscribe(subscriber, node);
+        tools::run(queue);
+
+        return adapter.authorization_requested(subscriber, node);
+    }
+}
+
+/**
+ * @test the first added configuration, that applies to a new node, is used for the node
+ */
+BOOST_AUTO_TEST_CASE( configuration_of_node_groups )
+{
+    boost::asio::io_service                 queue;
+    test::adapter                           adapter;
+    pubsub::root                            root(queue, adapter, configurator().authorization_required());
+
+    const node_group a_2(has_key(key(key_domain("a"), "2")));
+
+    root.add_configuration(a_2, configurator().authorization_not_required());
+    root.add_configuration(has_domain(key_domain("b")), configurator().authorization_required());
+    root.add_configuration(node_group(), configurator().authorization_not_required());
+
+    BOOST_CHECK(!subscription_authorized(root, adapter, queue, "{'a':'2'}"));
+    BOOST_CHECK(subscription_authorized(root, adapter, queue, "{'b':'3'}"));
+    BOOST_CHECK(!subscription_authorized(root, adapter, queue, "{'c':'1'}"));
+    BOOST_CHECK(!subscription_authorized(root, adapter, queue, "{'a':'2','b':'3'}"));
+    BOOST_CHECK(!subscription_authorized(root, adapter, queue, "{'a':'3','c':'3'}"));
+    BOOST_CHECK(subscription_authorized(root, adapter, queue, "{'a':'3','b':'3'}"));
+
+    root.remove_configuration(a_2);
+
+    BOOST_CHECK(subscription_authorized(root, adapter, queue, "{'a':'2','b':'4'}"));
+    BOOST_CHECK(!subscription_authorized(root, adapter, queue, "{'a':'2','c':'4'}"));
+    BOOST_CHECK_THROW(root.remove_configuration(a_2), std::runtime_error);
+}
+
 /**
  * @test unsubscribe while validating a node
  */
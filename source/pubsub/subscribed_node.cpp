@@ -7,6 +7,10 @@
 #include "pubsub/pubsub.h"
 #include "tools/scope_guard.h"
 #include <boost/bind.hpp>
+#include <boost/asio/io_service.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <algorithm>
+#include <vector>
 
 namespace pubsub {
 
@@ -19,18 +23,30 @@ namespace pubsub {
 					boost::shared_ptr<subscribed_node>&		node,
 					const node_name& 						node_name,
 					boost::asio::io_service&				queue,
-					adapter& 								adapter)
+					adapter& 								adapter,
+					const boost::weak_ptr<node_owner>&		owner)
 				: node_(node)
 				, name_(node_name)
 				, queue_(queue)
 				, adapter_(adapter)
+				, owner_(owner)
 			{
 			}
 
+			// tells the owner of the node, that the subscriptions of the given users failed
+			void subscriptions_failed(const node_owner::subscriber_list& users) const
+			{
+				const boost::shared_ptr<node_owner> owner = owner_.lock();
+
+				if ( owner.get() && !users.empty() )
+					owner->subscriptions_failed(name_, *node_, users);
+			}
+
 			boost::shared_ptr<subscribed_node>	node_;
 			const node_name						name_;
 			boost::asio::io_service&			queue_;
 			adapter&							adapter_;
+			boost::weak_ptr<node_owner>			owner_;
 		};
 
 		class node_validator : public validation_call_back, public validation_step_data
@@ -40,8 +56,9 @@ namespace pubsub {
 						   const node_name& 					node_name,
 						   const boost::shared_ptr<subscriber>& user,
 						   boost::asio::io_service&				queue,
-						   adapter& 							adapter)
-				: validation_step_data(node, node_name, queue, adapter)
+						   adapter& 							adapter,
+						   const boost::weak_ptr<node_owner>&	owner)
+				: validation_step_data(node, node_name, queue, adapter, owner)
 				, user_(user)
 				, commited_(false)
 			{
@@ -63,7 +80,7 @@ namespace pubsub {
 			void not_valid()
 			{
 				commited_ = true;
-				node_->not_validated(name_);
+				subscriptions_failed(node_->not_validated(name_));
 
 				queue_.post(
 					boost::bind(
@@ -92,8 +109,9 @@ namespace pubsub {
 					const boost::shared_ptr<subscriber>& 	user,
 					const node_name& 						node_name,
 					boost::asio::io_service&				queue,
-					adapter& 								adapter	)
-    			: validation_step_data(node, node_name, queue, adapter)
+					adapter& 								adapter,
+					const boost::weak_ptr<node_owner>&		owner )
+    			: validation_step_data(node, node_name, queue, adapter, owner)
     			, user_(user)
     			, commited_(false)
     		{
@@ -116,7 +134,8 @@ namespace pubsub {
 	        void not_authorized()
 	        {
 	        	commited_ = true;
-	        	node_->unauthorized_subscriber(user_);
+	        	if ( node_->unauthorized_subscriber(user_) )
+	        		subscriptions_failed(node_owner::subscriber_list(1, user_));
 
 	        	user_->on_unauthorized_node_subscription(name_);
                 queue_.post(
@@ -143,7 +162,7 @@ namespace pubsub {
     		{
     			if ( !commited_ )
     			{
-    				node_->initial_data_failed(name_);
+    				subscriptions_failed(node_->initial_data_failed(name_));
                     queue_.post(
                         boost::bind(
                             &adapter::initialization_failed,
@@ -160,6 +179,29 @@ namespace pubsub {
 
 			bool commited_;
     	};
+
+		// a snapshot of a node and its subscribers, that have to be notified about the change of the node
+		struct fan_out
+		{
+			typedef std::vector< boost::shared_ptr< subscriber > > receiver_list;
+
+			fan_out(const node_name& name, const node& data, const receiver_list& receivers,
+				boost::asio::io_service& queue, std::size_t batches)
+				: name_(name)
+				, data_(data)
+				, receivers_(receivers)
+				, queue_(queue)
+				, outstanding_batches_(batches)
+			{
+			}
+
+			const node_name				name_;
+			const node					data_;
+			const receiver_list			receivers_;
+			boost::asio::io_service&	queue_;
+			// guarded by the mutex of the subscribed_node
+			std::size_t					outstanding_batches_;
+		};
 	} // namespace details
 
 	/////////////////////////
@@ -170,34 +212,66 @@ namespace pubsub {
 		, subscribers_()
 		, unauthorized_()
 		, state_( unvalidated )
+		, fan_out_pending_( false )
+		, fan_out_outdated_( false )
+		, last_publication_()
+		, publication_timer_()
+		, update_deferred_( false )
+		, unused_since_()
+		, evicted_( false )
 		, config_( config )
 	{
 	}
 
-	void subscribed_node::change_data(const node_name& name, const json::value& new_data)
+	void subscribed_node::change_data(const node_name& name, const json::value& new_data, boost::asio::io_service& queue)
 	{
 		boost::mutex::scoped_lock lock(mutex_);
 
-		if ( !data_.update (new_data, config_->max_update_size() ) )
+		if ( !data_.update (new_data, config_->max_update_size() ) || state_ != valid_and_initialized )
 			return;
 
-		if ( state_ == valid_and_initialized )
+		const boost::posix_time::time_duration period = config_->min_update_period();
+
+		if ( period <= boost::posix_time::time_duration() )
 		{
-			// notify all subscribed nodes
-			for ( subscriber_list::const_iterator user = subscribers_.begin(); user != subscribers_.end(); ++user )
-			{
-				(*user)->on_update(name, data_);
-			}
+			notify_subscribers(name, queue);
+			return;
 		}
+
+		// the update will be published together with the already deferred update
+		if ( update_deferred_ )
+			return;
+
+		const boost::posix_time::ptime now = boost::posix_time::microsec_clock::universal_time();
+
+		if ( last_publication_.is_not_a_date_time() || now >= last_publication_ + period )
+		{
+			last_publication_ = now;
+			notify_subscribers(name, queue);
+			return;
+		}
+
+		if ( !publication_timer_ )
+			publication_timer_.reset( new boost::asio::deadline_timer( queue ) );
+
+		update_deferred_ = true;
+		publication_timer_->expires_at( last_publication_ + period );
+		publication_timer_->async_wait(
+			boost::bind( &subscribed_node::publish_deferred_update, shared_from_this(), name, boost::ref( queue ) ) );
 	}
 
-	void subscribed_node::add_subscriber( const boost::shared_ptr< subscriber >& user, adapter&, boost::asio::io_service& queue,
-	    const node_name& name )
+	subscribed_node::add_result subscribed_node::add_subscriber( const boost::shared_ptr< subscriber >& user, adapter&,
+	    boost::asio::io_service& queue, const node_name& name )
 	{
 		boost::mutex::scoped_lock lock( mutex_ );
 
+		if ( evicted_ )
+			return node_evicted;
+
 		if ( not_in_error_state() )
 		{
+			unused_since_ = boost::posix_time::ptime();
+
 			if ( config_->authorization_required() )
 			{
 				unauthorized_.insert( user );
@@ -209,6 +283,8 @@ namespace pubsub {
 				if ( state_ == valid_and_initialized )
 				    user->on_update( name, data_ );
 			}
+
+			return subscriber_added;
 		}
 		else if ( state_ == invalid )
 		{
@@ -224,13 +300,54 @@ namespace pubsub {
 		{
 			assert( !"this state should be invalid" );
 		}
+
+		return node_in_error_state;
 	}
 
 	bool subscribed_node::remove_subscriber(const boost::shared_ptr<subscriber>& user)
 	{
 		boost::mutex::scoped_lock lock(mutex_);
 
-		return subscribers_.erase(user) + unauthorized_.erase(user) != 0;
+		const bool result = subscribers_.erase(user) + unauthorized_.erase(user) != 0;
+
+		if ( result && subscribers_.empty() && unauthorized_.empty() )
+			unused_since_ = boost::posix_time::microsec_clock::universal_time();
+
+		return result;
+	}
+
+	bool subscribed_node::unused() const
+	{
+		boost::mutex::scoped_lock lock(mutex_);
+
+		return subscribers_.empty() && unauthorized_.empty();
+	}
+
+	boost::posix_time::time_duration subscribed_node::node_timeout() const
+	{
+		return config_->node_timeout();
+	}
+
+	bool subscribed_node::evict(const boost::posix_time::ptime& now)
+	{
+		boost::mutex::scoped_lock lock(mutex_);
+
+		if ( evicted_ || !subscribers_.empty() || !unauthorized_.empty() || unused_since_.is_not_a_date_time()
+		  || fan_out_pending_ || update_deferred_ || now - unused_since_ < config_->node_timeout() )
+		{
+			return false;
+		}
+
+		evicted_ = true;
+
+		return true;
+	}
+
+	std::size_t subscribed_node::data_size() const
+	{
+		boost::mutex::scoped_lock lock(mutex_);
+
+		return data_.size();
 	}
 
 	void subscribed_node::validated( const details::node_validator& last_step )
@@ -267,11 +384,14 @@ namespace pubsub {
 		}
 	}
 
-	void subscribed_node::not_validated(const node_name& node_name)
+	node_owner::subscriber_list subscribed_node::not_validated(const node_name& node_name)
 	{
 		boost::mutex::scoped_lock lock(mutex_);
 		assert(state_ == unvalidated);
 
+		node_owner::subscriber_list result( subscribers_.begin(), subscribers_.end() );
+		result.insert( result.end(), unauthorized_.begin(), unauthorized_.end() );
+
 		for ( subscriber_list::const_iterator user = subscribers_.begin(); user != subscribers_.end(); ++user )
 			(*user)->on_invalid_node_subscription(node_name);
 
@@ -283,6 +403,9 @@ namespace pubsub {
 		unauthorized_.clear();
 
 		state_ = invalid;
+		unused_since_ = boost::posix_time::microsec_clock::universal_time();
+
+		return result;
 	}
 
     bool subscribed_node::authorization_required() const
@@ -315,14 +438,21 @@ namespace pubsub {
 		}
 	}
 
-	void subscribed_node::unauthorized_subscriber(const boost::shared_ptr<subscriber>& user)
+	bool subscribed_node::unauthorized_subscriber(const boost::shared_ptr<subscriber>& user)
 	{
 		boost::mutex::scoped_lock lock(mutex_);
 
 		const subscriber_list::iterator pos = std::find(unauthorized_.begin(), unauthorized_.end(), user);
 
-		if ( pos != unauthorized_.end() )
-			unauthorized_.erase(user);
+		if ( pos == unauthorized_.end() )
+			return false;
+
+		unauthorized_.erase(pos);
+
+		if ( subscribers_.empty() && unauthorized_.empty() )
+			unused_since_ = boost::posix_time::microsec_clock::universal_time();
+
+		return true;
 	}
 
 	void subscribed_node::initial_data(const node_name& name, const json::value& new_data)
@@ -332,6 +462,7 @@ namespace pubsub {
 		state_ = valid_and_initialized;
 
 		data_.update(new_data, config_->max_update_size());
+		last_publication_ = boost::posix_time::microsec_clock::universal_time();
 
 		for ( subscriber_list::iterator subscriber = subscribers_.begin(); subscriber != subscribers_.end(); ++subscriber )
 		{
@@ -339,11 +470,15 @@ namespace pubsub {
 		}
 	}
 
-	void subscribed_node::initial_data_failed(const node_name& name)
+	node_owner::subscriber_list subscribed_node::initial_data_failed(const node_name& name)
 	{
 		boost::mutex::scoped_lock lock(mutex_);
 		assert(state_ = initializing);
 		state_ = initialization_failed;
+		unused_since_ = boost::posix_time::microsec_clock::universal_time();
+
+		node_owner::subscriber_list result( subscribers_.begin(), subscribers_.end() );
+		result.insert( result.end(), unauthorized_.begin(), unauthorized_.end() );
 
 		tools::scope_guard clear_subscribers  = tools::make_obj_guard(subscribers_, &subscriber_list::clear);
 		static_cast<void>(clear_subscribers);
@@ -359,6 +494,8 @@ namespace pubsub {
 		{
 			(*subscriber)->on_failed_node_subscription(name);
 		}
+
+		return result;
 	}
 
 	void subscribed_node::post_initialization_request(const details::validation_step_data& last_step)
@@ -375,6 +512,105 @@ namespace pubsub {
 
 	}
 
+	void subscribed_node::notify_subscribers(const node_name& name, boost::asio::io_service& queue)
+	{
+		if ( config_->fan_out_batch_size() != 0 )
+		{
+			if ( fan_out_pending_ )
+			{
+				fan_out_outdated_ = true;
+			}
+			else
+			{
+				start_fan_out(name, queue);
+			}
+		}
+		else
+		{
+			// notify all subscribed nodes
+			for ( subscriber_list::const_iterator user = subscribers_.begin(); user != subscribers_.end(); ++user )
+			{
+				(*user)->on_update(name, data_);
+			}
+		}
+	}
+
+	void subscribed_node::publish_deferred_update(const node_name& name, boost::asio::io_service& queue)
+	{
+		boost::mutex::scoped_lock lock(mutex_);
+
+		update_deferred_  = false;
+		last_publication_ = boost::posix_time::microsec_clock::universal_time();
+
+		notify_subscribers(name, queue);
+	}
+
+	void subscribed_node::start_fan_out(const node_name& name, boost::asio::io_service& queue)
+	{
+		if ( subscribers_.empty() )
+			return;
+
+		const std::size_t batch_size = config_->fan_out_batch_size();
+		const std::size_t batches    = ( subscribers_.size() + batch_size - 1 ) / batch_size;
+
+		const boost::shared_ptr< details::fan_out > job( new details::fan_out(
+			name, data_, details::fan_out::receiver_list( subscribers_.begin(), subscribers_.end() ), queue, batches ) );
+
+		fan_out_pending_ = true;
+
+		for ( std::size_t first = 0; first < job->receivers_.size(); first += batch_size )
+		{
+			queue.post(
+				boost::bind(
+					&subscribed_node::deliver_fan_out,
+					shared_from_this(),
+					job,
+					first,
+					std::min( first + batch_size, job->receivers_.size() ) ) );
+		}
+	}
+
+	void subscribed_node::deliver_fan_out(const boost::shared_ptr<details::fan_out>& job, std::size_t first, std::size_t last)
+	{
+		tools::scope_guard batch_done = tools::make_obj_guard( *this, &subscribed_node::fan_out_batch_done, job );
+		static_cast< void >( batch_done );
+
+		details::fan_out::receiver_list receivers;
+		receivers.reserve( last - first );
+
+		{
+			boost::mutex::scoped_lock lock(mutex_);
+
+			// subscribers that unsubscribed in the meantime, will not be notified
+			for ( ; first != last; ++first )
+			{
+				if ( subscribers_.find( job->receivers_[ first ] ) != subscribers_.end() )
+					receivers.push_back( job->receivers_[ first ] );
+			}
+		}
+
+		for ( details::fan_out::receiver_list::const_iterator user = receivers.begin(); user != receivers.end(); ++user )
+		{
+			(*user)->on_update(job->name_, job->data_);
+		}
+	}
+
+	void subscribed_node::fan_out_batch_done(const boost::shared_ptr<details::fan_out>& job)
+	{
+		boost::mutex::scoped_lock lock(mutex_);
+
+		if ( --job->outstanding_batches_ != 0 )
+			return;
+
+		fan_out_pending_ = false;
+
+		if ( fan_out_outdated_ )
+		{
+			fan_out_outdated_ = false;
+			start_fan_out(job->name_, job->queue_);
+		}
+	}
+
 	bool subscribed_node::not_in_error_state() const
 	{
 		return state_ != invalid && state_ != initialization_failed;
@@ -385,9 +621,10 @@ namespace pubsub {
 			const node_name& 						node_name,
 			const boost::shared_ptr<subscriber>&	user,
 			boost::asio::io_service&				queue,
-			adapter& 								adapter)
+			adapter& 								adapter,
+			const boost::weak_ptr<node_owner>&		owner)
 	{
-		return boost::shared_ptr<validation_call_back>(new details::node_validator(node, node_name, user, queue, adapter));
+		return boost::shared_ptr<validation_call_back>(new details::node_validator(node, node_name, user, queue, adapter, owner));
 	}
 
 	boost::shared_ptr<authorization_call_back> create_authorizer(
@@ -395,9 +632,10 @@ namespace pubsub {
 			const node_name& 						node_name,
 			const boost::shared_ptr<subscriber>&	user,
 			boost::asio::io_service&				queue,
-			adapter& 								adapter)
+			adapter& 								adapter,
+			const boost::weak_ptr<node_owner>&		owner)
 	{
-		return boost::shared_ptr<authorization_call_back>(new details::user_authorizer(node, user, node_name, queue, adapter));
+		return boost::shared_ptr<authorization_call_back>(new details::user_authorizer(node, user, node_name, queue, adapter, owner));
 	}
 }
 
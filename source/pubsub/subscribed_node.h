@@ -7,8 +7,14 @@
 
 #include "pubsub/node.h"
 #include <boost/shared_ptr.hpp>
+#include <boost/weak_ptr.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/enable_shared_from_this.hpp>
+#include <boost/asio/deadline_timer.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
 #include <boost/thread/mutex.hpp>
 #include <set>
+#include <vector>
 
 namespace boost {
 	namespace asio {
@@ -28,13 +34,39 @@ namespace pubsub
 		class node_validator;
 		class user_authorizer;
 		struct validation_step_data;
+		struct fan_out;
 	}
 
+	class subscribed_node;
+
+	/**
+	 * @brief interface of the tree, that owns subscribed_nodes
+	 *
+	 * The steps of validation, authorization and initialization report back to the owner, when subscribers where
+	 * removed from a node, because their subscriptions failed. The owner is referenced weakly by the steps, so the
+	 * owner might be destroyed, while there are outstanding steps.
+	 */
+	class node_owner
+	{
+	public:
+		typedef std::vector< boost::shared_ptr< subscriber > > subscriber_list;
+
+		/**
+		 * @brief the subscriptions of the given users to the named node failed due to a failed validation,
+		 *        authorization or initialization
+		 */
+		virtual void subscriptions_failed(const node_name& name, const subscribed_node& node,
+			const subscriber_list& users) = 0;
+
+	protected:
+		virtual ~node_owner() {}
+	};
+
 	/**
 	 * @brief class responsible for keeping track of a nodes data and subscriptions and a state concerning
 	 *        the validity of the node and there subscriptions.
 	 */
-	class subscribed_node
+	class subscribed_node : public boost::enable_shared_from_this< subscribed_node >
 	{
 	public:
 		/**
@@ -48,13 +80,31 @@ namespace pubsub
 		 * @brief changes the data of the node.
 		 *
 		 * Depending on the current state of the node, subscribers will be informed about the changed data.
+		 * If the configuration of the node requests asynchronous notification, the notifications are posted
+		 * to the given queue. If the configured minimum update period did not elapse since the last
+		 * notification, the notification is deferred by a timer, that is bound to the given queue.
+		 *
+		 * @sa configuration::fan_out_batch_size()
+		 * @sa configuration::min_update_period()
 		 */
-		void change_data(const node_name& name, const json::value& new_data);
+		void change_data(const node_name& name, const json::value& new_data, boost::asio::io_service& queue);
+
+		/**
+		 * @brief result of add_subscriber()
+		 */
+		enum add_result {
+			// the subscriber was added to the list of subscribers or to the list of unauthorized subscribers
+			subscriber_added,
+			// the node is invalid or failed to initialize; the subscriber was not added and will be notified
+			node_in_error_state,
+			// the node was evicted; the subscriber was not added
+			node_evicted
+		};
 
 		/**
 		 * @brief adds a new subscriber to the list of subscribers or to the list of unauthorized subscribers.
 		 */
-		void add_subscriber(const boost::shared_ptr< subscriber >&, adapter&, boost::asio::io_service&,
+		add_result add_subscriber(const boost::shared_ptr< subscriber >&, adapter&, boost::asio::io_service&,
 		    const node_name& name );
 
 		/**
@@ -63,6 +113,33 @@ namespace pubsub
 		 */
 		bool remove_subscriber(const boost::shared_ptr<subscriber>&);
 
+		/**
+		 * @brief returns true, if the node has neither authorized nor unauthorized subscribers
+		 *
+		 * A node without subscribers is evicted from the tree, after it stayed unused for the configured node timeout.
+		 * @sa configuration::node_timeout()
+		 */
+		bool unused() const;
+
+		/**
+		 * @brief the time, a node without subscribers stays in the tree
+		 */
+		boost::posix_time::time_duration node_timeout() const;
+
+		/**
+		 * @brief marks the node as evicted, if the node was unused for at least the configured node timeout.
+		 *
+		 * A node, that is about to notify subscribers or that has a deferred update, is not evicted.
+		 * Once evicted, the node doesn't accept new subscribers anymore.
+		 * @return true, if the node was evicted
+		 */
+		bool evict(const boost::posix_time::ptime& now);
+
+		/**
+		 * @brief approximated size of the nodes data in bytes
+		 */
+		std::size_t data_size() const;
+
 		/**
 		 *  @brief marks this node as a valid node
 		 */
@@ -70,8 +147,9 @@ namespace pubsub
 
 		/**
 		 *  @brief mark this node as invalid node.
+		 *  @return the subscribers, that where removed from the node
 		 */
-		void not_validated(const node_name& node_name);
+		node_owner::subscriber_list not_validated(const node_name& node_name);
 
 		/**
 		 * @brief returns true, if authorization is required for subscribing to this node
@@ -85,8 +163,9 @@ namespace pubsub
 
 		/**
 		 * @brief the passed user is _not_ authorized to subscribe to this node
+		 * @return true, if the user was removed from the list of unauthorized subscribers
 		 */
-		void unauthorized_subscriber(const boost::shared_ptr<subscriber>& user);
+		bool unauthorized_subscriber(const boost::shared_ptr<subscriber>& user);
 
 		/**
 		 * @brief initial data
@@ -95,16 +174,24 @@ namespace pubsub
 
 		/**
 		 * @brief the adapter failed to deliver initial data for this node
+		 * @return the subscribers, that where removed from the node
 		 */
-		void initial_data_failed(const node_name& name);
+		node_owner::subscriber_list initial_data_failed(const node_name& name);
 	private:
 		void post_initialization_request(const details::validation_step_data&);
 
+		void notify_subscribers(const node_name& name, boost::asio::io_service& queue);
+		void publish_deferred_update(const node_name& name, boost::asio::io_service& queue);
+
+		void start_fan_out(const node_name& name, boost::asio::io_service& queue);
+		void deliver_fan_out(const boost::shared_ptr<details::fan_out>& job, std::size_t first, std::size_t last);
+		void fan_out_batch_done(const boost::shared_ptr<details::fan_out>& job);
+
 		bool not_in_error_state() const;
 
 		typedef std::set< boost::shared_ptr< subscriber > > subscriber_list;
 
-		boost::mutex							mutex_;
+		mutable boost::mutex					mutex_;
 		node                                    data_;
 		subscriber_list                         subscribers_;
 		subscriber_list                         unauthorized_;
@@ -124,6 +211,23 @@ namespace pubsub
 			initialization_failed
 		} 										state_;
 
+		// a notification of all subscribers is posted, but not completed
+		bool									fan_out_pending_;
+		// the node changed, while a fan out was pending
+		bool									fan_out_outdated_;
+
+		// the time, the subscribers where notified the last time about a change
+		boost::posix_time::ptime				last_publication_;
+		// timer to publish updates, that arrived within the min_update_period(); created on first use
+		boost::scoped_ptr< boost::asio::deadline_timer > publication_timer_;
+		// an update is waiting for the publication_timer_ to expire
+		bool									update_deferred_;
+
+		// the time, the last subscriber left the node
+		boost::posix_time::ptime				unused_since_;
+		// the node was removed from the tree
+		bool									evicted_;
+
 		const boost::shared_ptr< const configuration >  config_;
 	};
 
@@ -138,7 +242,8 @@ namespace pubsub
 			const node_name& 						node_name,
 			const boost::shared_ptr<subscriber>&	user,
 			boost::asio::io_service&				queue,
-			adapter& 								adapter);
+			adapter& 								adapter,
+			const boost::weak_ptr<node_owner>&		owner);
 
 	/**
 	 * @brief creates an initial authorizer
@@ -148,7 +253,8 @@ namespace pubsub
 			const node_name& 						node_name,
 			const boost::shared_ptr<subscriber>&	user,
 			boost::asio::io_service&				queue,
-			adapter& 								adapter);
+			adapter& 								adapter,
+			const boost::weak_ptr<node_owner>&		owner);
 
 } // namespace pubsub
 
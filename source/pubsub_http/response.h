@@ -39,7 +39,7 @@ namespace http
         pubsub::root& d )
         : session_list_( s )
         , data_( d )
-        , parser_()
+        , parser_( json::parser::default_block_size )
         , connection_( c )
         , session_( 0 )
         , response_buffer_()
@@ -215,7 +215,7 @@ namespace http
         // keep a copy of the protocol_response, as response_ contains just pointers into the json_response_
         json_response_ = protocol_response;
         json_response_.to_json( response_ );
-        connection_->async_write(
+        connection_->async_write_last(
             response_, boost::bind( &response::response_written, this->shared_from_this(), _1, _2 ), *this );
     }
 
@@ -137,23 +137,44 @@ namespace http {
                 con->update( responds, updates );
         }
 
-        json::array sum_up_updates( const json::array& list )
+        static json::array sum_up_updates( const node::update_range& list )
         {
             assert( !list.empty() );
-            json::array result( list.at( 0u ).upcast< json::array >().copy() );
+            node::update_iterator update = list.begin();
+            json::array result( update->upcast< json::array >().copy() );
 
-            for ( std::size_t i = 1; i != list.length(); ++i )
-                result += list.at( i ).upcast< json::array >();
+            for ( ++update; update != list.end(); ++update )
+                result += update->upcast< json::array >();
 
             return result;
         }
 
-        virtual void on_update( const pubsub::node_name& name, const node& data )
+        static json::value build_update( const pubsub::node_name& name, const node& data, const node::update_range& upgrade )
         {
             json::object update;
 
-            std::pair< bool, json::value > upgrade = std::make_pair( false, json::null() );
-            node_version old_version;
+            if ( !upgrade.empty() )
+            {
+                update.add( internal::from_token, ( data.current_version() - upgrade.size() ).to_json() );
+                update.add( internal::update_token, sum_up_updates( upgrade ) );
+            }
+            else
+            {
+                update.add( internal::data_token, data.data() );
+            }
+
+            update.add( internal::key_token, name.to_json() );
+            update.add( internal::version_token, data.current_version().to_json() );
+
+            return update;
+        }
+
+        virtual void on_update( const pubsub::node_name& name, const node& data )
+        {
+            // all sessions, that know the same version of the node, share the same update message
+            static const char update_payload_tag = 0;
+
+            node::update_range upgrade;
 
             {
                 boost::mutex::scoped_lock lock( version_mutex_ );
@@ -162,27 +183,16 @@ namespace http {
 
                 if ( version_pos != node_versions_.end() )
                 {
-                    upgrade = data.get_update_from( version_pos->second );
-                    old_version = version_pos->second;
+                    upgrade = data.updates_from( version_pos->second );
                 }
 
                 node_versions_[ name ] = data.current_version();
             }
 
-            if ( upgrade.first )
-            {
-                update.add( internal::from_token, old_version.to_json() );
-                update.add( internal::update_token, sum_up_updates( upgrade.second.upcast< json::array >() ) );
-            }
-            else
-            {
-                update.add( internal::data_token, data.data() );
-            }
-
-            update.add( internal::key_token, name.to_json() );
-            update.add( internal::version_token, data.current_version().to_json() );
+            const json::value update = data.payload( &update_payload_tag, upgrade,
+                boost::bind( &session_impl::build_update, boost::cref( name ), boost::cref( data ), boost::cref( upgrade ) ) );
 
-            on_event( update, json::object() );
+            on_event( update.upcast< json::object >(), json::object() );
         }
 
         void add_error( const node_name& node, const json::string& error )
@@ -0,0 +1,137 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+#ifndef SIOUX_SOURCE_SERVER_CHUNKED_WRITER_H
+#define SIOUX_SOURCE_SERVER_CHUNKED_WRITER_H
+
+#include "http/chunk_encoder.h"
+#include "http/request.h"
+#include <boost/array.hpp>
+#include <boost/asio/buffer.hpp>
+#include <boost/utility.hpp>
+#include <cassert>
+
+namespace server
+{
+    class async_response;
+
+    /**
+     * @brief returns true, if a response to the given request can be send with a chunked transfer encoding
+     *
+     * HTTP/1.0 clients do not understand chunked bodies.
+     */
+    inline bool chunked_response_possible( const http::request_header& request )
+    {
+        return request.milli_version() >= 1001;
+    }
+
+    /**
+     * @brief streaming interface for async_response implementations, that produce their body incrementally
+     *
+     * Instead of materializing the whole body to calculate a Content-Length, an async_response can write every piece
+     * of the body, as soon as it is produced. Only the piece currently written has to be kept in memory. The response
+     * header is written together with the first chunk.
+     *
+     * Usage: the async_response implementation owns a chunked_writer and calls async_write_chunk() for every piece
+     * of the body and async_write_last_chunk() for the last piece (which can be empty). The next write can be started
+     * from the handler of the previous write. After the handler of async_write_last_chunk() was called, the response
+     * has to call response_completed() or response_not_possible() on the connection, as with any other write.
+     *
+     * The bytes_transferred passed to the handlers include the chunk framing and the header.
+     *
+     * @pre the request was sent by a HTTP/1.1 client ( chunked_response_possible() returned true )
+     * @pre there is only one write in flight
+     */
+    template < class Connection >
+    class chunked_writer : boost::noncopyable
+    {
+    public:
+        /**
+         * @brief constructs a writer, that writes to the given connection on behalf of sender
+         *
+         * header has to be a complete response header, including the "Transfer-Encoding: chunked" header and
+         * the empty line and has to stay valid until the first write completed.
+         */
+        chunked_writer( Connection& connection, async_response& sender, const boost::asio::const_buffer& header );
+
+        /**
+         * @brief writes data as one chunk of the body
+         *
+         * data has to stay valid until the handler is called. If data is empty and the header was not written
+         * yet, just the header will be written.
+         */
+        template < class WriteHandler >
+        void async_write_chunk( const boost::asio::const_buffer& data, WriteHandler handler );
+
+        /**
+         * @brief writes data as the last chunk of the body, followed by the end of the body
+         */
+        template < class WriteHandler >
+        void async_write_last_chunk( const boost::asio::const_buffer& data, WriteHandler handler );
+
+        /**
+         * @brief returns true, after async_write_last_chunk() was called
+         */
+        bool last_chunk_written() const;
+
+    private:
+        typedef boost::array< boost::asio::const_buffer, 4 > buffers_type;
+
+        buffers_type with_header( const http::chunk_encoder::buffers_type& chunk );
+
+        Connection&                 connection_;
+        async_response&             sender_;
+        boost::asio::const_buffer   header_;
+        http::chunk_encoder         encoder_;
+        bool                        last_written_;
+    };
+
+    // implementation
+    template < class Connection >
+    chunked_writer< Connection >::chunked_writer( Connection& connection, async_response& sender, const boost::asio::const_buffer& header )
+        : connection_( connection )
+        , sender_( sender )
+        , header_( header )
+        , encoder_()
+        , last_written_( false )
+    {
+    }
+
+    template < class Connection >
+    template < class WriteHandler >
+    void chunked_writer< Connection >::async_write_chunk( const boost::asio::const_buffer& data, WriteHandler handler )
+    {
+        assert( !last_written_ );
+        connection_.async_write( with_header( encoder_.chunk( data ) ), handler, sender_ );
+    }
+
+    template < class Connection >
+    template < class WriteHandler >
+    void chunked_writer< Connection >::async_write_last_chunk( const boost::asio::const_buffer& data, WriteHandler handler )
+    {
+        assert( !last_written_ );
+        last_written_ = true;
+
+        connection_.async_write_last( with_header( encoder_.last_chunk( data ) ), handler, sender_ );
+    }
+
+    template < class Connection >
+    bool chunked_writer< Connection >::last_chunk_written() const
+    {
+        return last_written_;
+    }
+
+    template < class Connection >
+    typename chunked_writer< Connection >::buffers_type chunked_writer< Connection >::with_header(
+        const http::chunk_encoder::buffers_type& chunk )
+    {
+        const buffers_type result = {{ header_, chunk[ 0 ], chunk[ 1 ], chunk[ 2 ] }};
+        header_ = boost::asio::const_buffer();
+
+        return result;
+    }
+
+} // namespace server
+
+#endif // include guard
@@ -0,0 +1,176 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+#include <boost/test/unit_test.hpp>
+#include "server/chunked_writer.h"
+#include "server/connection.h"
+#include "server/error.h"
+#include "server/traits.h"
+#include "asio_mocks/test_socket.h"
+#include "asio_mocks/test_timer.h"
+#include "http/decode_stream.h"
+#include "http/request.h"
+#include "http/response.h"
+#include <boost/asio/io_service.hpp>
+#include <boost/bind.hpp>
+#include <boost/enable_shared_from_this.hpp>
+#include <string>
+#include <vector>
+
+namespace {
+    const std::size_t   piece_size      = 100;
+    const unsigned      number_of_pieces = 25;
+
+    char piece_character( unsigned piece )
+    {
+        return static_cast< char >( 'a' + piece % 26 );
+    }
+
+    /*
+     * produces a body of number_of_pieces pieces; every piece is produced, when the previous one was written
+     */
+    template < class Connection >
+    class streaming_response : public server::async_response,
+                               public boost::enable_shared_from_this< streaming_response< Connection > >
+    {
+    public:
+        explicit streaming_response( const boost::shared_ptr< Connection >& connection )
+            : connection_( connection )
+            , writer_( *connection, *this, boost::asio::buffer( header, sizeof header - 1 ) )
+            , piece_( 0 )
+        {
+        }
+
+        void start()
+        {
+            write_next_piece();
+        }
+
+        const char* name() const
+        {
+            return "streaming_response";
+        }
+
+    private:
+        void write_next_piece()
+        {
+            buffer_.assign( piece_size, piece_character( piece_ ) );
+
+            if ( ++piece_ == number_of_pieces )
+            {
+                writer_.async_write_last_chunk( boost::asio::buffer( buffer_ ),
+                    boost::bind( &streaming_response::last_written, this->shared_from_this(), _1 ) );
+            }
+            else
+            {
+                writer_.async_write_chunk( boost::asio::buffer( buffer_ ),
+                    boost::bind( &streaming_response::piece_written, this->shared_from_this(), _1 ) );
+            }
+        }
+
+        void piece_written( const boost::system::error_code& error )
+        {
+            if ( error )
+                return connection_->response_not_possible( *this );
+
+            write_next_piece();
+        }
+
+        void last_written( const boost::system::error_code& error )
+        {
+            if ( error )
+                return connection_->response_not_possible( *this );
+
+            connection_->response_completed( *this );
+        }
+
+        static const char header[];
+
+        const boost::shared_ptr< Connection >   connection_;
+        server::chunked_writer< Connection >    writer_;
+        unsigned                                piece_;
+        std::string                             buffer_;
+    };
+
+    template < class Connection >
+    const char streaming_response< Connection >::header[] =
+        "HTTP/1.1 200 OK\r\n"
+        "Transfer-Encoding: chunked\r\n"
+        "\r\n";
+
+    struct response_factory
+    {
+        template < class Connection >
+        boost::shared_ptr< server::async_response > create_response(
+            const boost::shared_ptr< Connection >&                    connection,
+            const boost::shared_ptr< const http::request_header >&    )
+        {
+            return boost::shared_ptr< server::async_response >( new streaming_response< Connection >( connection ) );
+        }
+
+        template < class Connection >
+        boost::shared_ptr< server::async_response > error_response(
+            const boost::shared_ptr< Connection >& connection, http::http_error_code ec ) const
+        {
+            return boost::shared_ptr< server::async_response >( new server::error_response< Connection >( connection, ec ) );
+        }
+    };
+
+    typedef asio_mocks::socket< const char* > socket_t;
+    typedef server::connection_traits< socket_t, asio_mocks::timer, response_factory, server::null_event_logger > trait_t;
+
+    std::vector< char > expected_body()
+    {
+        std::vector< char > result;
+
+        for ( unsigned piece = 0; piece != number_of_pieces; ++piece )
+            result.insert( result.end(), piece_size, piece_character( piece ) );
+
+        return result;
+    }
+}
+
+/**
+ * @test a body written piece by piece through a chunked_writer is received as a valid chunked body, also when
+ *       the responses to pipelined requests are written back to back.
+ */
+BOOST_AUTO_TEST_CASE( stream_chunked_responses )
+{
+    static const char requests[] =
+        "GET /a HTTP/1.1\r\nHost: example.com\r\n\r\n"
+        "GET /b HTTP/1.1\r\nHost: example.com\r\n\r\n";
+
+    boost::asio::io_service queue;
+    socket_t                socket( queue, requests, requests + sizeof requests - 1 );
+    trait_t                 trait;
+
+    server::create_connection( socket, trait );
+    queue.run();
+
+    while ( asio_mocks::advance_time() )
+    {
+        queue.reset();
+        queue.run();
+    }
+
+    const std::vector< std::pair< boost::shared_ptr< http::response_header >, std::vector< char > > > responses =
+        http::decode_stream< http::response_header >( socket.bin_output() );
+
+    BOOST_REQUIRE_EQUAL( responses.size(), 2u );
+
+    for ( std::size_t i = 0; i != responses.size(); ++i )
+    {
+        BOOST_CHECK_EQUAL( responses[ i ].first->code(), http::http_ok );
+        BOOST_CHECK( responses[ i ].second == expected_body() );
+    }
+}
+
+/**
+ * @test chunked responses are only possible to HTTP/1.1 clients
+ */
+BOOST_AUTO_TEST_CASE( chunked_response_possible_for_http11_only )
+{
+    BOOST_CHECK( server::chunked_response_possible( http::request_header( "GET / HTTP/1.1\r\nHost: a\r\n\r\n" ) ) );
+    BOOST_CHECK( !server::chunked_response_possible( http::request_header( "GET / HTTP/1.0\r\nHost: a\r\n\r\n" ) ) );
+}
@@ -11,7 +11,6 @@
 #include "server/error_code.h"
 #include "server/response.h"
 #include "server/timeout.h"
-#include "tools/mem_tools.h"
 #include <boost/asio/buffer.hpp>
 #include <boost/asio/ip/tcp.hpp>
 #include <boost/asio/placeholders.hpp>
@@ -23,14 +22,42 @@
 #include <algorithm>
 #include <cassert>
 #include <deque>
-#include <map>
 #include <memory>
+#include <vector>
 
 /** @namespace server */
 namespace server 
 {
     class async_response;
 
+    namespace details {
+        /*
+         * adapts a handler, that takes the body in single parts, to the scatter list interface of
+         * connection::async_read_body_buffers()
+         */
+        template < class ReadHandler >
+        class body_parts_handler
+        {
+        public:
+            explicit body_parts_handler( const ReadHandler& handler ) : handler_( handler ) {}
+
+            void operator()( const boost::system::error_code& error, const http::body_buffers& buffers )
+            {
+                if ( error || buffers.empty() )
+                {
+                    handler_( error, static_cast< const char* >( 0 ), 0 );
+                    return;
+                }
+
+                for ( http::body_buffers::const_iterator b = buffers.begin(); b != buffers.end(); ++b )
+                    handler_( error, boost::asio::buffer_cast< const char* >( *b ), boost::asio::buffer_size( *b ) );
+            }
+
+        private:
+            ReadHandler handler_;
+        };
+    }
+
 	/**
 	 * @brief representation of a http connection over a physical connection from a client to this server
 	 *
@@ -69,6 +96,10 @@ namespace server
 
         /**
          * @brief starts the first asynchron read on the connection passed to the c'tor
+         *
+         * The connection is reported to the trait as created, when it is started, not when it is constructed, as
+         * an acceptator constructs connections in advance. A connection, that was never started, is not reported
+         * as destroyed.
          */
         void start();
 
@@ -102,6 +133,21 @@ namespace server
             WriteHandler                handler,
             async_response&             sender);
 
+        /**
+         * @brief same as async_write(), but the sender promises, that this is the last write of the response.
+         *
+         * When responses to pipelined requests are blocked behind the currently sending response, the last writes of
+         * consecutive responses are combined into a single, vectored write. The handlers are called in the order of
+         * the responses, after the combined write completed.
+         */
+        template<
+            typename ConstBufferSequence,
+            typename WriteHandler>
+        void async_write_last(
+            const ConstBufferSequence&  buffers,
+            WriteHandler                handler,
+            async_response&             sender);
+
         /**
          * @brief Starts reading asynchronously the body of a request.
          *
@@ -121,6 +167,24 @@ namespace server
         template< typename ReadHandler >
         void async_read_body( ReadHandler handler );
 
+        /**
+         * @brief same as async_read_body(), but all parts of the body, that where decoded from a single read, are
+         *        passed to the handler at once.
+         *
+         * Clients that send a body in many small chunks, will cause one handler invocation per read, instead of one
+         * per chunk. The handler must have following signature:
+         * void handler(
+         *      const boost::system::error_code& error, // Result of operation.
+         *      const http::body_buffers& buffers       // decoded parts of the body, valid until the handler returns
+         *      );
+         *
+         * If the handler is called with an empty list of buffers, the complete body is read.
+         *
+         * @pre last received header signaled, that a body is expected
+         */
+        template< typename ReadHandler >
+        void async_read_body_buffers( ReadHandler handler );
+
         /**
          * @brief to be called by an async_response to signal, that no more writes will be done
          *
@@ -166,14 +230,52 @@ namespace server
         connection( const connection& );
         connection& operator=( const connection& );
 
+        typedef std::vector< boost::asio::const_buffer > buffer_list;
+
+        // buffer sequence, that refers to a buffer_list, so that copying the sequence does not copy the list
+        class buffer_list_ref
+        {
+        public:
+            typedef boost::asio::const_buffer       value_type;
+            typedef buffer_list::const_iterator     const_iterator;
+
+            explicit buffer_list_ref(const buffer_list& list) : list_(&list) {}
+
+            const_iterator begin() const { return list_->begin(); }
+            const_iterator end() const { return list_->end(); }
+        private:
+            const buffer_list* list_;
+        };
+
         class blocked_write_base 
         {
         public:
+            blocked_write_base(async_response& sender, bool last);
+
             virtual ~blocked_write_base() {}
 
             virtual void operator()(Connection&) = 0;
 
             virtual void cancel() = 0;
+
+            // returns true, if the write can be combined with other writes
+            virtual bool combinable() const;
+
+            // appends the buffers to be written to the given list
+            virtual void gather(buffer_list&) const;
+
+            // the number of buffers, that gather() will add
+            virtual std::size_t buffer_count() const;
+
+            // called, when a combined write completed. bytes_transferred is the part of the combined write, that was
+            // taken from this write.
+            virtual void written(const boost::system::error_code& error, std::size_t bytes_transferred);
+
+            virtual std::size_t size() const;
+
+            blocked_write_base*     next_;
+            async_response* const   sender_;
+            const bool              last_;
         };
 
         template <class ConstBufferSequence, class WriteHandler>
@@ -181,10 +283,17 @@ namespace server
         {
         public:
             blocked_write(const ConstBufferSequence&  buffers,
-                          WriteHandler                handler);
+                          WriteHandler                handler,
+                          async_response&             sender,
+                          bool                        last);
         private:
             void operator()(Connection&);
             void cancel();
+            bool combinable() const;
+            void gather(buffer_list&) const;
+            std::size_t buffer_count() const;
+            void written(const boost::system::error_code& error, std::size_t bytes_transferred);
+            std::size_t size() const;
 
             const ConstBufferSequence   buffers_;
             const WriteHandler          handler_;
@@ -195,7 +304,8 @@ namespace server
         {
         public:
             blocked_write_some(const ConstBufferSequence&  buffers,
-                          WriteHandler                handler);
+                          WriteHandler                handler,
+                          async_response&             sender);
         private:
             void operator()(Connection&);
             void cancel();
@@ -204,9 +314,82 @@ namespace server
             const WriteHandler          handler_;
         };
 
+        /*
+         * intrusive, singly linked queue of blocked writes. The queue owns the writes; no bookkeeping memory is
+         * allocated to queue a write.
+         */
+        class write_queue
+        {
+        public:
+            write_queue();
+            ~write_queue();
+
+            bool empty() const;
+            blocked_write_base* front() const;
+            blocked_write_base* back() const;
+
+            // takes ownership of write
+            void push_back(blocked_write_base* write);
+
+            // moves all writes of other to the end of this queue
+            void splice(write_queue& other);
+
+            // removes all writes of the given sender and returns them in the order, they where queued
+            void take(const async_response& sender, write_queue& writes);
+
+            bool contains(const async_response& sender) const;
+
+            // the sum of the buffer_count() of all writes
+            std::size_t buffer_count() const;
+
+            void swap(write_queue& other);
+        private:
+            write_queue(const write_queue&);
+            write_queue& operator=(const write_queue&);
+
+            blocked_write_base* head_;
+            blocked_write_base* tail_;
+        };
+
+        // the maximum number of buffers, that are combined into one vectored write. IOV_MAX is at least 1024 on all
+        // supported platforms, but boost.asio passes at most 64 buffers to a single writev() call.
+        static const std::size_t max_gathered_buffers = 64u;
+
+        template<
+            typename ConstBufferSequence,
+            typename WriteHandler>
+        void async_write_impl(
+            const ConstBufferSequence&  buffers,
+            WriteHandler                handler,
+            async_response&             sender,
+            bool                        last);
+
+        // writes the blocked writes of the first response
+        void write_blocked(write_queue& writes);
+
+        // stops deferring writes and writes the deferred writes of the first response
+        void write_deferred();
+
+        // writes the given writes and the last writes of the following responses with a single write
+        void write_gathered(write_queue& writes);
+        void handle_gathered_write(const boost::system::error_code& error, std::size_t bytes_transferred);
+
         boost::posix_time::time_duration read_timeout_value() const;
         void issue_read(const boost::posix_time::time_duration& time_out);
+        void issue_buffered_read(const boost::posix_time::time_duration& time_out);
+
+        template < class MutableBufferSequence, class ReadHandler >
+        void async_read_some(const MutableBufferSequence& buffers, ReadHandler handler,
+            const boost::posix_time::time_duration& time_out);
+
 		void handle_read(const boost::system::error_code& e, std::size_t bytes_transferred);
+		void handle_readable(const boost::system::error_code& e, std::size_t bytes_transferred);
+
+        // true, if no data of a request or body is buffered
+        bool idle() const;
+
+        // releases buffers and unused request headers, while waiting for the next request
+        void release_idle_memory();
 		void handle_keep_alive_timeout( const boost::system::error_code& ec );
 
 		/*
@@ -223,20 +406,37 @@ namespace server
         // hurries all responses, that are in front of the given sender
         void hurry_writers(async_response& sender);
 
-        void deliver_body();
+        void deliver_body( const char*& body_data, std::size_t& bytes_transferred );
+
+        // returns a request header, that is not referenced by any response and can thus be reset()
+        boost::shared_ptr<http::request_header> unused_request_header();
 
         Connection                              connection_;
         Trait&                                  trait_;
 
         boost::shared_ptr<http::request_header> current_request_;
 
+        // request headers created by this connection, to be reused, once no response refers to them anymore.
+        // current_request_ is always part of the pool.
+        typedef std::vector< boost::shared_ptr< http::request_header > > request_pool_t;
+        request_pool_t                          request_pool_;
+        static const std::size_t                max_pooled_request_headers = 4u;
+
         typedef std::deque<async_response*>     response_list;
         response_list                           responses_;
 
-        typedef std::map<async_response*, std::vector<blocked_write_base*> >  blocked_write_list;
-        blocked_write_list                      blocked_writes_;
+        // writes of responses, that are not the first response, in the order the writes where issued
+        write_queue                             blocked_writes_;
+
+        // blocked writes, that are currently written with a single write and their buffers
+        write_queue                             gathered_writes_;
+        buffer_list                             gathered_buffers_;
 
         bool                                    current_response_is_sending_;
+
+        // while true, writes of the first response are queued, to be combined with the writes of the following
+        // responses by write_deferred()
+        bool                                    defer_writes_;
         bool                                    shutdown_read_;
         bool                                    no_read_timeout_set_;
         bool                                    close_after_response_;
@@ -244,13 +444,15 @@ namespace server
         timer_t                                 read_timer_;
         timer_t                                 write_timer_;
 
-        typedef boost::function< void ( const boost::system::error_code&, const char*, std::size_t ) >
+        typedef boost::function< void ( const boost::system::error_code&, const http::body_buffers& ) >
         	body_read_cb_t;
 
         http::body_decoder						body_decoder_;
         // if not empty(), currently, a body is read
         body_read_cb_t							body_read_call_back_;
         std::vector< char >						body_buffer_;
+        // decoded parts of the body, that are passed to the body_read_call_back_; reused to not allocate per read
+        http::body_buffers                      body_parts_;
  	};
 
     /**
@@ -268,7 +470,9 @@ namespace server
         : connection_(arg)
         , trait_(trait)
         , current_request_()
+        , request_pool_()
         , current_response_is_sending_(false)
+        , defer_writes_(false)
         , shutdown_read_(false)
         , no_read_timeout_set_( false )
         , close_after_response_( false )
@@ -277,7 +481,6 @@ namespace server
         , body_decoder_()
         , body_read_call_back_()
     {
-        trait_.event_connection_created(*this);
     }
 
     template < class Trait, class Connection, class Timer >
@@ -290,13 +493,17 @@ namespace server
         boost::system::error_code ec;
         connection_.close( ec );
 
-        trait_.event_connection_destroyed( *this );
+        // only started connections have a current request
+        if ( current_request_ )
+            trait_.event_connection_destroyed( *this );
     }
 
     template < class Trait, class Connection, class Timer >
     void connection< Trait, Connection, Timer >::start()
     {
-        current_request_.reset( new http::request_header );
+        trait_.event_connection_created( *this );
+
+        current_request_ = unused_request_header();
         issue_read( trait_.timeout() );
     }
 
@@ -313,14 +520,156 @@ namespace server
     }
 
     template < class Trait, class Connection, class Timer >
-    void connection< Trait, Connection, Timer >::deliver_body()
+    void connection< Trait, Connection, Timer >::write_blocked(write_queue& writes)
+    {
+        for ( const blocked_write_base* write = writes.front(); write; write = write->next_ )
+        {
+            if ( !write->combinable() )
+            {
+                for ( blocked_write_base* w = writes.front(); w; w = w->next_ )
+                    (*w)(connection_);
+
+                return;
+            }
+        }
+
+        write_gathered(writes);
+    }
+
+    template < class Trait, class Connection, class Timer >
+    void connection< Trait, Connection, Timer >::write_deferred()
+    {
+        if ( !defer_writes_ )
+            return;
+
+        defer_writes_ = false;
+
+        if ( responses_.empty() )
+            return;
+
+        write_queue writes;
+        blocked_writes_.take(*responses_.front(), writes);
+
+        if ( !writes.empty() )
+            write_blocked(writes);
+    }
+
+    template < class Trait, class Connection, class Timer >
+    void connection< Trait, Connection, Timer >::write_gathered(write_queue& writes)
+    {
+        assert( !writes.empty() );
+        assert( gathered_writes_.empty() );
+
+        buffer_list& buffers = gathered_buffers_;
+        buffers.clear();
+
+        for ( const blocked_write_base* write = writes.front(); write; write = write->next_ )
+            write->gather(buffers);
+
+        // as long as the previous response is completely written, the writes of the next response can be added
+        for ( response_list::const_iterator response = responses_.begin() + 1;
+            response != responses_.end() && writes.back()->last_; ++response )
+        {
+            write_queue next;
+            blocked_writes_.take(**response, next);
+
+            bool combinable = !next.empty() && next.back()->last_
+                && buffers.size() + next.buffer_count() <= max_gathered_buffers;
+
+            for ( const blocked_write_base* write = next.front(); write && combinable; write = write->next_ )
+                combinable = write->combinable();
+
+            if ( !combinable )
+            {
+                blocked_writes_.splice(next);
+                break;
+            }
+
+            for ( const blocked_write_base* write = next.front(); write; write = write->next_ )
+                write->gather(buffers);
+
+            writes.splice(next);
+        }
+
+        gathered_writes_.swap(writes);
+
+        server::async_write_with_to(
+            connection_,
+            buffer_list_ref(buffers),
+            boost::bind( &connection::handle_gathered_write,
+                         boost::static_pointer_cast< connection< Trait, Connection > >( this->shared_from_this() ),
+                         boost::asio::placeholders::error,
+                         boost::asio::placeholders::bytes_transferred ),
+            write_timer_,
+            trait_.timeout() );
+
+        current_response_is_sending_ = true;
+    }
+
+    template < class Trait, class Connection, class Timer >
+    void connection< Trait, Connection, Timer >::handle_gathered_write(
+        const boost::system::error_code& error, std::size_t bytes_transferred)
+    {
+        write_queue writes;
+        writes.swap(gathered_writes_);
+
+        // the handlers are called in the order of the responses; every handler is likely to complete its response
+        for ( blocked_write_base* write = writes.front(); write; write = write->next_ )
+        {
+            const std::size_t size = std::min(write->size(), bytes_transferred);
+            bytes_transferred -= size;
+
+            write->written(error, size);
+        }
+    }
+
+    template < class Trait, class Connection, class Timer >
+    void connection< Trait, Connection, Timer >::deliver_body( const char*& body_data, std::size_t& bytes_transferred )
     {
     	assert( !body_read_call_back_.empty() );
-    	for ( std::pair< std::size_t, const char* > current = body_decoder_.decode(); current.first;
-    			current = body_decoder_.decode() )
-    	{
-    		body_read_call_back_( boost::system::error_code(), current.second, current.first );
-    	}
+    	assert( !body_decoder_.done() );
+
+    	body_parts_.clear();
+    	const std::size_t decoded_size = body_decoder_.feed_buffer( body_data, bytes_transferred, body_parts_ );
+
+    	bytes_transferred -= decoded_size;
+    	body_data         += decoded_size;
+
+    	if ( !body_parts_.empty() )
+    	    body_read_call_back_( boost::system::error_code(), body_parts_ );
+    }
+
+    template < class Trait, class Connection, class Timer >
+    boost::shared_ptr<http::request_header> connection< Trait, Connection, Timer >::unused_request_header()
+    {
+        // only referenced by the pool and current_request_
+        if ( current_request_.use_count() == 2 )
+            return current_request_;
+
+        for ( typename request_pool_t::const_iterator r = request_pool_.begin(); r != request_pool_.end(); ++r )
+        {
+            if ( r->unique() )
+                return *r;
+        }
+
+        const boost::shared_ptr<http::request_header> result( new http::request_header );
+        result->max_buffer_size( trait_.max_header_size() );
+
+        if ( request_pool_.size() < max_pooled_request_headers )
+        {
+            request_pool_.push_back( result );
+        }
+        else
+        {
+            // all headers are still in use by responses, replace one, that is not the current request
+            typename request_pool_t::iterator replaced = request_pool_.begin();
+            if ( *replaced == current_request_ )
+                ++replaced;
+
+            *replaced = result;
+        }
+
+        return result;
     }
 
     template < class Trait, class Connection, class Timer >
@@ -329,18 +678,55 @@ namespace server
         const ConstBufferSequence&  buffers,
         WriteHandler                handler,
         async_response&             sender)
+    {
+        async_write_impl(buffers, handler, sender, false);
+    }
+
+    template < class Trait, class Connection, class Timer >
+    template<typename ConstBufferSequence, typename WriteHandler>
+    void connection< Trait, Connection, Timer >::async_write_last(
+        const ConstBufferSequence&  buffers,
+        WriteHandler                handler,
+        async_response&             sender)
+    {
+        async_write_impl(buffers, handler, sender, true);
+    }
+
+    template < class Trait, class Connection, class Timer >
+    template<typename ConstBufferSequence, typename WriteHandler>
+    void connection< Trait, Connection, Timer >::async_write_impl(
+        const ConstBufferSequence&  buffers,
+        WriteHandler                handler,
+        async_response&             sender,
+        bool                        last)
     {
         assert( !responses_.empty() );
         trait_.event_data_write(*this, buffers, sender);
 
-        if ( responses_.front() == &sender )
+        if ( responses_.front() == &sender && defer_writes_ )
         {
-            server::async_write_with_to(
-                connection_,
-                buffers,
-                handler,
-                write_timer_,
-                trait_.timeout() );
+            blocked_writes_.push_back(new blocked_write<ConstBufferSequence, WriteHandler>(buffers, handler, sender, last));
+            current_response_is_sending_ = true;
+        }
+        else if ( responses_.front() == &sender )
+        {
+            // the following responses might already wait with their last writes
+            if ( last && !blocked_writes_.empty() )
+            {
+                write_queue writes;
+                writes.push_back(new blocked_write<ConstBufferSequence, WriteHandler>(buffers, handler, sender, last));
+
+                write_gathered(writes);
+            }
+            else
+            {
+                server::async_write_with_to(
+                    connection_,
+                    buffers,
+                    handler,
+                    write_timer_,
+                    trait_.timeout() );
+            }
 
             current_response_is_sending_ = true;
         }
@@ -350,8 +736,7 @@ namespace server
             hurry_writers(sender);
 
             // store send request until the current sender is ready
-            typename blocked_write_list::mapped_type& writes = blocked_writes_[&sender];
-            tools::save_push_back(new blocked_write<ConstBufferSequence, WriteHandler>(buffers, handler), writes);
+            blocked_writes_.push_back(new blocked_write<ConstBufferSequence, WriteHandler>(buffers, handler, sender, last));
         }
     }
 
@@ -364,7 +749,13 @@ namespace server
     {
         trait_.event_data_write(*this, buffers, sender);
 
-        if ( responses_.front() == &sender )
+        if ( responses_.front() == &sender && defer_writes_ )
+        {
+            // the write must not overtake writes of the sender, that are already deferred
+            blocked_writes_.push_back(new blocked_write_some<ConstBufferSequence, WriteHandler>(buffers, handler, sender));
+            current_response_is_sending_ = true;
+        }
+        else if ( responses_.front() == &sender )
         {
             server::async_write_with_to(
                 connection_,
@@ -382,14 +773,20 @@ namespace server
             hurry_writers(sender);
 
             // store send request until the current sender is ready
-            typename blocked_write_list::mapped_type& writes = blocked_writes_[&sender];
-            tools::save_push_back(new blocked_write_some<ConstBufferSequence, WriteHandler>(buffers, handler), writes);
+            blocked_writes_.push_back(new blocked_write_some<ConstBufferSequence, WriteHandler>(buffers, handler, sender));
         }
     }
 
     template < class Trait, class Connection, class Timer >
     template< typename ReadHandler >
     void connection< Trait, Connection, Timer >::async_read_body( ReadHandler handler )
+    {
+        async_read_body_buffers( details::body_parts_handler< ReadHandler >( handler ) );
+    }
+
+    template < class Trait, class Connection, class Timer >
+    template< typename ReadHandler >
+    void connection< Trait, Connection, Timer >::async_read_body_buffers( ReadHandler handler )
     {
 		assert( current_request_->body_expected() );
 		assert( body_read_call_back_.empty() );
@@ -399,7 +796,7 @@ namespace server
 		if ( body_decoder_.done() )
 		{
             const boost::system::error_code no_error;
-            connection_.get_io_service().post( boost::bind< void >( handler, no_error, static_cast< const char* >( 0 ), 0 ) );
+            connection_.get_io_service().post( boost::bind< void >( handler, no_error, http::body_buffers() ) );
 		}
 		else
 		{
@@ -414,7 +811,7 @@ namespace server
         trait_.event_response_completed(*this, sender);
 
         // there is no reason, why there should be outstanding, blocked writes from the current sender
-        assert(blocked_writes_.erase(&sender) == 0);
+        assert(!blocked_writes_.contains(sender));
         
         response_list::iterator senders_pos = std::find(responses_.begin(), responses_.end(), &sender);
 
@@ -425,20 +822,12 @@ namespace server
 
             if ( !responses_.empty() )
             {
-                const typename blocked_write_list::iterator pending_writes = blocked_writes_.find(responses_.front());
+                // first remove all pending writes from the list
+                write_queue writes;
+                blocked_writes_.take(*responses_.front(), writes);
 
-                if ( pending_writes != blocked_writes_.end() )
-                {
-                    // first remove all pending writes from the list
-                    typename blocked_write_list::mapped_type                             list;
-                    tools::ptr_container_guard<typename blocked_write_list::mapped_type> delete_blocked_writes(list);
-
-                    list.swap(pending_writes->second);
-                    blocked_writes_.erase(pending_writes);
-
-                    std::for_each(list.begin(), list.end(),
-                        boost::bind(&blocked_write_base::operator(), _1, boost::ref(connection_)));
-                }
+                if ( !writes.empty() )
+                    write_blocked(writes);
             }
         }
         else if ( senders_pos != responses_.end() )
@@ -475,14 +864,11 @@ namespace server
             body_read_call_back_.clear();
         }
 
-        const typename blocked_write_list::const_iterator writes = blocked_writes_.find(&sender);
+        write_queue writes;
+        blocked_writes_.take(sender, writes);
 
-        if ( writes != blocked_writes_.end() )
-        {
-            tools::ptr_container_guard<typename blocked_write_list::mapped_type> guard(writes->second);
-            std::for_each(writes->second.begin(), writes->second.end(), 
-                boost::bind(&blocked_write_base::cancel, _1));
-        }
+        for ( blocked_write_base* write = writes.front(); write; write = write->next_ )
+            write->cancel();
  
         if ( error_response.get() )
         {
@@ -580,8 +966,48 @@ namespace server
         return result;
     }
 
+    template < class Trait, class Connection, class Timer >
+    bool connection< Trait, Connection, Timer >::idle() const
+    {
+        return body_read_call_back_.empty() && current_request_->empty() && current_request_->unparsed_buffer().second == 0;
+    }
+
+    template < class Trait, class Connection, class Timer >
+    void connection< Trait, Connection, Timer >::release_idle_memory()
+    {
+        current_request_->release_buffer();
+        std::vector< char >().swap( body_buffer_ );
+        http::body_buffers().swap( body_parts_ );
+
+        // headers, that are still in use by responses are released by the responses
+        request_pool_.clear();
+        request_pool_.push_back( current_request_ );
+    }
+
     template < class Trait, class Connection, class Timer >
     void connection< Trait, Connection, Timer >::issue_read( const boost::posix_time::time_duration& time_out )
+    {
+        // an idle connection holds no buffer, while waiting for the socket to become readable
+        if ( trait_.release_idle_memory() && idle() )
+        {
+            release_idle_memory();
+
+            async_read_some(
+                boost::asio::null_buffers(),
+                boost::bind( &connection::handle_readable,
+                             boost::static_pointer_cast< connection< Trait, Connection > >( this->shared_from_this() ),
+                             boost::asio::placeholders::error,
+                             boost::asio::placeholders::bytes_transferred ),
+                time_out );
+        }
+        else
+        {
+            issue_buffered_read( time_out );
+        }
+    }
+
+    template < class Trait, class Connection, class Timer >
+    void connection< Trait, Connection, Timer >::issue_buffered_read( const boost::posix_time::time_duration& time_out )
     {
 		std::pair< char*, std::size_t > buffer( 0, 0 );
 
@@ -592,37 +1018,52 @@ namespace server
 		}
 		else
 		{
-			body_buffer_.resize( 1024u );
+			if ( body_buffer_.size() < trait_.body_buffer_size() )
+			    body_buffer_.resize( trait_.body_buffer_size() );
+
 			buffer = std::make_pair( &body_buffer_[0], body_buffer_.size() );
 		}
 
+        async_read_some(
+            boost::asio::buffer( buffer.first, buffer.second ),
+            boost::bind( &connection::handle_read,
+                         boost::static_pointer_cast< connection< Trait, Connection > >( this->shared_from_this() ),
+                         boost::asio::placeholders::error,
+                         boost::asio::placeholders::bytes_transferred ),
+            time_out );
+    }
+
+    template < class Trait, class Connection, class Timer >
+    template < class MutableBufferSequence, class ReadHandler >
+    void connection< Trait, Connection, Timer >::async_read_some( const MutableBufferSequence& buffers, ReadHandler handler,
+        const boost::posix_time::time_duration& time_out )
+    {
 		if ( time_out != boost::posix_time::seconds( 0 ) )
 		{
-            server::async_read_some_with_to(
-                connection_,
-                boost::asio::buffer( buffer.first, buffer.second ),
-                boost::bind( &connection::handle_read,
-                             boost::static_pointer_cast< connection< Trait, Connection > >( this->shared_from_this() ),
-                             boost::asio::placeholders::error,
-                             boost::asio::placeholders::bytes_transferred ),
-                read_timer_,
-                time_out );
-
+            server::async_read_some_with_to( connection_, buffers, handler, read_timer_, time_out );
             no_read_timeout_set_ = false;
 		}
 		else
 		{
-		    connection_.async_read_some(
-		        boost::asio::buffer( buffer.first, buffer.second ),
-                boost::bind( &connection::handle_read,
-                             boost::static_pointer_cast< connection< Trait, Connection > >( this->shared_from_this() ),
-                             boost::asio::placeholders::error,
-                             boost::asio::placeholders::bytes_transferred ) );
-
+		    connection_.async_read_some( buffers, handler );
 		    no_read_timeout_set_ = true;
 		}
     }
 
+    template < class Trait, class Connection, class Timer >
+	void connection< Trait, Connection, Timer >::handle_readable(const boost::system::error_code& error, std::size_t)
+    {
+        if ( error )
+        {
+            handle_read( error, 0 );
+        }
+        else
+        {
+            // data arrived, the read will not block
+            issue_buffered_read( read_timeout_value() );
+        }
+    }
+
     template < class Trait, class Connection, class Timer >
 	void connection< Trait, Connection, Timer >::handle_read(const boost::system::error_code& error, std::size_t bytes_transferred)
     {
@@ -638,69 +1079,76 @@ namespace server
         	if ( !body_read_call_back_.empty() )
         	{
         		const boost::system::error_code published_error = error ? error : make_error_code( canceled_by_error );
-        		body_read_call_back_( published_error, 0, 0 );
+        		body_read_call_back_( published_error, http::body_buffers() );
         		body_read_call_back_.clear();
         	}
 			return;
 		}
 
+        // the not yet decoded part of a request body; the body is decoded in place, either from the body buffer
+        // or from the part of the request header buffer, that was read behind the header
+        const char* body_data = body_read_call_back_.empty() ? 0 : &body_buffer_[0];
+
         while ( bytes_transferred != 0 )
         {
         	// reading a body
         	if ( !body_read_call_back_.empty() )
         	{
-        		assert( !body_decoder_.done() );
-
-        		const std::size_t decoded_size = body_decoder_.feed_buffer( &body_buffer_[0], bytes_transferred );
-
-        		if ( decoded_size )
-        		{
-        			bytes_transferred -= decoded_size;
-        			deliver_body();
-                    body_buffer_.erase( body_buffer_.begin(), body_buffer_.begin() + decoded_size );
-        		}
+        		// this consumes and decreases bytes_transferred
+        		deliver_body( body_data, bytes_transferred );
 
         		if ( body_decoder_.done() )
         		{
         			// this consumes and decreases bytes_transferred
-					current_request_.reset( new http::request_header(
-							boost::asio::const_buffers_1( &body_buffer_[0], bytes_transferred ), bytes_transferred ) );
+					const boost::shared_ptr<http::request_header> next_request = unused_request_header();
+					next_request->reset(
+							boost::asio::const_buffers_1( body_data, bytes_transferred ), bytes_transferred );
+					current_request_ = next_request;
 
 					body_read_cb_t read_call_back;
                     body_read_call_back_.swap( read_call_back );
 
                     if ( !read_call_back.empty() )
-                        read_call_back( error, 0, 0 );
+                        read_call_back( error, http::body_buffers() );
         		}
         	}
         	// or reading a header
         	else if ( current_request_->parse( bytes_transferred ) )
         	{
+                // if more data follows the header, the responses to pipelined requests, that are read with this read,
+                // are written together
+                if ( current_request_->unparsed_buffer().second != 0 )
+                    defer_writes_ = true;
+
                 if ( !handle_request_header( current_request_ ) )
                 {
                 	trait_.event_close_after_response( *this, *current_request_ );
+                	write_deferred();
                 	return;
                 }
 
                 if ( current_request_->state() != http::request_header::ok )
                 {
                     trait_.error_request_parse_error( *this, *current_request_ );
+                	write_deferred();
                 	return;
                 }
 
                 // handle_request_header() can switch to body decoding mode
                 if ( body_read_call_back_.empty() )
                 {
-					// this consumes and decreases bytes_transferred
-					current_request_.reset( new http::request_header( *current_request_, bytes_transferred,
-							http::request_header::copy_trailing_buffer ) );
+					// this consumes and decreases bytes_transferred; if no response refers to the current
+					// request anymore, the trailing data is moved within the current request
+					const boost::shared_ptr<http::request_header> next_request = unused_request_header();
+					next_request->reset( *current_request_, bytes_transferred,
+							http::request_header::copy_trailing_buffer );
+					current_request_ = next_request;
                 }
                 else
                 {
                 	const std::pair<char*, std::size_t> unparsed_read = current_request_->unparsed_buffer();
                 	bytes_transferred = unparsed_read.second;
-                	body_buffer_.resize( bytes_transferred );
-                	std::copy( unparsed_read.first, unparsed_read.first + unparsed_read.second, body_buffer_.begin() );
+                	body_data         = unparsed_read.first;
                 }
             }
         	else
@@ -710,6 +1158,7 @@ namespace server
         	}
         }
 
+        write_deferred();
         issue_read( read_timeout_value() );
     }
 
@@ -759,14 +1208,57 @@ namespace server
         return true;
     }
 
+    ////////////////////////////
+    // class blocked_write_base
+	template < class Trait, class Connection, class Timer >
+    connection< Trait, Connection, Timer >::blocked_write_base::blocked_write_base(async_response& sender, bool last)
+        : next_(0)
+        , sender_(&sender)
+        , last_(last)
+    {
+    }
+
+	template < class Trait, class Connection, class Timer >
+    bool connection< Trait, Connection, Timer >::blocked_write_base::combinable() const
+    {
+        return false;
+    }
+
+	template < class Trait, class Connection, class Timer >
+    void connection< Trait, Connection, Timer >::blocked_write_base::gather(buffer_list&) const
+    {
+        assert( !"gather() called on a write, that can not be combined" );
+    }
+
+	template < class Trait, class Connection, class Timer >
+    std::size_t connection< Trait, Connection, Timer >::blocked_write_base::buffer_count() const
+    {
+        return 0;
+    }
+
+	template < class Trait, class Connection, class Timer >
+    void connection< Trait, Connection, Timer >::blocked_write_base::written(const boost::system::error_code&, std::size_t)
+    {
+        assert( !"written() called on a write, that can not be combined" );
+    }
+
+	template < class Trait, class Connection, class Timer >
+    std::size_t connection< Trait, Connection, Timer >::blocked_write_base::size() const
+    {
+        return 0;
+    }
+
     ///////////////////////
     // class blocked_write
 	template < class Trait, class Connection, class Timer >
     template < class ConstBufferSequence, class WriteHandler >
     connection< Trait, Connection, Timer >::blocked_write<ConstBufferSequence, WriteHandler>::blocked_write(
         const ConstBufferSequence&  buffers,
-        WriteHandler                handler)
-        : buffers_(buffers)
+        WriteHandler                handler,
+        async_response&             sender,
+        bool                        last)
+        : blocked_write_base(sender, last)
+        , buffers_(buffers)
         , handler_(handler)
     {
     }
@@ -785,14 +1277,52 @@ namespace server
         handler_(make_error_code(canceled_by_error), 0);
     }
 
+	template < class Trait, class Connection, class Timer >
+    template < class ConstBufferSequence, class WriteHandler >
+    bool connection< Trait, Connection, Timer >::blocked_write<ConstBufferSequence, WriteHandler>::combinable() const
+    {
+        return true;
+    }
+
+	template < class Trait, class Connection, class Timer >
+    template < class ConstBufferSequence, class WriteHandler >
+    void connection< Trait, Connection, Timer >::blocked_write<ConstBufferSequence, WriteHandler>::gather(buffer_list& list) const
+    {
+        list.insert(list.end(), buffers_.begin(), buffers_.end());
+    }
+
+	template < class Trait, class Connection, class Timer >
+    template < class ConstBufferSequence, class WriteHandler >
+    std::size_t connection< Trait, Connection, Timer >::blocked_write<ConstBufferSequence, WriteHandler>::buffer_count() const
+    {
+        return std::distance(buffers_.begin(), buffers_.end());
+    }
+
+	template < class Trait, class Connection, class Timer >
+    template < class ConstBufferSequence, class WriteHandler >
+    void connection< Trait, Connection, Timer >::blocked_write<ConstBufferSequence, WriteHandler>::written(
+        const boost::system::error_code& error, std::size_t bytes_transferred)
+    {
+        handler_(error, bytes_transferred);
+    }
+
+	template < class Trait, class Connection, class Timer >
+    template < class ConstBufferSequence, class WriteHandler >
+    std::size_t connection< Trait, Connection, Timer >::blocked_write<ConstBufferSequence, WriteHandler>::size() const
+    {
+        return boost::asio::buffer_size(buffers_);
+    }
+
     ////////////////////////////
     // class blocked_write_some
 	template < class Trait, class Connection, class Timer >
     template < class ConstBufferSequence, class WriteHandler >
     connection< Trait, Connection, Timer >::blocked_write_some<ConstBufferSequence, WriteHandler>::blocked_write_some(
         const ConstBufferSequence&  buffers,
-        WriteHandler                handler)
-        : buffers_(buffers)
+        WriteHandler                handler,
+        async_response&             sender)
+        : blocked_write_base(sender, false)
+        , buffers_(buffers)
         , handler_(handler)
     {
     }
@@ -811,6 +1341,136 @@ namespace server
         handler_(make_error_code(canceled_by_error), 0);
     }
 
+    ////////////////////////////
+    // class write_queue
+	template < class Trait, class Connection, class Timer >
+    connection< Trait, Connection, Timer >::write_queue::write_queue()
+        : head_(0)
+        , tail_(0)
+    {
+    }
+
+	template < class Trait, class Connection, class Timer >
+    connection< Trait, Connection, Timer >::write_queue::~write_queue()
+    {
+        while ( head_ )
+        {
+            blocked_write_base* const next = head_->next_;
+            delete head_;
+            head_ = next;
+        }
+    }
+
+	template < class Trait, class Connection, class Timer >
+    bool connection< Trait, Connection, Timer >::write_queue::empty() const
+    {
+        return head_ == 0;
+    }
+
+	template < class Trait, class Connection, class Timer >
+    typename connection< Trait, Connection, Timer >::blocked_write_base*
+    connection< Trait, Connection, Timer >::write_queue::front() const
+    {
+        return head_;
+    }
+
+	template < class Trait, class Connection, class Timer >
+    typename connection< Trait, Connection, Timer >::blocked_write_base*
+    connection< Trait, Connection, Timer >::write_queue::back() const
+    {
+        return tail_;
+    }
+
+	template < class Trait, class Connection, class Timer >
+    void connection< Trait, Connection, Timer >::write_queue::push_back(blocked_write_base* write)
+    {
+        assert( write && write->next_ == 0 );
+
+        if ( tail_ )
+            tail_->next_ = write;
+        else
+            head_ = write;
+
+        tail_ = write;
+    }
+
+	template < class Trait, class Connection, class Timer >
+    void connection< Trait, Connection, Timer >::write_queue::splice(write_queue& other)
+    {
+        if ( other.empty() )
+            return;
+
+        if ( tail_ )
+            tail_->next_ = other.head_;
+        else
+            head_ = other.head_;
+
+        tail_ = other.tail_;
+        other.head_ = 0;
+        other.tail_ = 0;
+    }
+
+	template < class Trait, class Connection, class Timer >
+    void connection< Trait, Connection, Timer >::write_queue::take(const async_response& sender, write_queue& writes)
+    {
+        blocked_write_base* previous = 0;
+
+        for ( blocked_write_base* write = head_; write; )
+        {
+            blocked_write_base* const next = write->next_;
+
+            if ( write->sender_ == &sender )
+            {
+                if ( previous )
+                    previous->next_ = next;
+                else
+                    head_ = next;
+
+                if ( tail_ == write )
+                    tail_ = previous;
+
+                write->next_ = 0;
+                writes.push_back(write);
+            }
+            else
+            {
+                previous = write;
+            }
+
+            write = next;
+        }
+    }
+
+	template < class Trait, class Connection, class Timer >
+    bool connection< Trait, Connection, Timer >::write_queue::contains(const async_response& sender) const
+    {
+        for ( const blocked_write_base* write = head_; write; write = write->next_ )
+        {
+            if ( write->sender_ == &sender )
+                return true;
+        }
+
+        return false;
+    }
+
+	template < class Trait, class Connection, class Timer >
+    std::size_t connection< Trait, Connection, Timer >::write_queue::buffer_count() const
+    {
+        std::size_t result = 0;
+
+        for ( const blocked_write_base* write = head_; write; write = write->next_ )
+            result += write->buffer_count();
+
+        return result;
+    }
+
+	template < class Trait, class Connection, class Timer >
+    void connection< Trait, Connection, Timer >::write_queue::swap(write_queue& other)
+    {
+        std::swap(head_, other.head_);
+        std::swap(tail_, other.tail_);
+    }
+
     template < class Connection, class Trait >
     boost::shared_ptr< connection< Trait, Connection > > create_connection(const Connection& con, Trait& trait)
     {
@@ -0,0 +1,187 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+#include "server/connection.h"
+#include "server/error.h"
+#include "server/test_response.h"
+#include "server/traits.h"
+#include "server/log.h"
+#include "asio_mocks/test_socket.h"
+#include "asio_mocks/test_timer.h"
+#include "http/test_request_texts.h"
+#include "tools/elapse_timer.h"
+#include "tools/iterators.h"
+#include <boost/asio/io_service.hpp>
+#include <boost/bind.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+
+/*
+ * measures the number of allocations, the allocated memory and the number of socket writes per request, when a
+ * single connection receives a lot of keep alive requests. The responses do not hold on to the request headers.
+ *
+ * In addition, the memory used by a lot of idle connections, that wait for the next request is measured.
+ */
+namespace
+{
+    std::size_t allocations     = 0;
+    std::size_t allocated_bytes = 0;
+    std::size_t live_bytes      = 0;
+
+    // every allocation is prefixed with its size, to be able to track the currently allocated memory
+    const std::size_t prefix_size = 16u;
+}
+
+void* operator new( std::size_t size )
+{
+    ++allocations;
+    allocated_bytes += size;
+    live_bytes      += size;
+
+    if ( char* const result = static_cast< char* >( std::malloc( size + prefix_size ) ) )
+    {
+        *reinterpret_cast< std::size_t* >( result ) = size;
+        return result + prefix_size;
+    }
+
+    throw std::bad_alloc();
+}
+
+void operator delete( void* p ) throw()
+{
+    if ( p == 0 )
+        return;
+
+    char* const block = static_cast< char* >( p ) - prefix_size;
+    live_bytes -= *reinterpret_cast< std::size_t* >( block );
+
+    std::free( block );
+}
+
+namespace
+{
+    typedef asio_mocks::socket< const char* > socket_t;
+
+    struct response_factory
+    {
+        template < class Connection >
+        boost::shared_ptr< server::async_response > create_response(
+            const boost::shared_ptr< Connection >&                    connection,
+            const boost::shared_ptr< const http::request_header >&    header )
+        {
+            return boost::shared_ptr< server::async_response >(
+                new server::test::response< Connection >( connection, header, "Hello" ) );
+        }
+
+        template < class Connection >
+        boost::shared_ptr< server::async_response > error_response(
+            const boost::shared_ptr< Connection >& connection, http::http_error_code ec ) const
+        {
+            return boost::shared_ptr< server::async_response >( new server::error_response< Connection >( connection, ec ) );
+        }
+    };
+
+    typedef server::connection_traits< socket_t, asio_mocks::timer, response_factory > trait_t;
+
+    const unsigned number_of_requests           = 100000u;
+    const unsigned number_of_idle_connections   = 100000u;
+
+    // a minimal request, as it is used by polling clients; several requests fit into a single read
+    const char small_get[] = "GET /poll HTTP/1.1\r\nHost: example.com\r\n\r\n";
+
+    void count_write( std::size_t& writes, const boost::asio::const_buffer& )
+    {
+        ++writes;
+    }
+
+    // the connection reads the given text times times, with at most bite_size bytes per read
+    void measure( const char* name, const std::string& text, unsigned times, std::size_t bite_size )
+    {
+        boost::asio::io_service queue;
+        trait_t                 trait;
+        socket_t                socket( queue, text.data(), text.data() + text.size(), bite_size, times );
+
+        std::size_t writes = 0;
+        socket.write_callback( boost::bind( &count_write, boost::ref( writes ), _1 ) );
+
+        const std::size_t start_allocations = allocations;
+        const std::size_t start_bytes       = allocated_bytes;
+        const tools::elapse_timer time;
+
+        server::create_connection( socket, trait );
+        queue.run();
+
+        const boost::posix_time::time_duration elapsed = time.elapsed();
+
+        std::cout << name
+                  << ": elapsed: " << elapsed
+                  << "; allocations per request: "
+                  << static_cast< double >( allocations - start_allocations ) / number_of_requests
+                  << "; bytes per request: " << ( allocated_bytes - start_bytes ) / number_of_requests
+                  << "; writes per request: " << static_cast< double >( writes ) / number_of_requests
+                  << std::endl;
+    }
+
+    // every connection receives a single request and then waits for the next request
+    void measure_idle_connections( const char* name, bool release_idle_memory )
+    {
+        boost::asio::io_service queue;
+        trait_t                 trait;
+        trait.release_idle_memory( release_idle_memory );
+
+        const std::string       request( tools::begin( http::test::simple_get_11 ), tools::end( http::test::simple_get_11 ) - 1 );
+        const std::size_t       start_bytes = live_bytes;
+
+        for ( unsigned i = 0; i != number_of_idle_connections; ++i )
+        {
+            asio_mocks::read_plan plan;
+            plan.add( request );
+            plan.delay( boost::posix_time::hours( 1 ) );
+
+            server::create_connection( socket_t( queue, plan ), trait );
+
+            while ( queue.poll() )
+                ;
+        }
+
+        std::cout << name
+                  << ": bytes per idle connection: " << ( live_bytes - start_bytes ) / number_of_idle_connections
+                  << std::endl;
+
+        // let all connections time out, so that no connection outlives the queue
+        while ( asio_mocks::advance_time() )
+        {
+            queue.reset();
+            queue.run();
+        }
+    }
+}
+
+int main()
+{
+    std::cout << "requests: " << number_of_requests << std::endl;
+
+    const std::string request( tools::begin( http::test::simple_get_11 ), tools::end( http::test::simple_get_11 ) - 1 );
+
+    std::string pipelined_requests;
+    std::string small_pipelined_requests;
+
+    for ( unsigned i = 0; i != number_of_requests; ++i )
+    {
+        pipelined_requests       += request;
+        small_pipelined_requests += small_get;
+    }
+
+    measure( "one request per read", request, number_of_requests, request.size() );
+    measure( "pipelined requests", pipelined_requests, 1, 4 * 1024 );
+    measure( "small pipelined requests", small_pipelined_requests, 1, 4 * 1024 );
+
+    std::cout << "idle connections: " << number_of_idle_connections << std::endl;
+
+    measure_idle_connections( "buffered reads", false );
+    measure_idle_connections( "idle memory released", true );
+}
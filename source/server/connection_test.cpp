@@ -264,6 +264,45 @@ BOOST_AUTO_TEST_CASE( timeout_while_writing_to_client )
     BOOST_CHECK(connection.expired());
 }
 
+/**
+ * @test read and write timeouts are implemented by a wheel_timer, when the traits name it as Timer
+ */
+BOOST_AUTO_TEST_CASE( timeout_while_writing_to_client_with_wheel_timer )
+{
+    using asio_mocks::read;
+    using asio_mocks::write;
+    using asio_mocks::delay;
+
+    boost::asio::io_service     queue;
+
+    asio_mocks::read_plan       reads;
+    reads << read(begin(simple_get_11), end(simple_get_11))
+          << delay(boost::posix_time::seconds(60))
+          << read("");
+
+    asio_mocks::write_plan       writes;
+    writes << write(2) << delay(boost::posix_time::seconds(60));
+
+    traits_with_wheel_timer_t::connection_type  socket(queue, reads, writes);
+    traits_with_wheel_timer_t                   trait;
+
+    boost::weak_ptr<server::connection< traits_with_wheel_timer_t > > connection(server::create_connection(socket, trait));
+    BOOST_CHECK(!connection.expired());
+
+    tools::elapse_timer time;
+    queue.run();
+
+    // the wheel rounds the timeout up to its next tick
+    server::connection_config config;
+    BOOST_CHECK_GE(time.elapsed(), config.timeout() - boost::posix_time::seconds(1));
+    BOOST_CHECK_LE(time.elapsed(), config.timeout() + boost::posix_time::seconds(1));
+
+    trait.reset_responses();
+    BOOST_CHECK_EQUAL("He", socket.output());
+
+    BOOST_CHECK(connection.expired());
+}
+
 /**
  * @test handle timeout while reading from a client
  *
@@ -438,3 +477,144 @@ BOOST_AUTO_TEST_CASE( no_timeout_applies_when_client_doesnt_block )
     // no outstanding reference to the connection object, so no read is pending on the connection to the client
     BOOST_CHECK( connection.expired() );
 }
+
+/**
+ * @test an idle connection that released its buffers, still receives the next request, even when the request is
+ *       received in small parts
+ */
+BOOST_AUTO_TEST_CASE( read_requests_with_idle_memory_released )
+{
+    using asio_mocks::read;
+    using asio_mocks::delay;
+
+    boost::asio::io_service     queue;
+    asio_mocks::read_plan       reads;
+    reads << read( begin( simple_get_11 ), end( simple_get_11 ) )
+          << delay( boost::posix_time::millisec( 20 ) )
+          << read( begin( simple_get_11 ), begin( simple_get_11 ) + 10 )
+          << read( begin( simple_get_11 ) + 10, end( simple_get_11 ) )
+          << read( "" );
+
+    traits<>::connection_type   socket( queue, reads );
+    traits<>                    trait;
+    trait.release_idle_memory( true );
+
+    boost::weak_ptr< server::connection< traits<> > > connection( server::create_connection( socket, trait ) );
+
+    queue.run();
+
+    BOOST_CHECK_EQUAL( 2u, trait.requests().size() );
+
+    trait.reset_responses();
+    BOOST_CHECK_EQUAL( "HelloHello", socket.output() );
+    BOOST_CHECK( connection.expired() );
+}
+
+/**
+ * @test a lot of pipelined requests are received, with idle memory released
+ */
+BOOST_AUTO_TEST_CASE( read_multiple_header_with_idle_memory_released )
+{
+    boost::asio::io_service     queue;
+    traits<>::connection_type   socket( queue, begin( simple_get_11 ), end( simple_get_11 ), 400, 2000 );
+    traits<>                    trait;
+    trait.release_idle_memory( true );
+
+    server::create_connection( socket, trait );
+
+    queue.run();
+
+    BOOST_CHECK_EQUAL( 2000u, trait.requests().size() );
+}
+
+namespace {
+    // writes the first part of the answer with async_write() and without waiting, the second with async_write_some()
+    template < class Connection >
+    class split_response : public server::async_response, public boost::enable_shared_from_this< split_response< Connection > >
+    {
+    public:
+        split_response( const boost::shared_ptr< Connection >& connection, const std::string& first, const std::string& second )
+            : connection_( connection )
+            , first_( first )
+            , second_( second )
+            , outstanding_writes_( 2 )
+        {
+        }
+
+        void start()
+        {
+            connection_->async_write(
+                boost::asio::buffer( first_ ),
+                boost::bind( &split_response::handler, this->shared_from_this(), boost::asio::placeholders::error ),
+                *this );
+
+            connection_->async_write_some(
+                boost::asio::buffer( second_ ),
+                boost::bind( &split_response::handler, this->shared_from_this(), boost::asio::placeholders::error ),
+                *this );
+        }
+
+        const char* name() const
+        {
+            return "split_response";
+        }
+
+    private:
+        void handler( const boost::system::error_code& error )
+        {
+            if ( error )
+            {
+                connection_->response_not_possible( *this );
+            }
+            else if ( --outstanding_writes_ == 0 )
+            {
+                connection_->response_completed( *this );
+            }
+        }
+
+        const boost::shared_ptr< Connection >   connection_;
+        const std::string                       first_;
+        const std::string                       second_;
+        unsigned                                outstanding_writes_;
+    };
+
+    struct split_response_factory
+    {
+        template < class Trait, class Connection >
+        static boost::shared_ptr< server::async_response > create_response(
+            const boost::shared_ptr< Connection >&                    connection,
+            const boost::shared_ptr< const http::request_header >&,
+                  Trait&                                            trait )
+        {
+            const char id = static_cast< char >( '0' + trait.requests().size() );
+
+            return boost::shared_ptr< server::async_response >(
+                new split_response< Connection >( connection, std::string( 1, id ) + "a", std::string( 1, id ) + "b" ) );
+        }
+    };
+}
+
+/**
+ * @test responses to pipelined requests, that mix async_write() and async_write_some(), are written in the order
+ *       of the writes, while the writes of the first response are deferred
+ */
+BOOST_AUTO_TEST_CASE( mixed_writes_of_pipelined_responses_stay_in_order )
+{
+    typedef traits< split_response_factory > trait_t;
+
+    const std::string               requests =
+        std::string( begin( simple_get_11 ), end( simple_get_11 ) ) + simple_get_11 + simple_get_11;
+
+    boost::asio::io_service         queue;
+    trait_t::connection_type        socket( queue, requests.data(), requests.data() + requests.size(), 0 );
+    trait_t                         trait;
+
+    server::create_connection( socket, trait );
+
+    queue.run();
+
+    BOOST_CHECK_EQUAL( 3u, trait.requests().size() );
+    trait.reset_responses();
+
+    BOOST_CHECK_EQUAL( "1a1b2a2b3a3b", socket.output() );
+}
@@ -76,7 +76,7 @@ namespace server
     template < class Connection >
     void error_response< Connection >::start()
     {
-        connection_->async_write(
+        connection_->async_write_last(
             boost::asio::buffer( buffer_ ),
             boost::bind(
                 &error_response::handle_written, 
@@ -0,0 +1,393 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+#include "server/metrics.h"
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/scoped_array.hpp>
+#include <boost/thread/thread.hpp>
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <ostream>
+#include <stdexcept>
+
+namespace server
+{
+    //////////////////////////
+    // class latency_histogram
+    latency_histogram::latency_histogram()
+        : counts_( bucket_count, 0 )
+        , count_( 0 )
+    {
+    }
+
+    unsigned latency_histogram::bucket( boost::uint64_t value )
+    {
+        if ( value < sub_bucket_count )
+            return static_cast< unsigned >( value );
+
+        if ( value >> value_bits )
+            return bucket_count - 1;
+
+        // the position of the highest set bit
+        unsigned exponent = sub_bucket_bits;
+        while ( value >> ( exponent + 1 ) )
+            ++exponent;
+
+        const unsigned shift = exponent - sub_bucket_bits;
+
+        return ( shift + 1 ) * sub_bucket_count + static_cast< unsigned >( ( value >> shift ) & ( sub_bucket_count - 1 ) );
+    }
+
+    boost::uint64_t latency_histogram::upper_bound( unsigned bucket )
+    {
+        assert( bucket < bucket_count );
+
+        if ( bucket < sub_bucket_count )
+            return bucket;
+
+        const unsigned          shift = bucket / sub_bucket_count - 1;
+        const boost::uint64_t   lower = boost::uint64_t( sub_bucket_count + bucket % sub_bucket_count ) << shift;
+
+        return lower + ( boost::uint64_t( 1 ) << shift ) - 1;
+    }
+
+    void latency_histogram::record( boost::uint64_t value )
+    {
+        add( bucket( value ), 1 );
+    }
+
+    void latency_histogram::add( unsigned bucket, boost::uint64_t count )
+    {
+        assert( bucket < bucket_count );
+        counts_[ bucket ] += count;
+        count_            += count;
+    }
+
+    latency_histogram& latency_histogram::operator+=( const latency_histogram& rhs )
+    {
+        for ( unsigned bucket = 0; bucket != bucket_count; ++bucket )
+            counts_[ bucket ] += rhs.counts_[ bucket ];
+
+        count_ += rhs.count_;
+
+        return *this;
+    }
+
+    boost::uint64_t latency_histogram::count() const
+    {
+        return count_;
+    }
+
+    boost::uint64_t latency_histogram::percentile( double quantile ) const
+    {
+        assert( quantile >= 0.0 && quantile <= 1.0 );
+
+        if ( count_ == 0 )
+            return 0;
+
+        // the rank of the value at the quantile, counting from 1
+        const boost::uint64_t rank = std::max< boost::uint64_t >( 1u,
+            static_cast< boost::uint64_t >( quantile * static_cast< double >( count_ ) + 0.5 ) );
+
+        boost::uint64_t seen = 0;
+        for ( unsigned bucket = 0; bucket != bucket_count; ++bucket )
+        {
+            seen += counts_[ bucket ];
+
+            if ( seen >= rank )
+                return upper_bound( bucket );
+        }
+
+        return upper_bound( bucket_count - 1 );
+    }
+
+    /////////////////////////
+    // struct metrics_snapshot
+    const char* metrics_snapshot::name( counter c )
+    {
+        static const char* const names[ counter_count ] = {
+            "connections_created",
+            "connections_destroyed",
+            "responses_started",
+            "responses_completed",
+            "responses_failed",
+            "bytes_written",
+            "writes",
+            "blocked_writes",
+            "keep_alive_timeouts"
+        };
+
+        assert( c < counter_count );
+        return names[ c ];
+    }
+
+    metrics_snapshot::metrics_snapshot()
+        : elapsed()
+        , routes()
+        , response_types()
+    {
+        std::fill( counters, counters + counter_count, 0 );
+    }
+
+    double metrics_snapshot::responses_per_second() const
+    {
+        const boost::int64_t micro_seconds = elapsed.total_microseconds();
+
+        return micro_seconds <= 0
+            ? 0.0
+            : static_cast< double >( counters[ responses_completed ] ) * 1000000.0 / static_cast< double >( micro_seconds );
+    }
+
+    namespace {
+        void print_latencies( std::ostream& out, const char* label, const std::string& name, const latency_histogram& histogram )
+        {
+            out << label << "_responses{" << label << "=\"" << name << "\"} " << histogram.count() << '\n'
+                << label << "_latency_us{" << label << "=\"" << name << "\",quantile=\"0.5\"} " << histogram.percentile( 0.5 ) << '\n'
+                << label << "_latency_us{" << label << "=\"" << name << "\",quantile=\"0.99\"} " << histogram.percentile( 0.99 ) << '\n'
+                << label << "_latency_us{" << label << "=\"" << name << "\",quantile=\"1\"} " << histogram.percentile( 1.0 ) << '\n';
+        }
+    }
+
+    void metrics_snapshot::print( std::ostream& out ) const
+    {
+        out << "elapsed_seconds " << static_cast< double >( elapsed.total_milliseconds() ) / 1000.0 << '\n';
+
+        for ( unsigned c = 0; c != counter_count; ++c )
+            out << name( static_cast< counter >( c ) ) << ' ' << counters[ c ] << '\n';
+
+        out << "responses_per_second " << responses_per_second() << '\n';
+
+        for ( std::vector< std::pair< std::string, latency_histogram > >::const_iterator route = routes.begin();
+            route != routes.end(); ++route )
+        {
+            print_latencies( out, "route", route->first, route->second );
+        }
+
+        for ( std::map< std::string, latency_histogram >::const_iterator type = response_types.begin();
+            type != response_types.end(); ++type )
+        {
+            print_latencies( out, "type", type->first, type->second );
+        }
+    }
+
+    std::ostream& operator<<( std::ostream& out, const metrics_snapshot& snapshot )
+    {
+        snapshot.print( out );
+        return out;
+    }
+
+    //////////////////////////
+    // class metrics_event_log
+    namespace {
+        // the counters of a single writer are updated without locked instructions
+        void increment( std::atomic< boost::uint64_t >& counter, boost::uint64_t value )
+        {
+            counter.store( counter.load( std::memory_order_relaxed ) + value, std::memory_order_relaxed );
+        }
+
+        std::atomic< unsigned > last_event_log_id( 0 );
+
+        // the shard of the current thread for the event log with the given id
+        struct cached_shard
+        {
+            unsigned    id;
+            void*       shard;
+        };
+
+        thread_local cached_shard current_shard = { 0, 0 };
+    }
+
+    metrics_event_log::recorder::recorder()
+    {
+        for ( unsigned bucket = 0; bucket != latency_histogram::bucket_count; ++bucket )
+            counts_[ bucket ].store( 0, std::memory_order_relaxed );
+    }
+
+    void metrics_event_log::recorder::record( boost::uint64_t value )
+    {
+        increment( counts_[ latency_histogram::bucket( value ) ], 1 );
+    }
+
+    void metrics_event_log::recorder::add_to( latency_histogram& histogram ) const
+    {
+        for ( unsigned bucket = 0; bucket != latency_histogram::bucket_count; ++bucket )
+        {
+            const boost::uint64_t count = counts_[ bucket ].load( std::memory_order_relaxed );
+
+            if ( count )
+                histogram.add( bucket, count );
+        }
+    }
+
+    struct metrics_event_log::shard : boost::noncopyable
+    {
+        shard( boost::thread::id thread, std::size_t number_of_routes )
+            : owner( thread )
+            , routes( new recorder[ number_of_routes ] )
+            , types_mutex()
+            , types()
+        {
+            for ( unsigned c = 0; c != metrics_snapshot::counter_count; ++c )
+                counters[ c ].store( 0, std::memory_order_relaxed );
+        }
+
+        // only the owner inserts new types, but the owner has to lock the mutex while inserting, as snapshot()
+        // iterates over the types.
+        recorder& type( const char* name )
+        {
+            const std::map< const char*, boost::shared_ptr< recorder > >::const_iterator pos = types.find( name );
+
+            if ( pos != types.end() )
+                return *pos->second;
+
+            const boost::shared_ptr< recorder > new_recorder( new recorder );
+
+            boost::mutex::scoped_lock lock( types_mutex );
+            types[ name ] = new_recorder;
+
+            return *new_recorder;
+        }
+
+        const boost::thread::id                                 owner;
+        atomic_counter                                          counters[ metrics_snapshot::counter_count ];
+        boost::scoped_array< recorder >                         routes;
+
+        boost::mutex                                            types_mutex;
+        std::map< const char*, boost::shared_ptr< recorder > >  types;
+    };
+
+    metrics_event_log::metrics_event_log()
+        : id_( next_id() )
+        , start_( now() )
+        , route_table_()
+        , routes_()
+        , mutex_()
+        , shards_()
+    {
+    }
+
+    metrics_event_log::~metrics_event_log()
+    {
+    }
+
+    unsigned metrics_event_log::next_id()
+    {
+        return ++last_event_log_id;
+    }
+
+    boost::uint64_t metrics_event_log::now()
+    {
+        return std::chrono::duration_cast< std::chrono::microseconds >(
+            std::chrono::steady_clock::now().time_since_epoch() ).count();
+    }
+
+    void metrics_event_log::add_route( const std::string& route )
+    {
+        boost::mutex::scoped_lock lock( mutex_ );
+
+        // the shards have a recorder for every route, that was known, when the shard was created
+        if ( !shards_.empty() )
+            throw std::logic_error( "metrics_event_log::add_route(): routes have to be added before the first event" );
+
+        if ( std::find( routes_.begin(), routes_.end(), route ) != routes_.end() )
+            return;
+
+        route_table_.add( route, routes_.size() );
+        routes_.push_back( route );
+    }
+
+    metrics_snapshot metrics_event_log::snapshot() const
+    {
+        metrics_snapshot result;
+        result.elapsed = boost::posix_time::microsec( static_cast< boost::int64_t >( now() - start_ ) );
+
+        boost::mutex::scoped_lock lock( mutex_ );
+
+        for ( std::vector< std::string >::const_iterator route = routes_.begin(); route != routes_.end(); ++route )
+            result.routes.push_back( std::make_pair( *route, latency_histogram() ) );
+
+        result.routes.push_back( std::make_pair( std::string( "*" ), latency_histogram() ) );
+
+        for ( std::vector< boost::shared_ptr< shard > >::const_iterator s = shards_.begin(); s != shards_.end(); ++s )
+        {
+            const shard& current = **s;
+
+            for ( unsigned c = 0; c != metrics_snapshot::counter_count; ++c )
+                result.counters[ c ] += current.counters[ c ].load( std::memory_order_relaxed );
+
+            for ( std::size_t route = 0; route != result.routes.size(); ++route )
+                current.routes[ route ].add_to( result.routes[ route ].second );
+
+            boost::mutex::scoped_lock types_lock( const_cast< shard& >( current ).types_mutex );
+
+            for ( std::map< const char*, boost::shared_ptr< recorder > >::const_iterator type = current.types.begin();
+                type != current.types.end(); ++type )
+            {
+                type->second->add_to( result.response_types[ type->first ] );
+            }
+        }
+
+        return result;
+    }
+
+    metrics_event_log::shard& metrics_event_log::local_shard()
+    {
+        if ( current_shard.id == id_ )
+            return *static_cast< shard* >( current_shard.shard );
+
+        const boost::thread::id this_thread = boost::this_thread::get_id();
+
+        boost::mutex::scoped_lock lock( mutex_ );
+
+        std::vector< boost::shared_ptr< shard > >::const_iterator s = shards_.begin();
+        for ( ; s != shards_.end() && ( *s )->owner != this_thread; ++s )
+            ;
+
+        // a thread, that reuses the id of a terminated thread, takes over the shard of the terminated thread
+        if ( s == shards_.end() )
+            s = shards_.insert( shards_.end(), boost::shared_ptr< shard >( new shard( this_thread, routes_.size() + 1 ) ) );
+
+        current_shard.id    = id_;
+        current_shard.shard = s->get();
+
+        return **s;
+    }
+
+    void metrics_event_log::count( metrics_snapshot::counter c, boost::uint64_t value )
+    {
+        increment( local_shard().counters[ c ], value );
+    }
+
+    void metrics_event_log::response_started( async_response::log_data& response, const tools::substring& uri )
+    {
+        increment( local_shard().counters[ metrics_snapshot::responses_started ], 1 );
+
+        const std::size_t found = route_table_.find( uri );
+
+        response.time  = now();
+        response.index = found == route_table::npos ? routes_.size() : found;
+    }
+
+    void metrics_event_log::response_finished( async_response::log_data& response, const char* type, bool completed )
+    {
+        shard& local = local_shard();
+        increment( local.counters[ completed ? metrics_snapshot::responses_completed : metrics_snapshot::responses_failed ], 1 );
+
+        // error responses, that replace a failed response, are not started by the connection
+        if ( response.time == 0 )
+            return;
+
+        if ( completed )
+        {
+            const boost::uint64_t latency = now() - response.time;
+
+            local.routes[ response.index ].record( latency );
+            local.type( type ).record( latency );
+        }
+
+        response.time = 0;
+    }
+
+} // namespace server
@@ -0,0 +1,327 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+#ifndef SIOUX_SOURCE_SERVER_METRICS_H
+#define SIOUX_SOURCE_SERVER_METRICS_H
+
+#include "server/response.h"
+#include "server/route_table.h"
+#include "tools/substring.h"
+#include <boost/asio/buffer.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/utility.hpp>
+#include <atomic>
+#include <iosfwd>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace server
+{
+    /**
+     * @brief a histogram of latencies in microseconds with logarithmic buckets
+     *
+     * Every power of two is divided into 16 linear sub buckets, so a value is recorded with a relative error of
+     * less than 1/16 over the whole range from 0 to 2^40 microseconds. Larger values are recorded in the last
+     * bucket.
+     */
+    class latency_histogram
+    {
+    public:
+        static const unsigned sub_bucket_bits  = 4u;
+        static const unsigned sub_bucket_count = 1u << sub_bucket_bits;
+        static const unsigned value_bits       = 40u;
+        static const unsigned bucket_count     = sub_bucket_count * ( value_bits - sub_bucket_bits + 1 );
+
+        latency_histogram();
+
+        /**
+         * @brief the index of the bucket, the given value is counted in
+         */
+        static unsigned bucket( boost::uint64_t value );
+
+        /**
+         * @brief the largest value, that is counted in the given bucket
+         */
+        static boost::uint64_t upper_bound( unsigned bucket );
+
+        void record( boost::uint64_t value );
+
+        /**
+         * @brief adds count values to the given bucket
+         */
+        void add( unsigned bucket, boost::uint64_t count );
+
+        latency_histogram& operator+=( const latency_histogram& rhs );
+
+        /**
+         * @brief the number of recorded values
+         */
+        boost::uint64_t count() const;
+
+        /**
+         * @brief the upper bound of the bucket, that contains the value at the given quantile
+         * @pre 0 <= quantile <= 1
+         *
+         * Returns 0 for an empty histogram.
+         */
+        boost::uint64_t percentile( double quantile ) const;
+
+    private:
+        std::vector< boost::uint64_t >  counts_;
+        boost::uint64_t                 count_;
+    };
+
+    /**
+     * @brief the aggregated state of a metrics_event_log at a point in time
+     */
+    struct metrics_snapshot
+    {
+        enum counter
+        {
+            connections_created,
+            connections_destroyed,
+            responses_started,
+            responses_completed,
+            responses_failed,
+            bytes_written,
+            writes,
+            blocked_writes,
+            keep_alive_timeouts,
+            counter_count
+        };
+
+        static const char* name( counter c );
+
+        metrics_snapshot();
+
+        /**
+         * @brief the number of completed responses per second since the construction of the event log
+         */
+        double responses_per_second() const;
+
+        /**
+         * @brief prints all counters and for every route and response type, the number of responses and the p50, p99
+         *        and maximum latency in a plain text format, one value per line.
+         */
+        void print( std::ostream& out ) const;
+
+        boost::uint64_t                                             counters[ counter_count ];
+        boost::posix_time::time_duration                            elapsed;
+
+        // latencies per route; the last entry counts all requests, that did not fit any route
+        std::vector< std::pair< std::string, latency_histogram > >  routes;
+
+        // latencies per response type (async_response::name())
+        std::map< std::string, latency_histogram >                  response_types;
+    };
+
+    /**
+     * @relates metrics_snapshot
+     */
+    std::ostream& operator<<( std::ostream& out, const metrics_snapshot& snapshot );
+
+    /**
+     * @brief an EventLog, that counts events and measures response latencies at low costs
+     *
+     * Every thread updates its own set of counters and histograms without taking a lock or using a locked
+     * instruction. snapshot() aggregates the values of all threads on demand. The latency of a response is the time
+     * from event_before_response_started() to event_response_completed(). The start time and the route are stored in
+     * the response itself (async_response::event_log_data()), so both events are correlated without a shared table,
+     * even when they are logged from different threads, and nothing is left behind by a response, that is destroyed
+     * without being reported.
+     *
+     * Latencies are recorded per route and per response type. Routes have to be added with add_route() before the
+     * first event is logged; a request is counted for the first added route, that fits the request's uri in the
+     * sense of fitting_uri. Requests that fit no route are counted under the route "*".
+     *
+     * Responses, that failed, are counted in responses_failed, but their latency is not recorded. Error responses,
+     * that the connection creates without starting them, are counted, but no latency is recorded for them.
+     */
+    class metrics_event_log : boost::noncopyable
+    {
+    public:
+        metrics_event_log();
+
+        template < class Parameter >
+        explicit metrics_event_log( const Parameter& );
+
+        ~metrics_event_log();
+
+        /**
+         * @brief adds a route, latencies are recorded for
+         * @exception std::logic_error if an event was already logged
+         */
+        void add_route( const std::string& route );
+
+        /**
+         * @brief aggregates the counters and histograms of all threads
+         */
+        metrics_snapshot snapshot() const;
+
+        template < class Connection >
+        void event_connection_created( const Connection& );
+
+        template < class Connection >
+        void event_connection_destroyed( const Connection& );
+
+        template < class Connection, class Buffers, class Response >
+        void event_data_write( const Connection&, const Buffers& buffers, const Response& );
+
+        template < class Connection, class Buffers, class Response >
+        void event_writer_blocked( const Connection&, const Buffers&, const Response& );
+
+        template < class Connection, class Response >
+        void event_response_completed( const Connection&, const Response& response );
+
+        template < class Connection, class Response, class Ec >
+        void event_response_not_possible( const Connection&, const Response& response, const Ec& );
+
+        template < class Connection, class Response >
+        void event_response_not_possible( const Connection&, const Response& response );
+
+        template < class Connection >
+        void event_keep_alive_timeout( const Connection& );
+
+        template < class Connection >
+        void event_shutdown_read( const Connection& ) {}
+
+        template < class Connection >
+        void event_shutdown_close( const Connection& ) {}
+
+        template < class Connection, class Response >
+        void event_proxy_response_started( const Connection&, const Response& ) {}
+
+        template < class Connection, class Response >
+        void event_proxy_response_destroyed( const Connection&, const Response& ) {}
+
+        template < class Connection, class Response, class Socket, class Ec >
+        void event_proxy_orgin_connected( const Connection&, const Response&, const Socket*, const Ec& ) {}
+
+        template < class Connection, class Response, class Ec >
+        void event_proxy_request_written( const Connection&, const Response&, const Ec&, std::size_t ) {}
+
+        template < class Connection, class Response >
+        void event_proxy_response_restarted( const Connection&, const Response&, unsigned ) {}
+
+        template < class Connection, class Request, class ResponseHandler >
+        void event_before_response_started( const Connection&, const Request& request, const ResponseHandler& response );
+
+        template < class Connection, class Request >
+        void event_close_after_response( const Connection&, const Request& ) {}
+
+        template < class EndPoint >
+        void event_accepting_new_connection( const EndPoint&, const EndPoint& ) {}
+
+    private:
+        typedef std::atomic< boost::uint64_t > atomic_counter;
+
+        // the histogram of a single thread, only written by that thread
+        class recorder : boost::noncopyable
+        {
+        public:
+            recorder();
+
+            void record( boost::uint64_t value );
+            void add_to( latency_histogram& histogram ) const;
+
+        private:
+            atomic_counter  counts_[ latency_histogram::bucket_count ];
+        };
+
+        struct shard;
+
+        static unsigned next_id();
+
+        // microseconds of a monotonic clock
+        static boost::uint64_t now();
+
+        shard& local_shard();
+        void count( metrics_snapshot::counter c, boost::uint64_t value );
+        void response_started( async_response::log_data& response, const tools::substring& uri );
+        void response_finished( async_response::log_data& response, const char* type, bool completed );
+
+        const unsigned                                  id_;
+        const boost::uint64_t                           start_;
+        route_table                                     route_table_;
+        std::vector< std::string >                      routes_;
+
+        mutable boost::mutex                            mutex_;
+        std::vector< boost::shared_ptr< shard > >       shards_;
+    };
+
+    // implementation
+    template < class Parameter >
+    metrics_event_log::metrics_event_log( const Parameter& )
+        : id_( next_id() )
+        , start_( now() )
+        , route_table_()
+        , routes_()
+        , mutex_()
+        , shards_()
+    {
+    }
+
+    template < class Connection >
+    void metrics_event_log::event_connection_created( const Connection& )
+    {
+        count( metrics_snapshot::connections_created, 1 );
+    }
+
+    template < class Connection >
+    void metrics_event_log::event_connection_destroyed( const Connection& )
+    {
+        count( metrics_snapshot::connections_destroyed, 1 );
+    }
+
+    template < class Connection, class Buffers, class Response >
+    void metrics_event_log::event_data_write( const Connection&, const Buffers& buffers, const Response& )
+    {
+        count( metrics_snapshot::writes, 1 );
+        count( metrics_snapshot::bytes_written, boost::asio::buffer_size( buffers ) );
+    }
+
+    template < class Connection, class Buffers, class Response >
+    void metrics_event_log::event_writer_blocked( const Connection&, const Buffers&, const Response& )
+    {
+        count( metrics_snapshot::blocked_writes, 1 );
+    }
+
+    template < class Connection, class Response >
+    void metrics_event_log::event_response_completed( const Connection&, const Response& response )
+    {
+        response_finished( response.event_log_data(), response.name(), true );
+    }
+
+    template < class Connection, class Response, class Ec >
+    void metrics_event_log::event_response_not_possible( const Connection&, const Response& response, const Ec& )
+    {
+        response_finished( response.event_log_data(), response.name(), false );
+    }
+
+    template < class Connection, class Response >
+    void metrics_event_log::event_response_not_possible( const Connection&, const Response& response )
+    {
+        response_finished( response.event_log_data(), response.name(), false );
+    }
+
+    template < class Connection >
+    void metrics_event_log::event_keep_alive_timeout( const Connection& )
+    {
+        count( metrics_snapshot::keep_alive_timeouts, 1 );
+    }
+
+    template < class Connection, class Request, class ResponseHandler >
+    void metrics_event_log::event_before_response_started( const Connection&, const Request& request, const ResponseHandler& response )
+    {
+        response_started( response.event_log_data(), request.uri() );
+    }
+
+} // namespace server
+
+#endif // include guard
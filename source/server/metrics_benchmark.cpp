@@ -0,0 +1,98 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+#include "server/metrics.h"
+#include "server/log.h"
+#include "server/response.h"
+#include "http/request.h"
+#include "tools/elapse_timer.h"
+#include "tools/iterators.h"
+#include <boost/asio/buffer.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <iostream>
+#include <sstream>
+
+/*
+ * measures the costs of the events, that are logged for a single request: the start of the response, two writes
+ * and the completion of the response. The metrics_event_log is compared with the stream_event_log, that logs into
+ * a string stream.
+ */
+namespace
+{
+    const unsigned number_of_requests = 1000000u;
+
+    struct connection {};
+
+    struct response : server::async_response
+    {
+        void start() {}
+
+        const char* name() const
+        {
+            return "response";
+        }
+    };
+
+    struct stream_parameter
+    {
+        std::ostream& logstream() const
+        {
+            return out;
+        }
+
+        std::ostream& out;
+    };
+
+    template < class EventLog >
+    void measure( const char* name, EventLog& log )
+    {
+        const connection            con = connection();
+        const http::request_header  req( "GET /api/v1/users/42 HTTP/1.1\r\nHost: example.com\r\n\r\n" );
+        const char                  header[] = "HTTP/1.1 200 OK\r\nContent-Length: 5\r\n\r\n";
+
+        // responses are reused, like the memory of the responses of a real server
+        response                    responses[ 16 ];
+
+        const tools::elapse_timer time;
+
+        for ( unsigned i = 0; i != number_of_requests; ++i )
+        {
+            const response& current = responses[ i % ( sizeof responses / sizeof responses[ 0 ] ) ];
+
+            log.event_before_response_started( con, req, current );
+            log.event_data_write( con, boost::asio::buffer( header ), current );
+            log.event_data_write( con, boost::asio::buffer( "Hello", 5 ), current );
+            log.event_response_completed( con, current );
+        }
+
+        const boost::posix_time::time_duration elapsed = time.elapsed();
+
+        std::cout << name
+                  << ": elapsed: " << elapsed
+                  << "; per request: " << elapsed.total_nanoseconds() / number_of_requests << "ns"
+                  << std::endl;
+    }
+}
+
+int main()
+{
+    std::cout << "requests: " << number_of_requests << std::endl;
+
+    {
+        std::ostringstream          out;
+        const stream_parameter      parameter = { out };
+        server::stream_event_log    log( parameter );
+
+        measure( "stream_event_log", log );
+    }
+
+    {
+        server::metrics_event_log log;
+        log.add_route( "/api/v1/users" );
+        log.add_route( "/static" );
+
+        measure( "metrics_event_log", log );
+        std::cout << log.snapshot();
+    }
+}
@@ -0,0 +1,142 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+#ifndef SIOUX_SOURCE_SERVER_METRICS_RESPONSE_H
+#define SIOUX_SOURCE_SERVER_METRICS_RESPONSE_H
+
+#include "server/connection.h"
+#include "server/metrics.h"
+#include "server/response.h"
+#include "tools/asstring.h"
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/placeholders.hpp>
+#include <boost/bind.hpp>
+#include <boost/enable_shared_from_this.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/utility.hpp>
+#include <sstream>
+#include <string>
+
+namespace http
+{
+    class request_header;
+}
+
+namespace server
+{
+    /**
+     * @brief response, that reports the current metrics_snapshot of the connections trait as plain text
+     *
+     * The trait of the connection has to be derived from metrics_event_log.
+     */
+    template < class Connection >
+    class metrics_response : public async_response,
+                             public boost::enable_shared_from_this< metrics_response< Connection > >,
+                             private boost::noncopyable
+    {
+    public:
+        explicit metrics_response( const boost::shared_ptr< Connection >& connection );
+
+    private:
+        void start();
+        const char* name() const;
+
+        void handle_written(
+            const boost::system::error_code&    error,
+            std::size_t                         bytes_transferred );
+
+        std::string                             buffer_;
+        const boost::shared_ptr< Connection >   connection_;
+    };
+
+    /**
+     * @brief creates a metrics_response; to be used as action of a response_factory
+     * @relates metrics_response
+     */
+    template < class Connection >
+    boost::shared_ptr< async_response > create_metrics_response(
+        const boost::shared_ptr< Connection >&                  connection,
+        const boost::shared_ptr< const http::request_header >&  header );
+
+    /**
+     * @brief adds a handler to the given server, that responds with the current metrics
+     * @relates metrics_response
+     *
+     * @param server a server implementation with a add_action function and a trait, that is derived from
+     *        metrics_event_log
+     * @param filter the URI start used as a filter, for example "/metrics"
+     */
+    template < class Server >
+    void add_metrics_handler( Server& server, const char* filter );
+
+    // implementation
+    template < class Connection >
+    metrics_response< Connection >::metrics_response( const boost::shared_ptr< Connection >& connection )
+        : buffer_()
+        , connection_( connection )
+    {
+    }
+
+    template < class Connection >
+    void metrics_response< Connection >::start()
+    {
+        // the snapshot is taken, when the response is started, so it contains this response as started
+        std::ostringstream body;
+        body << static_cast< const metrics_event_log& >( connection_->trait() ).snapshot();
+
+        const std::string text = body.str();
+
+        buffer_ = "HTTP/1.1 200 OK\r\n"
+                  "Content-Type: text/plain\r\n"
+                  "Cache-Control: no-cache\r\n"
+                  "Content-Length: " + tools::as_string( text.size() ) + "\r\n\r\n"
+                + text;
+
+        connection_->async_write_last(
+            boost::asio::buffer( buffer_ ),
+            boost::bind(
+                &metrics_response::handle_written,
+                this->shared_from_this(),
+                boost::asio::placeholders::error,
+                boost::asio::placeholders::bytes_transferred ),
+            *this );
+    }
+
+    template < class Connection >
+    const char* metrics_response< Connection >::name() const
+    {
+        return "server::metrics_response";
+    }
+
+    template < class Connection >
+    void metrics_response< Connection >::handle_written( const boost::system::error_code& error, std::size_t )
+    {
+        if ( error )
+        {
+            connection_->response_not_possible( *this );
+        }
+        else
+        {
+            connection_->response_completed( *this );
+        }
+    }
+
+    template < class Connection >
+    boost::shared_ptr< async_response > create_metrics_response(
+        const boost::shared_ptr< Connection >&                  connection,
+        const boost::shared_ptr< const http::request_header >&  )
+    {
+        return boost::shared_ptr< async_response >( new metrics_response< Connection >( connection ) );
+    }
+
+    template < class Server >
+    void add_metrics_handler( Server& server, const char* filter )
+    {
+        typedef server::connection< typename Server::trait_t > connection_t;
+        server.add_action( filter, &create_metrics_response< connection_t > );
+    }
+
+} // namespace server
+
+#endif // include guard
@@ -0,0 +1,365 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+#include <boost/test/unit_test.hpp>
+#include "server/metrics.h"
+#include "server/metrics_response.h"
+#include "server/connection.h"
+#include "server/error.h"
+#include "server/test_response.h"
+#include "server/traits.h"
+#include "asio_mocks/test_socket.h"
+#include "asio_mocks/test_timer.h"
+#include "http/request.h"
+#include "http/test_request_texts.h"
+#include "tools/iterators.h"
+#include <boost/asio/io_service.hpp>
+#include <boost/thread/thread.hpp>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+    typedef asio_mocks::socket< const char* > socket_t;
+
+    // responds with the metrics to /metrics and with "Hello" to all other requests
+    struct response_factory
+    {
+        template < class Connection >
+        boost::shared_ptr< server::async_response > create_response(
+            const boost::shared_ptr< Connection >&                    connection,
+            const boost::shared_ptr< const http::request_header >&    header )
+        {
+            if ( header->uri() == "/metrics" )
+                return server::create_metrics_response( connection, header );
+
+            return boost::shared_ptr< server::async_response >(
+                new server::test::response< Connection >( connection, header, "Hello" ) );
+        }
+
+        template < class Connection >
+        boost::shared_ptr< server::async_response > error_response(
+            const boost::shared_ptr< Connection >& connection, http::http_error_code ec ) const
+        {
+            return boost::shared_ptr< server::async_response >( new server::error_response< Connection >( connection, ec ) );
+        }
+    };
+
+    typedef server::connection_traits< socket_t, asio_mocks::timer, response_factory, server::metrics_event_log > trait_t;
+
+    const char metrics_request[] = "GET /metrics HTTP/1.1\r\nHost: example.com\r\n\r\n";
+
+    void serve( trait_t& trait, const char* begin, const char* end, unsigned times, std::string& output )
+    {
+        boost::asio::io_service queue;
+        socket_t                socket( queue, begin, end, static_cast< std::size_t >( end - begin ), times );
+
+        server::create_connection( socket, trait );
+        queue.run();
+
+        // let the keep alive timeout expire, so that no connection outlives the queue
+        while ( asio_mocks::advance_time() )
+        {
+            queue.reset();
+            queue.run();
+        }
+
+        output = socket.output();
+    }
+}
+
+/**
+ * @test the bucket of a value is the bucket, with an upper bound that is not smaller than the value and with an upper
+ *       bound of the previous bucket, that is smaller than the value.
+ */
+BOOST_AUTO_TEST_CASE( histogram_buckets_cover_all_values )
+{
+    const boost::uint64_t values[] = { 0, 1, 15, 16, 17, 31, 32, 33, 1000, 1023, 1024, 123456789, ( boost::uint64_t( 1 ) << 40 ) - 1 };
+
+    for ( const boost::uint64_t* value = tools::begin( values ); value != tools::end( values ); ++value )
+    {
+        const unsigned bucket = server::latency_histogram::bucket( *value );
+
+        BOOST_CHECK_GE( server::latency_histogram::upper_bound( bucket ), *value );
+
+        if ( bucket != 0 )
+            BOOST_CHECK_LT( server::latency_histogram::upper_bound( bucket - 1 ), *value );
+    }
+
+    BOOST_CHECK_EQUAL( server::latency_histogram::bucket( boost::uint64_t( 1 ) << 50 ), server::latency_histogram::bucket_count - 1 );
+}
+
+/**
+ * @test the percentiles of a histogram are accurate within the relative error of a bucket
+ */
+BOOST_AUTO_TEST_CASE( histogram_percentiles )
+{
+    server::latency_histogram histogram;
+    BOOST_CHECK_EQUAL( histogram.percentile( 0.99 ), 0u );
+
+    for ( boost::uint64_t value = 1; value <= 10000; ++value )
+        histogram.record( value );
+
+    BOOST_CHECK_EQUAL( histogram.count(), 10000u );
+    BOOST_CHECK_GE( histogram.percentile( 0.5 ), 5000u );
+    BOOST_CHECK_LE( histogram.percentile( 0.5 ), 5000u + 5000u / 16 );
+    BOOST_CHECK_GE( histogram.percentile( 0.99 ), 9900u );
+    BOOST_CHECK_LE( histogram.percentile( 0.99 ), 9900u + 9900u / 16 );
+    BOOST_CHECK_GE( histogram.percentile( 1.0 ), 10000u );
+
+    server::latency_histogram other;
+    other.record( 1000000 );
+    histogram += other;
+
+    BOOST_CHECK_EQUAL( histogram.count(), 10001u );
+    BOOST_CHECK_GE( histogram.percentile( 1.0 ), 1000000u );
+}
+
+/**
+ * @test connections, responses and writes are counted and the latencies are recorded per route and per response type
+ */
+BOOST_AUTO_TEST_CASE( responses_are_counted_per_route_and_type )
+{
+    trait_t trait;
+    trait.add_route( "/" );
+    trait.add_route( "/metrics" );
+
+    std::string output;
+    serve( trait, tools::begin( http::test::simple_get_11 ), tools::end( http::test::simple_get_11 ) - 1, 10, output );
+
+    const server::metrics_snapshot snapshot = trait.snapshot();
+
+    BOOST_CHECK_EQUAL( snapshot.counters[ server::metrics_snapshot::connections_created ], 1u );
+    BOOST_CHECK_EQUAL( snapshot.counters[ server::metrics_snapshot::connections_destroyed ], 1u );
+    BOOST_CHECK_EQUAL( snapshot.counters[ server::metrics_snapshot::responses_started ], 10u );
+    BOOST_CHECK_EQUAL( snapshot.counters[ server::metrics_snapshot::responses_completed ], 10u );
+    BOOST_CHECK_EQUAL( snapshot.counters[ server::metrics_snapshot::responses_failed ], 0u );
+    BOOST_CHECK_EQUAL( snapshot.counters[ server::metrics_snapshot::bytes_written ], output.size() );
+    BOOST_CHECK_GE( snapshot.counters[ server::metrics_snapshot::writes ], 1u );
+
+    // "/" fits all uris and is added first
+    BOOST_REQUIRE_EQUAL( snapshot.routes.size(), 3u );
+    BOOST_CHECK_EQUAL( snapshot.routes[ 0 ].first, "/" );
+    BOOST_CHECK_EQUAL( snapshot.routes[ 0 ].second.count(), 10u );
+    BOOST_CHECK_EQUAL( snapshot.routes[ 1 ].second.count(), 0u );
+    BOOST_CHECK_EQUAL( snapshot.routes[ 2 ].first, "*" );
+    BOOST_CHECK_EQUAL( snapshot.routes[ 2 ].second.count(), 0u );
+
+    BOOST_REQUIRE_EQUAL( snapshot.response_types.size(), 1u );
+    BOOST_CHECK_EQUAL( snapshot.response_types.begin()->second.count(), 10u );
+}
+
+/**
+ * @test requests that fit no route are counted under "*"
+ */
+BOOST_AUTO_TEST_CASE( unrouted_requests_are_counted )
+{
+    trait_t trait;
+    trait.add_route( "/api" );
+
+    std::string output;
+    serve( trait, tools::begin( http::test::simple_get_11 ), tools::end( http::test::simple_get_11 ) - 1, 3, output );
+
+    const server::metrics_snapshot snapshot = trait.snapshot();
+
+    BOOST_REQUIRE_EQUAL( snapshot.routes.size(), 2u );
+    BOOST_CHECK_EQUAL( snapshot.routes[ 0 ].second.count(), 0u );
+    BOOST_CHECK_EQUAL( snapshot.routes[ 1 ].second.count(), 3u );
+}
+
+/**
+ * @test a connection is counted, when it is started. Connections, that are never started, like the connections, that
+ *       an acceptator constructs in advance, are not counted.
+ */
+BOOST_AUTO_TEST_CASE( only_started_connections_are_counted )
+{
+    trait_t trait;
+
+    {
+        boost::asio::io_service queue;
+        socket_t                socket( queue, tools::begin( http::test::simple_get_11 ), tools::end( http::test::simple_get_11 ) - 1 );
+
+        const boost::shared_ptr< server::connection< trait_t > > unused( new server::connection< trait_t >( socket, trait ) );
+    }
+
+    server::metrics_snapshot snapshot = trait.snapshot();
+    BOOST_CHECK_EQUAL( snapshot.counters[ server::metrics_snapshot::connections_created ], 0u );
+    BOOST_CHECK_EQUAL( snapshot.counters[ server::metrics_snapshot::connections_destroyed ], 0u );
+
+    std::string output;
+    serve( trait, tools::begin( http::test::simple_get_11 ), tools::end( http::test::simple_get_11 ) - 1, 1, output );
+
+    snapshot = trait.snapshot();
+    BOOST_CHECK_EQUAL( snapshot.counters[ server::metrics_snapshot::connections_created ], 1u );
+    BOOST_CHECK_EQUAL( snapshot.counters[ server::metrics_snapshot::connections_destroyed ], 1u );
+}
+
+/**
+ * @test the metrics response reports the counters as plain text
+ */
+BOOST_AUTO_TEST_CASE( metrics_response_reports_counters )
+{
+    trait_t trait;
+
+    std::string output;
+    serve( trait, tools::begin( metrics_request ), tools::end( metrics_request ) - 1, 1, output );
+
+    BOOST_CHECK_EQUAL( output.find( "HTTP/1.1 200 OK\r\n" ), 0u );
+    BOOST_CHECK_NE( output.find( "Content-Type: text/plain\r\n" ), std::string::npos );
+    BOOST_CHECK_NE( output.find( "\nconnections_created 1\n" ), std::string::npos );
+    BOOST_CHECK_NE( output.find( "\nresponses_started 1\n" ), std::string::npos );
+    BOOST_CHECK_NE( output.find( "\nblocked_writes 0\n" ), std::string::npos );
+    BOOST_CHECK_NE( output.find( "route_latency_us{route=\"*\",quantile=\"0.99\"}" ), std::string::npos );
+
+    const std::string::size_type body = output.find( "\r\n\r\n" );
+    BOOST_REQUIRE_NE( body, std::string::npos );
+
+    std::ostringstream length;
+    length << "Content-Length: " << output.size() - body - 4 << "\r\n";
+    BOOST_CHECK_NE( output.find( length.str() ), std::string::npos );
+}
+
+namespace {
+    struct fake_connection {};
+
+    struct fake_request
+    {
+        tools::substring uri() const
+        {
+            static const char text[] = "/a/b";
+            return tools::substring( tools::begin( text ), tools::end( text ) - 1 );
+        }
+    };
+
+    struct fake_response : server::async_response
+    {
+        void start()
+        {
+        }
+
+        const char* name() const
+        {
+            return "fake_response";
+        }
+    };
+
+    void log_responses( server::metrics_event_log& log, unsigned count )
+    {
+        const fake_connection con = fake_connection();
+        const fake_request    request = fake_request();
+
+        for ( unsigned i = 0; i != count; ++i )
+        {
+            const fake_response response = fake_response();
+
+            log.event_before_response_started( con, request, response );
+            log.event_data_write( con, boost::asio::buffer( "abc", 3 ), response );
+            log.event_response_completed( con, response );
+        }
+    }
+
+    void finish_responses( server::metrics_event_log& log, const std::vector< fake_response >& responses )
+    {
+        const fake_connection con = fake_connection();
+
+        for ( std::vector< fake_response >::const_iterator r = responses.begin(); r != responses.end(); ++r )
+            log.event_response_completed( con, *r );
+    }
+}
+
+/**
+ * @test events logged from different threads are aggregated by snapshot()
+ */
+BOOST_AUTO_TEST_CASE( events_from_several_threads_are_aggregated )
+{
+    server::metrics_event_log log;
+    log.add_route( "/a" );
+
+    const unsigned number_of_threads    = 4;
+    const unsigned responses_per_thread = 1000;
+
+    boost::thread_group threads;
+
+    for ( unsigned i = 0; i != number_of_threads; ++i )
+        threads.create_thread( boost::bind( &log_responses, boost::ref( log ), responses_per_thread ) );
+
+    threads.join_all();
+
+    const server::metrics_snapshot snapshot = log.snapshot();
+
+    BOOST_CHECK_EQUAL( snapshot.counters[ server::metrics_snapshot::responses_completed ], number_of_threads * responses_per_thread );
+    BOOST_CHECK_EQUAL( snapshot.counters[ server::metrics_snapshot::bytes_written ], 3u * number_of_threads * responses_per_thread );
+    BOOST_CHECK_EQUAL( snapshot.routes[ 0 ].second.count(), number_of_threads * responses_per_thread );
+    BOOST_CHECK_EQUAL( snapshot.response_types.count( "fake_response" ), 1u );
+}
+
+/**
+ * @test the latencies of all started responses are recorded, regardless of the number of responses in flight
+ */
+BOOST_AUTO_TEST_CASE( latencies_of_many_responses_in_flight_are_recorded )
+{
+    server::metrics_event_log log;
+    log.add_route( "/a" );
+
+    const fake_connection connections[ 2 ] = {};
+    const fake_request    request = fake_request();
+    const std::size_t     number_of_responses = 5000;
+
+    std::vector< fake_response > responses( number_of_responses );
+
+    for ( std::size_t i = 0; i != number_of_responses; ++i )
+        log.event_before_response_started( connections[ i % 2 ], request, responses[ i ] );
+
+    for ( std::size_t i = 0; i != number_of_responses; ++i )
+        log.event_response_completed( connections[ i % 2 ], responses[ i ] );
+
+    const server::metrics_snapshot snapshot = log.snapshot();
+
+    BOOST_CHECK_EQUAL( snapshot.counters[ server::metrics_snapshot::responses_completed ], number_of_responses );
+    BOOST_CHECK_EQUAL( snapshot.routes[ 0 ].second.count(), number_of_responses );
+}
+
+/**
+ * @test the latency of a response is recorded, when the response is started on one thread and finished on another
+ */
+BOOST_AUTO_TEST_CASE( responses_finished_on_an_other_thread_are_recorded )
+{
+    server::metrics_event_log log;
+    log.add_route( "/a" );
+
+    const fake_connection connection = fake_connection();
+    const fake_request    request = fake_request();
+    std::vector< fake_response > responses( 100 );
+
+    for ( std::vector< fake_response >::const_iterator r = responses.begin(); r != responses.end(); ++r )
+        log.event_before_response_started( connection, request, *r );
+
+    boost::thread finisher( boost::bind( &finish_responses, boost::ref( log ), boost::cref( responses ) ) );
+    finisher.join();
+
+    // a response, that is reported twice, is recorded only once
+    log.event_response_completed( connection, responses.front() );
+
+    const server::metrics_snapshot snapshot = log.snapshot();
+
+    BOOST_CHECK_EQUAL( snapshot.counters[ server::metrics_snapshot::responses_completed ], 101u );
+    BOOST_CHECK_EQUAL( snapshot.routes[ 0 ].second.count(), 100u );
+    BOOST_CHECK_EQUAL( snapshot.response_types.find( "fake_response" )->second.count(), 100u );
+}
+
+/**
+ * @test routes can not be added, after the first event was logged
+ */
+BOOST_AUTO_TEST_CASE( routes_can_not_be_added_after_the_first_event )
+{
+    server::metrics_event_log log;
+    log.add_route( "/a" );
+
+    log_responses( log, 1 );
+
+    BOOST_CHECK_THROW( log.add_route( "/b" ), std::logic_error );
+
+    const server::metrics_snapshot snapshot = log.snapshot();
+    BOOST_REQUIRE_EQUAL( snapshot.routes.size(), 2u );
+    BOOST_CHECK_EQUAL( snapshot.routes[ 0 ].second.count(), 1u );
+}
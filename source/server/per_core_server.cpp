@@ -0,0 +1,32 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+#include "server/per_core_server.h"
+
+#ifdef __linux__
+#   include <pthread.h>
+#   include <sched.h>
+#endif
+
+namespace server
+{
+#ifdef __linux__
+    bool pin_current_thread( unsigned core )
+    {
+        if ( core >= CPU_SETSIZE )
+            return false;
+
+        cpu_set_t cores;
+        CPU_ZERO( &cores );
+        CPU_SET( core, &cores );
+
+        return pthread_setaffinity_np( pthread_self(), sizeof cores, &cores ) == 0;
+    }
+#else
+    bool pin_current_thread( unsigned )
+    {
+        return false;
+    }
+#endif
+}
@@ -0,0 +1,315 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+#ifndef SIOUX_SOURCE_SERVER_PER_CORE_SERVER_H
+#define SIOUX_SOURCE_SERVER_PER_CORE_SERVER_H
+
+#include "server/server.h"
+#include <boost/asio/io_service.hpp>
+#include <boost/bind.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/utility.hpp>
+#include <algorithm>
+#include <vector>
+
+namespace server {
+
+    /**
+     * @brief pins the calling thread to the given cpu core
+     *
+     * Returns false, if the platform does not support pinning threads or if pinning failed.
+     */
+    bool pin_current_thread( unsigned core );
+
+    /**
+     * @brief a http server with one io_service and one thread per core
+     *
+     * Every thread runs its own io_service and is pinned to its core. For every endpoint, every core listens with
+     * its own acceptator on a shared port (SO_REUSEPORT), so the kernel distributes incomming connections over the
+     * cores. A connection stays on the core that accepted it; the handlers of a connection do not bounce between
+     * cores and the threads do not contend for a single reactor queue.
+     *
+     * The trait is shared by all cores and thus has to be thread safe, as with a basic_server running more than one
+     * thread. Work that concerns connections on other cores (like notifying the subscribers of a pubsub node) has to be
+     * passed to the io_service of the core owning the connection. post_to_all() passes one handler per core, that
+     * should then serve all affected connections of that core, instead of posting one handler per connection.
+     *
+     * Without SO_REUSEPORT, only the first core listens and all connections are handled by that core.
+     */
+    template < class Trait >
+    class per_core_server : boost::noncopyable
+    {
+    public:
+        /**
+         * @brief constructs a new server with one io_service and one thread per core
+         *
+         * If number_of_cores is 0, boost::thread::hardware_concurrency() determines the number of cores.
+         */
+        explicit per_core_server( unsigned number_of_cores = 0 );
+
+        /**
+         * @brief constructs a new server with one io_service and one thread per core
+         *
+         * If number_of_cores is 0, boost::thread::hardware_concurrency() determines the number of cores.
+         */
+        template < class TraitParameters >
+        per_core_server( unsigned number_of_cores, const TraitParameters& param );
+
+        /**
+         * @brief shuts the server down, stops all io_services and joins all threads
+         */
+        ~per_core_server();
+
+        /**
+         * @brief adds a new tcp::endpoint where every core will listen for incomming connections
+         */
+        void add_listener( const boost::asio::ip::tcp::endpoint& );
+
+        /**
+         * a function taking a connection and a request_header, returning a async_response
+         */
+        typedef boost::function< boost::shared_ptr< async_response > (
+            const boost::shared_ptr< connection< Trait > >&,
+            const boost::shared_ptr<const http::request_header>& ) > action_t;
+
+        /**
+         * @brief adds a new route for a user defined action
+         */
+        void add_action( const char* route, const action_t& action );
+
+        /**
+         * @brief stops accepting incomming connections, close all listen ports
+         *
+         * The threads return, when all connections are closed.
+         */
+        void shut_down();
+
+        /**
+         * @brief joins all threads
+         */
+        void join();
+
+        /**
+         * @brief the sum of the counters of all listen ports of all cores
+         */
+        accept_statistics accept_counters() const;
+
+        /**
+         * @brief the number of cores, and thus io_services, used by this server
+         */
+        unsigned number_of_cores() const;
+
+        /**
+         * @brief the io_service of the given core
+         */
+        boost::asio::io_service& queue( unsigned core );
+
+        /**
+         * @brief executes the handler on the given core
+         *
+         * When called from the thread of that core, the handler is invoked immediately.
+         */
+        template < class Handler >
+        void dispatch( unsigned core, Handler handler );
+
+        /**
+         * @brief posts a copy of the handler to every core
+         */
+        template < class Handler >
+        void post_to_all( const Handler& handler );
+
+        typedef Trait                           trait_t;
+        trait_t& trait();
+
+        typedef connection< Trait >             connection_t;
+    private:
+        typedef boost::asio::ip::tcp::socket    socket_t;
+        typedef acceptator<trait_t, socket_t>   acceptor_t;
+        typedef std::vector< boost::shared_ptr< acceptor_t > >                  acceptor_list_t;
+        typedef std::vector< boost::shared_ptr< boost::asio::io_service > >     queue_list_t;
+        typedef std::vector< boost::shared_ptr< boost::asio::io_service::work > > work_list_t;
+
+        void start_threads( unsigned number_of_cores );
+        void run( unsigned core );
+
+        trait_t                                     trait_;
+        queue_list_t                                queues_;
+        work_list_t                                 work_;
+        boost::thread_group                         thread_herd_;
+
+        // the acceptators of every core
+        std::vector< acceptor_list_t >              acceptors_;
+        bool                                        shutting_down_;
+    };
+
+    ///////////////////////
+    // implementation
+    template < class Trait >
+    per_core_server< Trait >::per_core_server( unsigned number_of_cores )
+        : trait_()
+        , queues_()
+        , work_()
+        , thread_herd_()
+        , acceptors_()
+        , shutting_down_( false )
+    {
+        start_threads( number_of_cores );
+    }
+
+    template < class Trait >
+    template < class TraitParameters >
+    per_core_server< Trait >::per_core_server( unsigned number_of_cores, const TraitParameters& param )
+        : trait_( param )
+        , queues_()
+        , work_()
+        , thread_herd_()
+        , acceptors_()
+        , shutting_down_( false )
+    {
+        start_threads( number_of_cores );
+    }
+
+    template < class Trait >
+    per_core_server< Trait >::~per_core_server()
+    {
+        if ( !shutting_down_ )
+            shut_down();
+
+        for ( typename queue_list_t::const_iterator queue = queues_.begin(); queue != queues_.end(); ++queue )
+            ( *queue )->stop();
+
+        join();
+    }
+
+    template < class Trait >
+    void per_core_server< Trait >::add_listener( const boost::asio::ip::tcp::endpoint& ep )
+    {
+        assert( !shutting_down_ );
+
+#ifdef SO_REUSEPORT
+        const unsigned listening_cores = number_of_cores();
+#else
+        const unsigned listening_cores = 1u;
+#endif
+
+        for ( unsigned core = 0; core != listening_cores; ++core )
+        {
+            boost::shared_ptr< acceptor_t > accept( new acceptor_t( *queues_[ core ], trait_, ep, listening_cores != 1u ) );
+            acceptors_[ core ].push_back( accept );
+            accept->start();
+        }
+    }
+
+    template < class Trait >
+    void per_core_server< Trait >::add_action( const char* route, const action_t& action )
+    {
+        assert( !shutting_down_ );
+        trait_.add_action( route, action );
+    }
+
+    template < class Trait >
+    void per_core_server< Trait >::shut_down()
+    {
+        shutting_down_ = true;
+
+        // an acceptator must only be used from the thread of its core
+        for ( unsigned core = 0; core != number_of_cores(); ++core )
+        {
+            for ( typename acceptor_list_t::const_iterator acc = acceptors_[ core ].begin(); acc != acceptors_[ core ].end(); ++acc )
+                queues_[ core ]->post( boost::bind( &acceptor_t::shut_down, *acc ) );
+        }
+
+        work_.clear();
+        trait_.shutdown();
+    }
+
+    template < class Trait >
+    void per_core_server< Trait >::join()
+    {
+        thread_herd_.join_all();
+    }
+
+    template < class Trait >
+    accept_statistics per_core_server< Trait >::accept_counters() const
+    {
+        accept_statistics result;
+
+        for ( typename std::vector< acceptor_list_t >::const_iterator core = acceptors_.begin(); core != acceptors_.end(); ++core )
+        {
+            for ( typename acceptor_list_t::const_iterator acc = core->begin(); acc != core->end(); ++acc )
+                result += ( *acc )->statistics();
+        }
+
+        return result;
+    }
+
+    template < class Trait >
+    unsigned per_core_server< Trait >::number_of_cores() const
+    {
+        return static_cast< unsigned >( queues_.size() );
+    }
+
+    template < class Trait >
+    boost::asio::io_service& per_core_server< Trait >::queue( unsigned core )
+    {
+        assert( core < queues_.size() );
+        return *queues_[ core ];
+    }
+
+    template < class Trait >
+    template < class Handler >
+    void per_core_server< Trait >::dispatch( unsigned core, Handler handler )
+    {
+        queue( core ).dispatch( handler );
+    }
+
+    template < class Trait >
+    template < class Handler >
+    void per_core_server< Trait >::post_to_all( const Handler& handler )
+    {
+        for ( typename queue_list_t::const_iterator queue = queues_.begin(); queue != queues_.end(); ++queue )
+            ( *queue )->post( handler );
+    }
+
+    template < class Trait >
+    typename per_core_server< Trait >::trait_t& per_core_server< Trait >::trait()
+    {
+        return trait_;
+    }
+
+    template < class Trait >
+    void per_core_server< Trait >::start_threads( unsigned number_of_cores )
+    {
+        if ( number_of_cores == 0 )
+            number_of_cores = std::max( boost::thread::hardware_concurrency(), 1u );
+
+        acceptors_.resize( number_of_cores );
+
+        for ( unsigned core = 0; core != number_of_cores; ++core )
+        {
+            // every io_service is run by exactly one thread
+            queues_.push_back( boost::shared_ptr< boost::asio::io_service >( new boost::asio::io_service( 1 ) ) );
+            work_.push_back( boost::shared_ptr< boost::asio::io_service::work >(
+                new boost::asio::io_service::work( *queues_.back() ) ) );
+        }
+
+        for ( unsigned core = 0; core != number_of_cores; ++core )
+            thread_herd_.create_thread( boost::bind( &per_core_server::run, this, core ) );
+    }
+
+    template < class Trait >
+    void per_core_server< Trait >::run( unsigned core )
+    {
+        const unsigned hardware_cores = boost::thread::hardware_concurrency();
+
+        if ( hardware_cores != 0 )
+            pin_current_thread( core % hardware_cores );
+
+        queues_[ core ]->run();
+    }
+
+} // namespace server
+
+#endif // include guard
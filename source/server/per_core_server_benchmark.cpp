@@ -0,0 +1,171 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+#include "server/server.h"
+#include "server/per_core_server.h"
+#include "server/test_response.h"
+#include "tools/elapse_timer.h"
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/asio/write.hpp>
+#include <boost/bind.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/thread/thread.hpp>
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/*
+ * compares the request throughput of a basic_server, running one io_service with one thread per core, with a
+ * per_core_server, running one io_service per core. Clients send keep alive requests over the loopback interface
+ * and wait for every response, before sending the next request.
+ *
+ * In addition, the accept rate of a per_core_server is measured, when a lot of clients connect at once, with
+ * different numbers of pending accepts per listen port.
+ *
+ * The only results so far come from a single core machine, where both servers run a single thread and the
+ * comparison shows only the overhead of a shared io_service (about 75500 versus 97600 requests/s). Whether a
+ * per_core_server scales better with the number of cores, than a basic_server, is still outstanding and has to be
+ * measured on a multi core machine.
+ */
+namespace
+{
+    const unsigned short    shared_port             = 38080u;
+    const unsigned short    per_core_port           = 38081u;
+    const unsigned          clients_per_core        = 4u;
+    const unsigned          requests_per_client     = 5000u;
+    const unsigned short    storm_port              = 38082u;
+    const unsigned          storm_clients           = 8u;
+    const unsigned          connections_per_client  = 100u;
+
+    const std::string request  = "GET /hello HTTP/1.1\r\nHost: localhost\r\n\r\n";
+    const std::string response = "HTTP/1.1 200 OK\r\nContent-Length: 5\r\n\r\nHello";
+
+    typedef server::http_server::trait_t        trait_t;
+    typedef server::http_server::connection_t   connection_t;
+
+    boost::shared_ptr< server::async_response > hello(
+        const boost::shared_ptr< connection_t >&                    connection,
+        const boost::shared_ptr< const http::request_header >&      header )
+    {
+        return boost::shared_ptr< server::async_response >(
+            new server::test::response< connection_t >( connection, header, response ) );
+    }
+
+    void client( unsigned short port )
+    {
+        boost::asio::io_service         queue;
+        boost::asio::ip::tcp::socket    socket( queue );
+        socket.connect( boost::asio::ip::tcp::endpoint( boost::asio::ip::address_v4::loopback(), port ) );
+
+        std::vector< char > buffer( response.size() );
+
+        for ( unsigned i = 0; i != requests_per_client; ++i )
+        {
+            boost::asio::write( socket, boost::asio::buffer( request ) );
+            boost::asio::read( socket, boost::asio::buffer( buffer ) );
+        }
+    }
+
+    void measure( const char* name, unsigned short port, unsigned cores )
+    {
+        const unsigned clients = clients_per_core * cores;
+        const tools::elapse_timer time;
+
+        boost::thread_group client_herd;
+        for ( unsigned c = 0; c != clients; ++c )
+            client_herd.create_thread( boost::bind( &client, port ) );
+
+        client_herd.join_all();
+
+        const boost::posix_time::time_duration elapsed = time.elapsed();
+
+        std::cout << name
+                  << ": elapsed: " << elapsed
+                  << "; requests per second: "
+                  << static_cast< double >( clients * requests_per_client ) * 1000000 / elapsed.total_microseconds()
+                  << std::endl;
+    }
+
+    void connect_many( unsigned short port )
+    {
+        typedef boost::shared_ptr< boost::asio::ip::tcp::socket > socket_ptr;
+
+        boost::asio::io_service     queue;
+        std::vector< socket_ptr >   sockets;
+
+        for ( unsigned i = 0; i != connections_per_client; ++i )
+        {
+            sockets.push_back( socket_ptr( new boost::asio::ip::tcp::socket( queue ) ) );
+            sockets.back()->connect( boost::asio::ip::tcp::endpoint( boost::asio::ip::address_v4::loopback(), port ) );
+        }
+    }
+
+    void measure_connection_storm( unsigned cores, unsigned pending_accepts )
+    {
+        server::per_core_server< trait_t > server( cores );
+        server.trait().pending_accepts( pending_accepts );
+        server.add_action( "/", &hello );
+        server.add_listener( boost::asio::ip::tcp::endpoint( boost::asio::ip::address_v4::loopback(), storm_port ) );
+
+        const boost::uint64_t connections = storm_clients * connections_per_client;
+        const tools::elapse_timer time;
+
+        boost::thread_group client_herd;
+        for ( unsigned c = 0; c != storm_clients; ++c )
+            client_herd.create_thread( boost::bind( &connect_many, storm_port ) );
+
+        while ( server.accept_counters().accepted_connections < connections )
+            boost::this_thread::yield();
+
+        const boost::posix_time::time_duration  elapsed  = time.elapsed();
+        const server::accept_statistics         counters = server.accept_counters();
+
+        client_herd.join_all();
+
+        std::cout << "pending accepts " << pending_accepts
+                  << ": elapsed: " << elapsed
+                  << "; accepts per second: "
+                  << static_cast< double >( counters.accepted_connections ) * 1000000 / elapsed.total_microseconds()
+                  << "; mean accept latency: "
+                  << counters.total_accept_latency.total_microseconds() / static_cast< double >( counters.accepted_connections ) << "us"
+                  << "; max accept latency: " << counters.max_accept_latency.total_microseconds() << "us"
+                  << std::endl;
+    }
+}
+
+int main()
+{
+    const unsigned cores = std::max( boost::thread::hardware_concurrency(), 1u );
+    std::cout << "cores: " << cores << "; clients: " << clients_per_core * cores
+              << "; requests per client: " << requests_per_client << std::endl;
+
+    {
+        boost::asio::io_service queue;
+        server::http_server     server( queue, cores );
+        server.add_action( "/", &hello );
+        server.add_listener( boost::asio::ip::tcp::endpoint( boost::asio::ip::address_v4::loopback(), shared_port ) );
+
+        measure( "shared queue", shared_port, cores );
+
+        server.shut_down();
+        queue.stop();
+        server.join();
+    }
+
+    {
+        server::per_core_server< trait_t > server( cores );
+        server.add_action( "/", &hello );
+        server.add_listener( boost::asio::ip::tcp::endpoint( boost::asio::ip::address_v4::loopback(), per_core_port ) );
+
+        measure( "queue per core", per_core_port, cores );
+    }
+
+    std::cout << "connecting clients: " << storm_clients * connections_per_client << std::endl;
+
+    measure_connection_storm( cores, 1u );
+    measure_connection_storm( cores, 16u );
+}
@@ -0,0 +1,129 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+#include <boost/test/unit_test.hpp>
+#include "server/per_core_server.h"
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/bind.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <set>
+#include <vector>
+
+namespace {
+    typedef server::per_core_server< server::http_server::trait_t > server_t;
+
+    struct thread_log
+    {
+        thread_log() : mutex(), condition(), threads(), calls( 0 ) {}
+
+        void record()
+        {
+            boost::mutex::scoped_lock lock( mutex );
+            threads.insert( boost::this_thread::get_id() );
+            ++calls;
+            condition.notify_all();
+        }
+
+        void wait_for_calls( unsigned expected_calls )
+        {
+            boost::mutex::scoped_lock lock( mutex );
+
+            while ( calls < expected_calls )
+                condition.wait( lock );
+        }
+
+        boost::mutex                        mutex;
+        boost::condition_variable           condition;
+        std::set< boost::thread::id >       threads;
+        unsigned                            calls;
+    };
+
+    void dispatch_to( server_t& server, unsigned core, thread_log& log, bool& invoked_immediately )
+    {
+        server.dispatch( core, boost::bind( &thread_log::record, &log ) );
+
+        {
+            boost::mutex::scoped_lock lock( log.mutex );
+            invoked_immediately = log.calls == 2;
+        }
+
+        log.record();
+    }
+}
+
+/**
+ * @test every core runs its own thread
+ */
+BOOST_AUTO_TEST_CASE( handlers_posted_to_all_cores_run_on_different_threads )
+{
+    server_t server( 3u );
+    BOOST_CHECK_EQUAL( server.number_of_cores(), 3u );
+
+    thread_log log;
+    server.post_to_all( boost::bind( &thread_log::record, &log ) );
+    log.wait_for_calls( 3u );
+
+    BOOST_CHECK_EQUAL( log.threads.size(), 3u );
+    BOOST_CHECK( log.threads.count( boost::this_thread::get_id() ) == 0 );
+}
+
+/**
+ * @test a handler dispatched from the thread of the target core is executed immediately
+ */
+BOOST_AUTO_TEST_CASE( dispatch_on_the_same_core_executes_immediately )
+{
+    server_t server( 2u );
+
+    thread_log  log;
+    bool        invoked_immediately = false;
+
+    log.record();
+    server.dispatch( 1u, boost::bind( &dispatch_to, boost::ref( server ), 1u, boost::ref( log ), boost::ref( invoked_immediately ) ) );
+    log.wait_for_calls( 3u );
+
+    BOOST_CHECK( invoked_immediately );
+    BOOST_CHECK_EQUAL( log.threads.size(), 2u );
+}
+
+/**
+ * @test the server uses one core per hardware thread by default
+ */
+BOOST_AUTO_TEST_CASE( one_core_per_hardware_thread_by_default )
+{
+    server_t server;
+    BOOST_CHECK_EQUAL( server.number_of_cores(), std::max( boost::thread::hardware_concurrency(), 1u ) );
+}
+
+/**
+ * @test connections accepted with more than one pending accept per listen port are counted
+ */
+BOOST_AUTO_TEST_CASE( accepted_connections_are_counted )
+{
+    server_t server( 2u );
+    server.trait().pending_accepts( 4u );
+
+    const boost::asio::ip::tcp::endpoint endpoint( boost::asio::ip::address_v4::loopback(), 38090u );
+    server.add_listener( endpoint );
+
+    boost::asio::io_service client_queue;
+    std::vector< boost::shared_ptr< boost::asio::ip::tcp::socket > > clients;
+
+    for ( unsigned i = 0; i != 10u; ++i )
+    {
+        clients.push_back( boost::shared_ptr< boost::asio::ip::tcp::socket >( new boost::asio::ip::tcp::socket( client_queue ) ) );
+        clients.back()->connect( endpoint );
+    }
+
+    const boost::posix_time::ptime timeout = boost::posix_time::microsec_clock::universal_time() + boost::posix_time::seconds( 5 );
+
+    while ( server.accept_counters().accepted_connections != 10u && boost::posix_time::microsec_clock::universal_time() < timeout )
+        boost::this_thread::sleep( boost::posix_time::millisec( 1 ) );
+
+    const server::accept_statistics counters = server.accept_counters();
+    BOOST_CHECK_EQUAL( counters.accepted_connections, 10u );
+    BOOST_CHECK_EQUAL( counters.failed_accepts, 0u );
+    BOOST_CHECK( counters.max_accept_latency <= counters.total_accept_latency );
+}
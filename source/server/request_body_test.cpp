@@ -29,11 +29,14 @@ namespace
 	class read_body : public server::async_response, public boost::enable_shared_from_this< read_body< Connection > >
 	{
 	public:
-		read_body( const http::request_header& request, const boost::shared_ptr< Connection >& connection )
+		read_body( const http::request_header& request, const boost::shared_ptr< Connection >& connection,
+		           bool read_body_buffers )
 			: connection_( connection )
 			, body_read_( false )
 			, has_body_( request.body_expected() )
 		    , has_error_( false )
+		    , read_body_buffers_( read_body_buffers )
+		    , handler_calls_( 0 )
 		{
 		}
 
@@ -76,6 +79,7 @@ namespace
 		  	  	 	    std::size_t 					 bytes_read_and_decoded )
 		{
 		    assert( !body_read_ );
+		    ++handler_calls_;
 
 			if ( error )
 			{
@@ -93,6 +97,39 @@ namespace
 			}
 		}
 
+		void body_buffers_read( const boost::system::error_code& error, const http::body_buffers& buffers )
+		{
+		    assert( !body_read_ );
+		    ++handler_calls_;
+
+		    if ( error )
+		    {
+		        connection_->response_completed( *this );
+		        has_error_ = true;
+		        return;
+		    }
+
+		    for ( http::body_buffers::const_iterator b = buffers.begin(); b != buffers.end(); ++b )
+		    {
+		        const char* const buffer = boost::asio::buffer_cast< const char* >( *b );
+		        body_.insert( body_.end(), buffer, buffer + boost::asio::buffer_size( *b ) );
+		    }
+
+		    if ( buffers.empty() )
+		    {
+		        connection_->response_completed( *this );
+		        body_read_ = true;
+		    }
+		}
+
+		/**
+		 * @brief number of calls to the body read handler
+		 */
+		unsigned handler_calls() const
+		{
+		    return handler_calls_;
+		}
+
 		bool body_completed() const
 		{
 			return body_read_;
@@ -118,6 +155,11 @@ namespace
         	{
         		connection_->response_completed( *this );
         	}
+        	else if ( read_body_buffers_ )
+        	{
+        		connection_->async_read_body_buffers(
+        				boost::bind( &read_body::body_buffers_read, this->shared_from_this(), _1, _2 ) );
+        	}
         	else
         	{
         		connection_->async_read_body(
@@ -135,6 +177,8 @@ namespace
         bool							has_body_;
         std::vector< char > 			body_;
         bool							has_error_;
+        const bool                      read_body_buffers_;
+        unsigned                        handler_calls_;
 	};
 
 	typedef std::vector< boost::shared_ptr< server::async_response > > response_list_t;
@@ -146,12 +190,14 @@ namespace
 	{
 	    response_factory()
 	    	: error_count_( 0 )
+	        , read_body_buffers_( false )
 	    {
 	    }
 
 	    template < class T >
 	    explicit response_factory( const T& )
 			: error_count_( 0 )
+	        , read_body_buffers_( false )
 		{
 		}
 
@@ -162,7 +208,7 @@ namespace
 	    {
 	    	if ( header->state() == http::message::ok )
 	    	{
-				const boost::shared_ptr< read_body< Connection > > new_response(new read_body< Connection >( *header, connection ) );
+				const boost::shared_ptr< read_body< Connection > > new_response(new read_body< Connection >( *header, connection, read_body_buffers_ ) );
 				read_bodies_.push_back( new_response );
 
 				return boost::shared_ptr< server::async_response >( new_response );
@@ -183,6 +229,8 @@ namespace
 
 	    response_list_t		read_bodies_;
 	    int 				error_count_;
+	    // if true, the bodies are read with async_read_body_buffers()
+	    bool                read_body_buffers_;
 	};
 
 	typedef asio_mocks::socket<const char*>                         socket_t;
@@ -289,6 +337,72 @@ BOOST_AUTO_TEST_CASE( post_with_small_chunked_encoded_message_body )
 	BOOST_CHECK( get_body( trait.read_bodies_.front() ).equal( body ) );
 }
 
+/**
+ * @class server::connection
+ * @test all chunks of a body, that are received with one read are passed to the handler at once
+ */
+BOOST_AUTO_TEST_CASE( post_with_many_small_chunks_read_as_body_buffers )
+{
+    boost::minstd_rand      random;
+    const char body[] = "Es war einmal ein Baer der schwamm so weit im Meer.";
+
+    static const char header[] =
+        "POST / HTTP/1.1\r\n"
+        "Host: web-sniffer.net\r\n"
+        "Transfer-Encoding: chunked\r\n"
+        "\r\n";
+
+    std::vector< char > message = http::test::random_chunk(
+            random, std::vector< char >( tools::begin( body ), tools::end( body ) - 1 ), 3u );
+    message.insert( message.begin(), tools::begin( header ), tools::end( header ) -1 );
+
+	trait_t					trait;
+	trait.read_body_buffers_ = true;
+
+	boost::asio::io_service	queue;
+
+	asio_mocks::read_plan plan;
+	plan << asio_mocks::read( &message[0], &message[0] + message.size() )
+	     << asio_mocks::disconnect_read();
+
+	socket_t				socket( queue, plan );
+
+	boost::shared_ptr< connection_t > connection( new connection_t( socket, trait ) );
+	connection->start();
+
+	tools::run( queue );
+	BOOST_REQUIRE_EQUAL( trait.read_bodies_.size(), 1u );
+	BOOST_CHECK( get_body( trait.read_bodies_.front() ).equal( body ) );
+
+	// one call with all chunks and one to signal the end of the body
+	BOOST_CHECK_EQUAL( get_body( trait.read_bodies_.front() ).handler_calls(), 2u );
+}
+
+/**
+ * @class server::connection
+ * @test a big chunked encoded body, read with a small body buffer, is completely delivered as body buffers
+ */
+BOOST_AUTO_TEST_CASE( post_with_big_chunked_encoded_message_body_read_as_body_buffers )
+{
+    boost::minstd_rand          random;
+    const std::vector< char >   body = http::test::random_body( random, 50 * 1024 );
+    const std::vector< char >   message = build_randomly_chunked_post_request( random, body.begin(), body.end(), 100u );
+
+    trait_t					trait;
+    trait.read_body_buffers_ = true;
+    trait.body_buffer_size( 1000u );
+
+    boost::asio::io_service	queue;
+    socket_t				socket( queue, &message[0], &message[0] + message.size(), random, 1, 2000 );
+
+    boost::shared_ptr< connection_t > connection( new connection_t( socket, trait ) );
+    connection->start();
+
+    tools::run( queue );
+    BOOST_REQUIRE_EQUAL( trait.read_bodies_.size(), 1u );
+    BOOST_CHECK( get_body( trait.read_bodies_.front() ).equal( body ) );
+}
+
 /**
  * @class server::connection
  * @test check that an empty chunked body get correctly decoded.
@@ -400,6 +514,64 @@ BOOST_AUTO_TEST_CASE( post_with_multiple_small_content_length_message_body_read_
 	}
 }
 
+/**
+ * @class server::connection
+ * @test a big chunked encoded body, read with a body buffer, that is much smaller than the chunks
+ */
+BOOST_AUTO_TEST_CASE( post_with_big_chunked_encoded_message_body_and_small_body_buffer )
+{
+    boost::minstd_rand          random;
+    const std::vector< char >   body = http::test::random_body( random, 50 * 1024 );
+    const std::vector< char >   message = build_randomly_chunked_post_request( random, body.begin(), body.end(), 1000u );
+
+    trait_t					trait;
+    trait.body_buffer_size( 17u );
+
+    boost::asio::io_service	queue;
+    socket_t				socket( queue, &message[0], &message[0] + message.size(), random, 1, 2000 );
+
+    boost::shared_ptr< connection_t > connection( new connection_t( socket, trait ) );
+    connection->start();
+
+    tools::run( queue );
+    BOOST_REQUIRE_EQUAL( trait.read_bodies_.size(), 1u );
+    BOOST_CHECK( get_body( trait.read_bodies_.front() ).equal( body ) );
+}
+
+/**
+ * @class server::connection
+ * @test multiple request bodies, that are decoded directly from the request header buffer, followed by the next
+ *       request header
+ */
+BOOST_AUTO_TEST_CASE( post_with_multiple_bodies_and_tiny_body_buffer )
+{
+	static const std::size_t	number_of_bodies = 100;
+
+	std::vector< char > big_message;
+	for ( int i = 0; i != number_of_bodies; ++i )
+		big_message.insert( big_message.end(),
+				tools::begin( http::test::simple_post ), tools::end( http::test::simple_post ) -1 );
+
+	trait_t					trait;
+	trait.body_buffer_size( 1u );
+
+	boost::asio::io_service	queue;
+	socket_t				socket( queue, &big_message[0], &big_message[0] + big_message.size(), 100u );
+
+	boost::shared_ptr< connection_t > connection( new connection_t( socket, trait ) );
+	connection->start();
+
+	tools::run( queue );
+	BOOST_CHECK_EQUAL( trait.read_bodies_.size(), number_of_bodies );
+
+	for ( response_list_t::const_iterator response = trait.read_bodies_.begin();
+			response != trait.read_bodies_.end(); ++response )
+	{
+		BOOST_REQUIRE( get_body( *response ).equal(
+			"url=http%3A%2F%2Fasdasdasd&submit=Submit&http=1.1&gzip=yes&type=GET&uak=0" ) );
+	}
+}
+
 /**
  * @class server::connection
  * @test mixing requests with and without body should result in correct delivering of the message headers and bodies
@@ -622,3 +794,43 @@ BOOST_AUTO_TEST_CASE( empty_body_should_result_in_callback_beeing_called )
     BOOST_CHECK( !get_body( trait.read_bodies_.front() ).has_error() );
     BOOST_CHECK_EQUAL( 0, get_body( trait.read_bodies_.front() ).body_size() );
 }
+
+/**
+ * @class server::connection
+ * @test pipelined requests, that are read together with the end of a body, are handled, even when the configured
+ *       body buffer is larger than a request header.
+ */
+BOOST_AUTO_TEST_CASE( pipelined_requests_behind_a_body_with_small_max_header_size )
+{
+    static const std::size_t    number_of_gets = 50;
+    static const std::size_t    body_size      = 1000;
+
+    boost::minstd_rand          random;
+    const std::vector< char >   body = http::test::random_body( random, body_size );
+
+    static const char header[] =
+        "POST / HTTP/1.1\r\n"
+        "Host: web-sniffer.net\r\n"
+        "Content-Length: 1000\r\n"
+        "\r\n";
+
+    std::vector< char > message( tools::begin( header ), tools::end( header ) - 1 );
+    message.insert( message.end(), body.begin(), body.end() );
+
+    for ( std::size_t i = 0; i != number_of_gets; ++i )
+        message.insert( message.end(), tools::begin( http::test::simple_get_11 ), tools::end( http::test::simple_get_11 ) - 1 );
+
+    trait_t                 trait;
+    trait.max_header_size( 1024u );
+
+    boost::asio::io_service queue;
+    socket_t                socket( queue, &message[0], &message[0] + message.size() );
+
+    boost::shared_ptr< connection_t > connection( new connection_t( socket, trait ) );
+    connection->start();
+
+    tools::run( queue );
+    BOOST_REQUIRE_EQUAL( trait.read_bodies_.size(), number_of_gets + 1 );
+    BOOST_CHECK( get_body( trait.read_bodies_.front() ).equal( body ) );
+    BOOST_CHECK_EQUAL( 0, trait.error_count_ );
+}
@@ -8,6 +8,7 @@ namespace server {
 
     async_response::async_response()
         : hurryed_(false)
+        , log_data_()
     {
     }
 
@@ -29,6 +30,11 @@ namespace server {
     {
     }
 
+    async_response::log_data& async_response::event_log_data() const
+    {
+        return log_data_;
+    }
+
 } // namespace server 
 
 
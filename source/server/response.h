@@ -6,7 +6,9 @@
 #define SIOUX_SOURCE_SERVER_RESPONSE_H
 
 #include "http/http.h"
+#include <boost/cstdint.hpp>
 #include <cassert>
+#include <cstddef>
 
 namespace server
 {
@@ -141,8 +143,31 @@ namespace server
          * @brief returns a type name, to indicate what an instance is responding to.
          */
         virtual const char* name() const = 0;
+
+        /**
+         * @brief data, an event log can attach to a response
+         *
+         * Written in event_before_response_started() and read back, when the response is reported as completed or
+         * as not possible, so that an event log can correlate both events without looking up the response in a
+         * shared table. The metrics_event_log stores the start time and the route of the response here.
+         */
+        struct log_data
+        {
+            log_data() : time( 0 ), index( 0 ) {}
+
+            boost::uint64_t time;
+            std::size_t     index;
+        };
+
+        /**
+         * @brief the data attached to this response by the event log
+         *
+         * Event logs get const references to the responses, so the data is modifiable through a const response.
+         */
+        log_data& event_log_data() const;
     private:
-        bool hurryed_;
+        bool                hurryed_;
+        mutable log_data    log_data_;
     };
 } // namespace server
 
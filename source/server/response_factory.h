@@ -8,7 +8,7 @@
 #include "http/http.h"
 #include "http/request.h"
 #include "server/error.h"
-#include "server/fitting_uri.h"
+#include "server/route_table.h"
 #include "tools/substring.h"
 #include <boost/utility.hpp>
 #include <boost/shared_ptr.hpp>
@@ -85,9 +85,11 @@ namespace server
             }
         };
 
-        typedef std::vector< std::pair< std::string, boost::shared_ptr< action_holder_base > > > action_list_t;
+        typedef std::vector< boost::shared_ptr< action_holder_base > > action_list_t;
 
+        // the index of the route is the index of the action in actions_
         action_list_t actions_;
+        route_table   routes_;
 
     };
 
@@ -115,11 +117,10 @@ namespace server
         if ( header->state() != http::message::ok )
             return error_response( connection, http::http_bad_request );
 
-        const typename action_list_t::const_iterator action =
-            std::find_if( actions_.begin(), actions_.end(), fitting_uri( header->uri() ) );
+        const std::size_t action = routes_.find( header->uri() );
 
-        if ( action != actions_.end() )
-            return (*action->second)( connection, header );
+        if ( action != route_table::npos )
+            return (*actions_[ action ])( connection, header );
 
         return error_response( connection, http::http_not_found );
     }
@@ -136,16 +137,15 @@ namespace server
     template < class Action >
     void response_factory< Socket >::add_action( const std::string& route, const Action& action )
     {
-        actions_.push_back(
-            std::make_pair(
-                route,
-                boost::shared_ptr< action_holder_base >( new action_holder< Action >( action) ) ) );
+        routes_.add( route, actions_.size() );
+        actions_.push_back( boost::shared_ptr< action_holder_base >( new action_holder< Action >( action) ) );
     }
 
     template < class Socket >
     void response_factory< Socket >::shutdown()
     {
         actions_.clear();
+        routes_.clear();
     }
 
 } // namespace server
@@ -202,6 +202,84 @@ BOOST_AUTO_TEST_CASE(non_fatal_error_while_responding)
     BOOST_CHECK_EQUAL( 1, connection.use_count() );
 }
 
+namespace {
+
+    void count_write(unsigned& writes, const boost::asio::const_buffer&)
+    {
+        ++writes;
+    }
+}
+
+/**
+ * @test the responses to pipelined requests, that are blocked by the first response, are written together with the
+ *       last write of the first response.
+ */
+BOOST_AUTO_TEST_CASE(blocked_responses_are_written_with_a_single_write)
+{
+    typedef asio_mocks::socket<const char*>                         socket_t;
+    typedef traits< hello_world_response_factory >                  trait_t;
+    typedef server::connection<trait_t>                             connection_t;
+
+    boost::asio::io_service         queue;
+    socket_t                        socket(queue, begin(simple_get_11), end(simple_get_11), 0, 3);
+    trait_t                         trait;
+    boost::shared_ptr<connection_t> connection = server::create_connection(socket, trait);
+
+    unsigned writes = 0;
+    socket.write_callback(boost::bind(&count_write, boost::ref(writes), _1));
+
+    tools::run(queue);
+
+    std::vector<boost::shared_ptr<server::async_response> > resp = trait.responses();
+    BOOST_REQUIRE_EQUAL(3u, resp.size());
+    trait.reset_responses();
+
+    simulate_incomming_data(resp[2]);
+    simulate_incomming_data(resp[1]);
+    simulate_incomming_data(resp[0]);
+    resp.clear();
+
+    tools::run(queue);
+
+    BOOST_CHECK_EQUAL("Hallo, wie gehts?", socket.output());
+    BOOST_CHECK_EQUAL(1u, writes);
+}
+
+/**
+ * @test responses, that get ready after the first response started writing, are combined, when the first response
+ *       completes.
+ */
+BOOST_AUTO_TEST_CASE(responses_blocked_by_a_sending_response_are_combined)
+{
+    typedef asio_mocks::socket<const char*>                         socket_t;
+    typedef traits< hello_world_response_factory >                  trait_t;
+    typedef server::connection<trait_t>                             connection_t;
+
+    boost::asio::io_service         queue;
+    socket_t                        socket(queue, begin(simple_get_11), end(simple_get_11), 0, 3);
+    trait_t                         trait;
+    boost::shared_ptr<connection_t> connection = server::create_connection(socket, trait);
+
+    unsigned writes = 0;
+    socket.write_callback(boost::bind(&count_write, boost::ref(writes), _1));
+
+    tools::run(queue);
+
+    std::vector<boost::shared_ptr<server::async_response> > resp = trait.responses();
+    BOOST_REQUIRE_EQUAL(3u, resp.size());
+    trait.reset_responses();
+
+    simulate_incomming_data(resp[0]);
+    simulate_incomming_data(resp[1]);
+    simulate_incomming_data(resp[2]);
+    resp.clear();
+
+    tools::run(queue);
+
+    BOOST_CHECK_EQUAL("Hallo, wie gehts?", socket.output());
+    BOOST_CHECK_EQUAL(2u, writes);
+}
+
 /** 
  * @test this test should ensure, that when a request in the middle of the pipeline reports a fatal error
  *       other responses will be canceled.
@@ -0,0 +1,128 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+#include "server/route_table.h"
+#include <algorithm>
+#include <cstring>
+
+namespace server
+{
+    namespace
+    {
+        // same as fitting_uri::uri_without_trailing_slash()
+        tools::substring without_trailing_slash( const char* begin, const char* end )
+        {
+            return begin == end || *( end - 1 ) != '/'
+                ? tools::substring( begin, end )
+                : tools::substring( begin, end - 1 );
+        }
+
+        int compare( const std::string& lhs, const tools::substring& rhs )
+        {
+            const int result = std::memcmp( lhs.data(), rhs.begin(), std::min( lhs.size(), rhs.size() ) );
+
+            if ( result != 0 )
+                return result;
+
+            return lhs.size() < rhs.size() ? -1 : lhs.size() == rhs.size() ? 0 : 1;
+        }
+
+        struct segment_less
+        {
+            bool operator()( const std::pair< std::string, std::size_t >& child, const tools::substring& segment ) const
+            {
+                return compare( child.first, segment ) < 0;
+            }
+        };
+
+        const char* segment_end( const char* begin, const char* end )
+        {
+            return std::find( begin, end, '/' );
+        }
+    }
+
+    const std::size_t route_table::npos;
+
+    route_table::route_table()
+        : nodes_( 1, node( npos ) )
+    {
+    }
+
+    void route_table::add( const std::string& route_input, std::size_t index )
+    {
+        const tools::substring route = without_trailing_slash( route_input.data(), route_input.data() + route_input.size() );
+        std::size_t current = 0;
+
+        // the path is split at every slash, an empty path consists of one empty segment
+        for ( const char* begin = route.begin(); ; )
+        {
+            const char* const end = segment_end( begin, route.end() );
+            const tools::substring segment( begin, end );
+
+            std::vector< std::pair< std::string, std::size_t > >& children = nodes_[ current ].children;
+            const std::vector< std::pair< std::string, std::size_t > >::iterator pos =
+                std::lower_bound( children.begin(), children.end(), segment, segment_less() );
+
+            if ( pos != children.end() && compare( pos->first, segment ) == 0 )
+            {
+                current = pos->second;
+            }
+            else
+            {
+                children.insert( pos, std::make_pair( std::string( segment.begin(), segment.end() ), nodes_.size() ) );
+                current = nodes_.size();
+
+                // may invalidate children
+                nodes_.push_back( node( npos ) );
+            }
+
+            if ( end == route.end() )
+                break;
+
+            begin = end + 1;
+        }
+
+        nodes_[ current ].index = std::min( nodes_[ current ].index, index );
+    }
+
+    std::size_t route_table::find( const tools::substring& uri_input ) const
+    {
+        const tools::substring uri = without_trailing_slash( uri_input.begin(), uri_input.end() );
+        const node* current = &nodes_[ 0 ];
+        std::size_t result  = npos;
+
+        for ( const char* begin = uri.begin(); current; )
+        {
+            const char* const end = segment_end( begin, uri.end() );
+            current = child( nodes_, *current, tools::substring( begin, end ) );
+
+            if ( !current )
+                break;
+
+            result = std::min( result, current->index );
+
+            if ( end == uri.end() )
+                break;
+
+            begin = end + 1;
+        }
+
+        return result;
+    }
+
+    void route_table::clear()
+    {
+        nodes_.assign( 1, node( npos ) );
+    }
+
+    const route_table::node* route_table::child( const std::vector< node >& nodes, const node& parent, const tools::substring& segment )
+    {
+        const std::vector< std::pair< std::string, std::size_t > >::const_iterator pos =
+            std::lower_bound( parent.children.begin(), parent.children.end(), segment, segment_less() );
+
+        return pos != parent.children.end() && compare( pos->first, segment ) == 0
+            ? &nodes[ pos->second ]
+            : 0;
+    }
+}
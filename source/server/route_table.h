@@ -0,0 +1,69 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+#ifndef SIOUX_SOURCE_SERVER_ROUTE_TABLE_H
+#define SIOUX_SOURCE_SERVER_ROUTE_TABLE_H
+
+#include "tools/substring.h"
+#include <string>
+#include <vector>
+
+namespace server
+{
+    /**
+     * @brief a trie of path segments, that finds the routes fitting to an uri
+     *
+     * A route fits an uri, if it fits in the sense of fitting_uri: After removing a trailing slash from both, the
+     * route is equal to the uri, or the uri starts with the route, followed by a slash. So the routes fitting an
+     * uri are the nodes along the path of the uri's segments and the costs of a lookup depend on the number of
+     * segments of the uri, not on the number of routes.
+     *
+     * Every route is added with an index. If more than one route fits, find() returns the smallest index, so that
+     * a route_table, filled with the positions of the routes in a list, yields the same result as searching the
+     * list for the first fitting route.
+     */
+    class route_table
+    {
+    public:
+        static const std::size_t npos = static_cast< std::size_t >( -1 );
+
+        route_table();
+
+        /**
+         * @brief adds a new route with the given index
+         *
+         * If the route was already added, the smaller index is kept.
+         */
+        void add( const std::string& route, std::size_t index );
+
+        /**
+         * @brief returns the smallest index of all routes fitting the uri, or npos if no route fits
+         */
+        std::size_t find( const tools::substring& uri ) const;
+
+        /**
+         * @brief removes all routes
+         */
+        void clear();
+
+    private:
+        struct node
+        {
+            explicit node( std::size_t i ) : index( i ), children() {}
+
+            // npos, if no route ends at this node
+            std::size_t                                         index;
+
+            // segment and node index, sorted by segment
+            std::vector< std::pair< std::string, std::size_t > > children;
+        };
+
+        static const node* child( const std::vector< node >& nodes, const node& parent, const tools::substring& segment );
+
+        // nodes_[ 0 ] is the root, the empty path
+        std::vector< node >  nodes_;
+    };
+}
+
+#endif // include guard
@@ -0,0 +1,108 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+#include "server/route_table.h"
+#include "server/fitting_uri.h"
+#include "tools/elapse_timer.h"
+#include "tools/iterators.h"
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/*
+ * compares searching a list of routes for the first fitting route (as response_factory did) with a route_table
+ * lookup. The routes resemble a server with a lot of file roots and handlers, with a catch all route at the end.
+ */
+namespace
+{
+    const unsigned iterations = 100000u;
+
+    const char* const uris[] = {
+        "/", "/index.html", "/static/css/site.css", "/static/js/app/main.js", "/images/logo.png",
+        "/bayeux", "/pubsub", "/publish", "/api/v1/users/42", "/api/v2/orders", "/handler/17/status",
+        "/handler/39", "/files/18/report.pdf", "/unknown/path/to/something" };
+
+    std::vector< std::string > create_routes()
+    {
+        std::vector< std::string > result;
+
+        const char* const fixed[] = {
+            "/static/css", "/static/js", "/images", "/bayeux", "/pubsub", "/publish", "/api/v1/users", "/api/v2/orders" };
+
+        result.insert( result.end(), tools::begin( fixed ), tools::end( fixed ) );
+
+        for ( unsigned i = 0; i != 20u; ++i )
+        {
+            std::ostringstream handler;
+            handler << "/handler/" << i * 2 + 1;
+            result.push_back( handler.str() );
+
+            std::ostringstream files;
+            files << "/files/" << i;
+            result.push_back( files.str() );
+        }
+
+        result.push_back( "/" );
+
+        return result;
+    }
+
+    void report( const char* name, const tools::elapse_timer& time, std::size_t checksum )
+    {
+        const boost::posix_time::time_duration elapsed = time.elapsed();
+        const std::size_t lookups = iterations * ( tools::end( uris ) - tools::begin( uris ) );
+
+        std::cout << name
+                  << ": elapsed: " << elapsed
+                  << "; per lookup: " << elapsed.total_nanoseconds() / lookups << "ns"
+                  << "; checksum: " << checksum << std::endl;
+    }
+}
+
+int main()
+{
+    const std::vector< std::string > routes = create_routes();
+
+    server::route_table table;
+    for ( std::size_t i = 0; i != routes.size(); ++i )
+        table.add( routes[ i ], i );
+
+    std::cout << "routes: " << routes.size() << std::endl;
+
+    {
+        std::size_t checksum = 0;
+        const tools::elapse_timer time;
+
+        for ( unsigned i = 0; i != iterations; ++i )
+        {
+            for ( const char* const* uri = tools::begin( uris ); uri != tools::end( uris ); ++uri )
+            {
+                const tools::substring s( *uri, *uri + std::strlen( *uri ) );
+                checksum += std::find_if( routes.begin(), routes.end(), server::fitting_uri( s ) ) - routes.begin();
+            }
+        }
+
+        report( "linear search", time, checksum );
+    }
+
+    {
+        std::size_t checksum = 0;
+        const tools::elapse_timer time;
+
+        for ( unsigned i = 0; i != iterations; ++i )
+        {
+            for ( const char* const* uri = tools::begin( uris ); uri != tools::end( uris ); ++uri )
+            {
+                const tools::substring s( *uri, *uri + std::strlen( *uri ) );
+                checksum += table.find( s );
+            }
+        }
+
+        report( "route table", time, checksum );
+    }
+}
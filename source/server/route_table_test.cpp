@@ -0,0 +1,112 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+#include <boost/test/unit_test.hpp>
+#include "server/route_table.h"
+#include "server/fitting_uri.h"
+#include "tools/iterators.h"
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace {
+    std::size_t find( const server::route_table& table, const std::string& uri )
+    {
+        return table.find( tools::substring( uri.data(), uri.data() + uri.size() ) );
+    }
+
+    // the index of the first route in the list, that fits the uri
+    std::size_t find_first_fitting( const std::vector< std::string >& routes, const std::string& uri )
+    {
+        const std::vector< std::string >::const_iterator pos =
+            std::find_if( routes.begin(), routes.end(), server::fitting_uri( tools::substring( uri.data(), uri.data() + uri.size() ) ) );
+
+        return pos == routes.end() ? server::route_table::npos : pos - routes.begin();
+    }
+
+    const char* const routes[] = {
+        "/pubsub/foo/bar", "/pubsub", "/publish/", "/", "/ab/cd", "/ab", "Hallo", "", "/ab//cd", "/a/b/c/" };
+
+    const char* const uris[] = {
+        "/", "", "/pubsub", "/pubsub/", "/pubsub/foo", "/pubsub/foo/bar", "/pubsub/foo/bar/baz", "/pubsubx",
+        "/publish", "/publish/x", "/ab", "/abc", "/ab/cd", "/ab/cde", "/ab//cd", "/ab//cd/e", "Hallo", "Hallo/x",
+        "Hello", "/a/b", "/a/b/c", "/a/b/c/d", "//", "a", "/a//" };
+}
+
+BOOST_AUTO_TEST_SUITE( route_table )
+
+/**
+ * @test an empty table does not find any route
+ */
+BOOST_AUTO_TEST_CASE( empty_table_finds_nothing )
+{
+    server::route_table table;
+
+    BOOST_CHECK_EQUAL( find( table, "/" ), server::route_table::npos );
+    BOOST_CHECK_EQUAL( find( table, "" ), server::route_table::npos );
+    BOOST_CHECK_EQUAL( find( table, "/foo" ), server::route_table::npos );
+}
+
+/**
+ * @test a single route is found, where fitting_uri fits
+ */
+BOOST_AUTO_TEST_CASE( single_route_fits_like_fitting_uri )
+{
+    for ( const char* const* route = tools::begin( routes ); route != tools::end( routes ); ++route )
+    {
+        server::route_table table;
+        table.add( *route, 0 );
+
+        const std::vector< std::string > list( 1, *route );
+
+        for ( const char* const* uri = tools::begin( uris ); uri != tools::end( uris ); ++uri )
+            BOOST_CHECK_MESSAGE( find( table, *uri ) == find_first_fitting( list, *uri ), "route: " << *route << " uri: " << *uri );
+    }
+}
+
+/**
+ * @test with more than one fitting route, the first added route is found, as when searching a list of routes
+ */
+BOOST_AUTO_TEST_CASE( first_fitting_route_is_found )
+{
+    server::route_table table;
+    const std::vector< std::string > list( tools::begin( routes ), tools::end( routes ) );
+
+    for ( std::size_t i = 0; i != list.size(); ++i )
+        table.add( list[ i ], i );
+
+    for ( const char* const* uri = tools::begin( uris ); uri != tools::end( uris ); ++uri )
+        BOOST_CHECK_MESSAGE( find( table, *uri ) == find_first_fitting( list, *uri ), "uri: " << *uri );
+
+    BOOST_CHECK_EQUAL( find( table, "/pubsub/foo/bar/baz" ), 0u );
+    BOOST_CHECK_EQUAL( find( table, "/pubsub/foo" ), 1u );
+    BOOST_CHECK_EQUAL( find( table, "/abc" ), 3u );
+}
+
+/**
+ * @test a route, that was added twice, keeps the smaller index
+ */
+BOOST_AUTO_TEST_CASE( duplicate_route_keeps_smaller_index )
+{
+    server::route_table table;
+    table.add( "/foo", 2 );
+    table.add( "/foo/", 1 );
+    table.add( "/foo", 3 );
+
+    BOOST_CHECK_EQUAL( find( table, "/foo/bar" ), 1u );
+}
+
+/**
+ * @test after clear(), no route is found
+ */
+BOOST_AUTO_TEST_CASE( clear_removes_all_routes )
+{
+    server::route_table table;
+    table.add( "/", 0 );
+    table.clear();
+
+    BOOST_CHECK_EQUAL( find( table, "/" ), server::route_table::npos );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
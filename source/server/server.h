@@ -11,73 +11,211 @@
 #include "server/response_factory.h"
 #include <boost/asio/io_service.hpp>
 #include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/cstdint.hpp>
 #include <boost/function.hpp>
 #include <boost/utility.hpp>
 #include <boost/static_assert.hpp>
 #include <boost/type_traits/is_same.hpp>
+#include <algorithm>
+#include <vector>
 
 namespace server {
 
+#ifdef SO_REUSEPORT
+    /**
+     * @brief socket option, that allows more than one socket to listen on the same port
+     *
+     * The kernel distributes incomming connections over all sockets listening on the same port.
+     */
+    typedef boost::asio::detail::socket_option::boolean< SOL_SOCKET, SO_REUSEPORT > reuse_port;
+#endif
+
+    /**
+     * @brief counters of accepted connections
+     *
+     * The accept rate can be calculated from the difference of accepted_connections between two samples.
+     */
+    struct accept_statistics
+    {
+        accept_statistics()
+            : accepted_connections( 0 )
+            , failed_accepts( 0 )
+            , total_accept_latency()
+            , max_accept_latency()
+        {
+        }
+
+        accept_statistics& operator+=( const accept_statistics& rhs )
+        {
+            accepted_connections += rhs.accepted_connections;
+            failed_accepts       += rhs.failed_accepts;
+            total_accept_latency += rhs.total_accept_latency;
+            max_accept_latency    = std::max( max_accept_latency, rhs.max_accept_latency );
+
+            return *this;
+        }
+
+        /// number of successfully accepted connections
+        boost::uint64_t                     accepted_connections;
+
+        /// number of accepts that failed
+        boost::uint64_t                     failed_accepts;
+
+        /// sum of the times between the completion of an accept and the start of the accepted connection
+        boost::posix_time::time_duration    total_accept_latency;
+
+        /// the largest time between the completion of an accept and the start of the accepted connection
+        boost::posix_time::time_duration    max_accept_latency;
+    };
 
     /**
      * @brief accepts incoming connection and creates connection objects from that
+     *
+     * The acceptator keeps Trait::pending_accepts() accepts pending and the same number of connection objects
+     * preallocated. When an accept completes, the replacing accept is issued, before the accepted connection is
+     * started. The accept latency is the time from the invocation of the completion handler to the start of the
+     * connection; it includes waiting for other threads using the acceptator and issuing the replacing accept.
+     * The acceptator can be used by more than one thread.
      */
     template < class Trait, class Connection >
     class acceptator : public boost::enable_shared_from_this< acceptator< Trait, Connection > >
     {
     public:
-        acceptator(boost::asio::io_service& s, Trait& trait, const boost::asio::ip::tcp::endpoint& ep)
-            : remote_end_point_(ep)
-            , acceptor_(s, ep)
+        /**
+         * @brief opens a new listen socket for the given endpoint
+         *
+         * If share_port is true, more than one acceptator can listen on the same endpoint. This requires
+         * support for SO_REUSEPORT.
+         */
+        acceptator(boost::asio::io_service& s, Trait& trait, const boost::asio::ip::tcp::endpoint& ep, bool share_port = false)
+            : acceptor_(s)
             , queue_(s)
             , trait_(trait)
             , timer_( queue_ )
+            , mutex_()
+            , pool_()
+            , suspended_accepts_( 0 )
+            , statistics_()
         {
+            acceptor_.open( ep.protocol() );
+            acceptor_.set_option( boost::asio::ip::tcp::acceptor::reuse_address( true ) );
+
+#ifdef SO_REUSEPORT
+            if ( share_port )
+                acceptor_.set_option( reuse_port( true ) );
+#else
+            assert( !share_port );
+#endif
+            acceptor_.bind( ep );
+            acceptor_.listen();
         }
 
         void start()
         {
-            issue_accept();
+            boost::mutex::scoped_lock lock( mutex_ );
+            fill_pool();
+
+            for ( unsigned accepts = trait_.pending_accepts(); accepts; --accepts )
+                issue_accept();
         }
 
         void shut_down()
         {
+            boost::mutex::scoped_lock lock( mutex_ );
+
             boost::system::error_code ec;
             timer_.cancel( ec );
             acceptor_.close( ec );
+            pool_.clear();
+        }
+
+        /**
+         * @brief the counters of this acceptator
+         */
+        accept_statistics statistics() const
+        {
+            boost::mutex::scoped_lock lock( mutex_ );
+            return statistics_;
         }
 
     private:
         typedef connection<Trait, Connection> connection_t;
+        typedef std::vector< boost::shared_ptr< connection_t > > connection_pool_t;
+
+        // all private functions, except the handlers, expect mutex_ to be locked
+        void fill_pool()
+        {
+            while ( pool_.size() < trait_.pending_accepts() )
+                pool_.push_back( boost::shared_ptr< connection_t >( new connection_t( boost::ref( queue_ ), trait_ ) ) );
+        }
 
         void issue_accept()
         {
-            boost::shared_ptr<connection_t> connection( new connection_t( boost::ref( queue_ ), trait_ ) );
+            boost::shared_ptr<connection_t> connection;
+
+            if ( pool_.empty() )
+            {
+                connection.reset( new connection_t( boost::ref( queue_ ), trait_ ) );
+            }
+            else
+            {
+                connection = pool_.back();
+                pool_.pop_back();
+            }
 
             boost::function< void(boost::system::error_code) > f =
                 boost::bind( &acceptator::handler_connect, this->shared_from_this(), connection, _1 );
 
-            acceptor_.async_accept( connection->socket(), remote_end_point_, f );
+            acceptor_.async_accept( connection->socket(), f );
         }
 
-        void handler_connect( boost::shared_ptr<connection_t> connection, boost::system::error_code& error )
+        void handler_connect( boost::shared_ptr<connection_t> connection, const boost::system::error_code& error )
         {
             if ( !error )
             {
+                const boost::posix_time::ptime completed = boost::posix_time::microsec_clock::universal_time();
+
+                {
+                    boost::mutex::scoped_lock lock( mutex_ );
+                    issue_accept();
+                }
+
+                boost::system::error_code ec;
                 connection->trait().event_accepting_new_connection(
-                    connection->socket().local_endpoint(), remote_end_point_ );
+                    connection->socket().local_endpoint( ec ), connection->socket().remote_endpoint( ec ) );
+
+                const boost::posix_time::time_duration latency =
+                    boost::posix_time::microsec_clock::universal_time() - completed;
 
                 connection->start();
-                issue_accept();
+
+                boost::mutex::scoped_lock lock( mutex_ );
+
+                ++statistics_.accepted_connections;
+                statistics_.total_accept_latency += latency;
+                statistics_.max_accept_latency    = std::max( statistics_.max_accept_latency, latency );
+
+                if ( acceptor_.is_open() )
+                    fill_pool();
             }
             else if ( error != boost::asio::error::operation_aborted && error != boost::asio::error::bad_descriptor
                 && error != boost::asio::error::broken_pipe )
             {
-                trait_.error_accepting_new_connection( connection->socket().local_endpoint(), error );
-
-                timer_.expires_from_now( trait_.reaccept_timeout() );
-                timer_.async_wait(
-                    boost::bind( &acceptator::handle_reaccept_timeout, this->shared_from_this(), boost::asio::placeholders::error ) );
+                boost::mutex::scoped_lock lock( mutex_ );
+
+                boost::system::error_code ec;
+                trait_.error_accepting_new_connection( acceptor_.local_endpoint( ec ), error );
+                ++statistics_.failed_accepts;
+
+                // the failed accepts are reissued together, when the timer expires
+                if ( suspended_accepts_++ == 0 )
+                {
+                    timer_.expires_from_now( trait_.reaccept_timeout() );
+                    timer_.async_wait(
+                        boost::bind( &acceptator::handle_reaccept_timeout, this->shared_from_this(), boost::asio::placeholders::error ) );
+                }
             }
         }
 
@@ -86,14 +224,21 @@ namespace server {
             if ( ec )
                 return;
 
-            issue_accept();
+            boost::mutex::scoped_lock lock( mutex_ );
+
+            for ( ; suspended_accepts_; --suspended_accepts_ )
+                issue_accept();
         }
 
-        boost::asio::ip::tcp::endpoint  remote_end_point_;
         boost::asio::ip::tcp::acceptor  acceptor_;
         boost::asio::io_service&        queue_;
         Trait&                          trait_;
         boost::asio::deadline_timer     timer_;
+
+        mutable boost::mutex            mutex_;
+        connection_pool_t               pool_;
+        unsigned                        suspended_accepts_;
+        accept_statistics               statistics_;
     };
 
     /**
@@ -150,6 +295,11 @@ namespace server {
          */
         void join();
 
+        /**
+         * @brief the sum of the counters of all listen ports
+         */
+        accept_statistics accept_counters() const;
+
         typedef Trait                           trait_t;
         trait_t& trait();
 
@@ -287,6 +437,17 @@ namespace server {
         thread_herd_.join_all();
     }
 
+    template < class Trait >
+    accept_statistics basic_server< Trait >::accept_counters() const
+    {
+        accept_statistics result;
+
+        for ( typename acceptor_list_t::const_iterator acc = acceptors_.begin(); acc != acceptors_.end(); ++acc )
+            result += ( *acc )->statistics();
+
+        return result;
+    }
+
 } // namespace server
 
 #endif // include guard
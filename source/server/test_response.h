@@ -88,7 +88,7 @@ namespace test {
             }
             else
             {
-                connection_->async_write(
+                connection_->async_write_last(
                     boost::asio::buffer(answer_), 
                     boost::bind(&response::handler, 
                             this->shared_from_this(),
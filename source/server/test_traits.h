@@ -11,6 +11,7 @@
 #include "server/error.h"
 #include "server/traits.h"
 #include "server/log.h"
+#include "server/wheel_timer.h"
 #include <vector>
 
 namespace server {
@@ -130,6 +131,9 @@ private:
 typedef traits< response_factory, asio_mocks::socket< const char* >, boost::asio::deadline_timer >
     traits_with_real_timer_t;
 
+typedef traits< response_factory, asio_mocks::socket< const char* >, server::wheel_timer >
+    traits_with_wheel_timer_t;
+
 } // namespace test
 } // namespace server 
 
@@ -3,11 +3,18 @@
 // Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
 
 #include "server/traits.h"
+#include "http/message.h"
+#include <algorithm>
+#include <cassert>
 
 namespace server 
 {
     connection_config::connection_config()
         : timeout_( boost::posix_time::seconds( 3 ) )
+        , max_header_size_( http::message::default_max_buffer_size )
+        , release_idle_memory_( false )
+        , body_buffer_size_( 16u * 1024u )
+        , pending_accepts_( 1u )
     {
 
     }
@@ -32,5 +39,47 @@ namespace server
         return boost::posix_time::seconds( 1 );
     }
 
+    std::size_t connection_config::max_header_size() const
+    {
+        return max_header_size_;
+    }
+
+    void connection_config::max_header_size( std::size_t new_size )
+    {
+        max_header_size_ = new_size;
+    }
+
+    bool connection_config::release_idle_memory() const
+    {
+        return release_idle_memory_;
+    }
+
+    void connection_config::release_idle_memory( bool release )
+    {
+        release_idle_memory_ = release;
+    }
+
+    std::size_t connection_config::body_buffer_size() const
+    {
+        return std::min( body_buffer_size_, max_header_size_ );
+    }
+
+    void connection_config::body_buffer_size( std::size_t new_size )
+    {
+        assert( new_size );
+        body_buffer_size_ = new_size;
+    }
+
+    unsigned connection_config::pending_accepts() const
+    {
+        return pending_accepts_;
+    }
+
+    void connection_config::pending_accepts( unsigned accepts )
+    {
+        assert( accepts );
+        pending_accepts_ = accepts;
+    }
+
 } // namespace server 
 
@@ -6,6 +6,7 @@
 #define SIOUX_SOURCE_SERVER_TRAITS_H
 
 #include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <cstddef>
 
 namespace http 
 {
@@ -157,8 +158,69 @@ namespace server
          *        is not made before this timeout have been reached.
          */
         boost::posix_time::time_duration reaccept_timeout() const;
+
+        /**
+         * @brief the maximum size of a request header. A request with a larger header is answered with an error.
+         *
+         * the default is http::message::default_max_buffer_size.
+         */
+        std::size_t max_header_size() const;
+
+        /**
+         * @brief sets a new maximum request header size
+         * @post max_header_size() == new_size
+         */
+        void max_header_size( std::size_t new_size );
+
+        /**
+         * @brief if true, a connection, that waits for the next request, releases its read buffers and waits
+         *        for the socket to become readable, before new buffers are allocated.
+         *
+         * the default is false, as busy keep-alive connections would have to reallocate their buffers for every
+         * request.
+         */
+        bool release_idle_memory() const;
+
+        /**
+         * @brief turns releasing memory of idle connections on or off
+         * @post release_idle_memory() == release
+         */
+        void release_idle_memory( bool release );
+
+        /**
+         * @brief size of the buffer, a request body is read into.
+         *
+         * the default is 16KB, so that a large body can be read with a small number of reads. The size is limited
+         * to max_header_size(), as data, that is read behind a body, is moved into the header of the next request.
+         */
+        std::size_t body_buffer_size() const;
+
+        /**
+         * @brief sets a new body read buffer size
+         * @pre new_size > 0
+         * @post body_buffer_size() == min( new_size, max_header_size() )
+         */
+        void body_buffer_size( std::size_t new_size );
+
+        /**
+         * @brief number of accepts, that a listen port keeps pending at the same time
+         *
+         * the default is 1. A larger number allows a higher accept rate, when a lot of clients connect at once.
+         */
+        unsigned pending_accepts() const;
+
+        /**
+         * @brief sets a new number of pending accepts per listen port
+         * @pre accepts > 0
+         * @post pending_accepts() == accepts
+         */
+        void pending_accepts( unsigned accepts );
     private:
         boost::posix_time::time_duration timeout_;
+        std::size_t                      max_header_size_;
+        bool                             release_idle_memory_;
+        std::size_t                      body_buffer_size_;
+        unsigned                         pending_accepts_;
     };
 
     /**
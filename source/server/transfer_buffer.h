@@ -41,8 +41,6 @@ namespace server
      * It's not save to let multiple threads access functions of one object. But it's save to read  
      * data from a buffer passed by read_buffer() from one thread and to write data to the write_buffer() 
      * from an other threads.
-     *
-     * @todo use http::chunk_encoder
      */
     template < std::size_t BufferSize >
     class transfer_buffer
@@ -154,7 +152,7 @@ namespace server
         start_ = 0;
         end_   = 0;
 
-        if ( header.option_available("Transfer-Encoding", "chunked") )
+        if ( header.option_available(http::header_transfer_encoding, "chunked") )
         {
             body_size_ = sizeof buffer_;
             chunked_state_ = chunk_size_start;
@@ -164,7 +162,7 @@ namespace server
         }
         else 
         {
-            const http::header* const length_header = header.find_header("Content-Length");
+            const http::header* const length_header = header.find_header(http::header_content_length);
             if (  length_header != 0 && http::parse_number(length_header->value().begin(), length_header->value().end(), body_size_) )
             {
                 body_size_ -= std::min(body_size_, unparsed_header_data_.second);
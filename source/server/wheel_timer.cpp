@@ -0,0 +1,356 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+#include "server/wheel_timer.h"
+#include <boost/asio/placeholders.hpp>
+#include <boost/bind.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <algorithm>
+#include <cassert>
+
+namespace server
+{
+    /////////////////////
+    // class timing_wheel
+    boost::asio::io_service::id timing_wheel::id;
+
+    timing_wheel::entry::entry()
+        : next_( 0 )
+        , previous_( 0 )
+        , tick_( 0 )
+        , handler_()
+    {
+    }
+
+    bool timing_wheel::entry::pending() const
+    {
+        return next_ != 0;
+    }
+
+    timing_wheel::timing_wheel( boost::asio::io_service& queue )
+        : boost::asio::io_service::service( queue )
+        , queue_( queue )
+        , start_( boost::posix_time::microsec_clock::universal_time() )
+        , tick_length_( boost::posix_time::millisec( 100 ).total_microseconds() )
+        , mutex_()
+        , tick_timer_( queue )
+        , ticking_( false )
+        , shut_down_( false )
+        , current_tick_( 0 )
+        , size_( 0 )
+    {
+        init_slots();
+    }
+
+    timing_wheel::timing_wheel( boost::asio::io_service& queue, const boost::posix_time::time_duration& resolution )
+        : boost::asio::io_service::service( queue )
+        , queue_( queue )
+        , start_( boost::posix_time::microsec_clock::universal_time() )
+        , tick_length_( resolution.total_microseconds() )
+        , mutex_()
+        , tick_timer_( queue )
+        , ticking_( false )
+        , shut_down_( false )
+        , current_tick_( 0 )
+        , size_( 0 )
+    {
+        assert( tick_length_ > 0 );
+        init_slots();
+    }
+
+    void timing_wheel::init_slots()
+    {
+        for ( unsigned level = 0; level != levels; ++level )
+        {
+            for ( unsigned slot = 0; slot != slot_count; ++slot )
+            {
+                slots_[ level ][ slot ].next_     = &slots_[ level ][ slot ];
+                slots_[ level ][ slot ].previous_ = &slots_[ level ][ slot ];
+            }
+        }
+    }
+
+    boost::posix_time::time_duration timing_wheel::resolution() const
+    {
+        return boost::posix_time::microsec( static_cast< boost::int64_t >( tick_length_ ) );
+    }
+
+    void timing_wheel::schedule( entry& e, const boost::posix_time::ptime& expiry, handler_t& handler )
+    {
+        boost::mutex::scoped_lock lock( mutex_ );
+        assert( !e.pending() );
+
+        if ( shut_down_ )
+            return;
+
+        // an empty wheel does not tick and has to catch up with the current time
+        if ( size_ == 0 )
+            current_tick_ = std::max( current_tick_, tick( boost::posix_time::microsec_clock::universal_time(), false ) );
+
+        e.tick_    = tick( expiry, true );
+        e.handler_.swap( handler );
+        insert( e );
+        ++size_;
+
+        if ( !ticking_ )
+            start_ticking();
+    }
+
+    std::size_t timing_wheel::cancel( entry& e )
+    {
+        handler_t handler;
+
+        {
+            boost::mutex::scoped_lock lock( mutex_ );
+
+            if ( !e.pending() )
+                return 0;
+
+            unlink( e );
+            --size_;
+            handler.swap( e.handler_ );
+
+            if ( shut_down_ )
+                return 1;
+        }
+
+        queue_.post( boost::bind( handler, boost::system::error_code( boost::asio::error::operation_aborted ) ) );
+
+        return 1;
+    }
+
+    void timing_wheel::shutdown_service()
+    {
+        std::vector< handler_t > handlers;
+
+        {
+            boost::mutex::scoped_lock lock( mutex_ );
+            shut_down_ = true;
+
+            for ( unsigned level = 0; level != levels; ++level )
+            {
+                for ( unsigned slot = 0; slot != slot_count; ++slot )
+                {
+                    entry& head = slots_[ level ][ slot ];
+
+                    while ( head.next_ != &head )
+                    {
+                        entry& e = *head.next_;
+                        unlink( e );
+
+                        handlers.push_back( handler_t() );
+                        handlers.back().swap( e.handler_ );
+                    }
+                }
+            }
+
+            size_ = 0;
+
+            boost::system::error_code ec;
+            tick_timer_.cancel( ec );
+        }
+
+        // destroying the handlers can destroy timers, which in turn call cancel()
+        handlers.clear();
+    }
+
+    boost::uint64_t timing_wheel::tick( const boost::posix_time::ptime& time, bool round_up ) const
+    {
+        if ( time <= start_ )
+            return 0;
+
+        const boost::uint64_t since_start = ( time - start_ ).total_microseconds();
+
+        return ( since_start + ( round_up ? tick_length_ - 1 : 0 ) ) / tick_length_;
+    }
+
+    void timing_wheel::insert( entry& e )
+    {
+        // an entry, that is already due, is expired with the next tick
+        boost::uint64_t       slot_tick = std::max( e.tick_, current_tick_ + 1 );
+        const boost::uint64_t max_delta = ( boost::uint64_t( 1 ) << ( slot_bits * levels ) ) - 1;
+
+        // entries beyond the range of the wheel are parked in the last level, until they come into range
+        if ( slot_tick - current_tick_ > max_delta )
+            slot_tick = current_tick_ + max_delta;
+
+        unsigned level = 0;
+        while ( level != levels - 1 && ( slot_tick - current_tick_ ) >= ( boost::uint64_t( 1 ) << ( slot_bits * ( level + 1 ) ) ) )
+            ++level;
+
+        entry& head = slots_[ level ][ ( slot_tick >> ( slot_bits * level ) ) & ( slot_count - 1 ) ];
+
+        e.next_                 = &head;
+        e.previous_             = head.previous_;
+        head.previous_->next_   = &e;
+        head.previous_          = &e;
+    }
+
+    void timing_wheel::unlink( entry& e )
+    {
+        e.previous_->next_  = e.next_;
+        e.next_->previous_  = e.previous_;
+        e.next_             = 0;
+        e.previous_         = 0;
+    }
+
+    timing_wheel::entry* timing_wheel::detach( entry& head )
+    {
+        if ( head.next_ == &head )
+            return 0;
+
+        entry* const first = head.next_;
+        head.previous_->next_ = 0;
+        head.next_            = &head;
+        head.previous_        = &head;
+
+        return first;
+    }
+
+    void timing_wheel::cascade( unsigned level )
+    {
+        // the list is detached first, as entries can be reinserted into the same slot
+        for ( entry* e = detach( slots_[ level ][ ( current_tick_ >> ( slot_bits * level ) ) & ( slot_count - 1 ) ] ); e; )
+        {
+            entry* const next = e->next_;
+            insert( *e );
+            e = next;
+        }
+    }
+
+    void timing_wheel::advance( std::vector< handler_t >& expired )
+    {
+        ++current_tick_;
+
+        // the higher levels are cascaded first, as they can fill the current slot of a lower level
+        for ( unsigned level = levels - 1; level != 0; --level )
+        {
+            if ( ( current_tick_ & ( ( boost::uint64_t( 1 ) << ( slot_bits * level ) ) - 1 ) ) == 0 )
+                cascade( level );
+        }
+
+        for ( entry* e = detach( slots_[ 0 ][ current_tick_ & ( slot_count - 1 ) ] ); e; )
+        {
+            entry* const next = e->next_;
+
+            if ( e->tick_ <= current_tick_ )
+            {
+                e->next_     = 0;
+                e->previous_ = 0;
+                --size_;
+
+                expired.push_back( handler_t() );
+                expired.back().swap( e->handler_ );
+            }
+            else
+            {
+                insert( *e );
+            }
+
+            e = next;
+        }
+    }
+
+    void timing_wheel::start_ticking()
+    {
+        ticking_ = true;
+
+        tick_timer_.expires_at( start_ + boost::posix_time::microsec(
+            static_cast< boost::int64_t >( ( current_tick_ + 1 ) * tick_length_ ) ) );
+        tick_timer_.async_wait( boost::bind( &timing_wheel::handle_tick, this, boost::asio::placeholders::error ) );
+    }
+
+    void timing_wheel::handle_tick( const boost::system::error_code& error )
+    {
+        std::vector< handler_t > expired;
+
+        {
+            boost::mutex::scoped_lock lock( mutex_ );
+            ticking_ = false;
+
+            if ( error || shut_down_ )
+                return;
+
+            const boost::uint64_t now = tick( boost::posix_time::microsec_clock::universal_time(), false );
+
+            while ( current_tick_ < now && size_ != 0 )
+                advance( expired );
+
+            current_tick_ = std::max( current_tick_, now );
+
+            if ( size_ != 0 )
+                start_ticking();
+        }
+
+        for ( std::vector< handler_t >::iterator handler = expired.begin(); handler != expired.end(); ++handler )
+            ( *handler )( boost::system::error_code() );
+    }
+
+    ////////////////////
+    // class wheel_timer
+    wheel_timer::wheel_timer( boost::asio::io_service& queue )
+        : queue_( queue )
+        , wheel_( boost::asio::use_service< timing_wheel >( queue ) )
+        , entry_()
+        , expiry_( boost::posix_time::pos_infin )
+    {
+    }
+
+    wheel_timer::~wheel_timer()
+    {
+        wheel_.cancel( entry_ );
+    }
+
+    boost::asio::io_service& wheel_timer::get_io_service()
+    {
+        return queue_;
+    }
+
+    std::size_t wheel_timer::cancel()
+    {
+        return wheel_.cancel( entry_ );
+    }
+
+    std::size_t wheel_timer::cancel( boost::system::error_code & ec )
+    {
+        ec = boost::system::error_code();
+        return cancel();
+    }
+
+    wheel_timer::time_type wheel_timer::expires_at() const
+    {
+        return expiry_;
+    }
+
+    std::size_t wheel_timer::expires_at( const time_type & expiry_time )
+    {
+        const std::size_t result = cancel();
+        expiry_ = expiry_time;
+
+        return result;
+    }
+
+    std::size_t wheel_timer::expires_at( const time_type & expiry_time, boost::system::error_code & ec )
+    {
+        ec = boost::system::error_code();
+        return expires_at( expiry_time );
+    }
+
+    wheel_timer::duration_type wheel_timer::expires_from_now() const
+    {
+        return expiry_ - boost::posix_time::microsec_clock::universal_time();
+    }
+
+    std::size_t wheel_timer::expires_from_now( const duration_type & expiry_time )
+    {
+        return expires_at( boost::posix_time::microsec_clock::universal_time() + expiry_time );
+    }
+
+    std::size_t wheel_timer::expires_from_now( const duration_type & expiry_time, boost::system::error_code & ec )
+    {
+        ec = boost::system::error_code();
+        return expires_from_now( expiry_time );
+    }
+
+} // namespace server
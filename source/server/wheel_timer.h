@@ -0,0 +1,203 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+#ifndef SIOUX_SOURCE_SERVER_WHEEL_TIMER_H
+#define SIOUX_SOURCE_SERVER_WHEEL_TIMER_H
+
+#include <boost/asio/deadline_timer.hpp>
+#include <boost/asio/io_service.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/function.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/utility.hpp>
+#include <vector>
+
+namespace server
+{
+    /**
+     * @brief a hierarchical timing wheel, that serves all wheel_timers of an io_service
+     *
+     * The wheel advances in ticks of resolution(). It consists of three levels of 256 slots each; the first level
+     * covers the next 256 ticks, the second the next 256 * 256 ticks and the third the rest. When the first level
+     * wraps, the timers of the next slot of the second level are distributed over the first level (and the same
+     * for the third level). Arming and canceling a timer takes constant time.
+     *
+     * The wheel ticks only, while there are pending timers, so an io_service without pending timers runs out of
+     * work. Expired timers are invoked from the tick handler.
+     *
+     * The wheel is created with the first wheel_timer of an io_service. To use a different resolution, add a wheel
+     * with boost::asio::add_service() before the first wheel_timer is created.
+     */
+    class timing_wheel : public boost::asio::io_service::service
+    {
+    public:
+        static boost::asio::io_service::id id;
+
+        /**
+         * @brief constructs a wheel with a resolution of 100ms
+         */
+        explicit timing_wheel( boost::asio::io_service& queue );
+
+        /**
+         * @brief constructs a wheel with the given resolution
+         * @pre resolution > 0
+         */
+        timing_wheel( boost::asio::io_service& queue, const boost::posix_time::time_duration& resolution );
+
+        /**
+         * @brief the duration of a tick. All expiry times are rounded up to the next tick.
+         */
+        boost::posix_time::time_duration resolution() const;
+
+        typedef boost::function< void ( const boost::system::error_code& ) > handler_t;
+
+        /**
+         * @brief a timer, as linked into a slot of the wheel
+         */
+        class entry : boost::noncopyable
+        {
+        public:
+            entry();
+
+            /**
+             * @brief true, if the entry is linked into the wheel, waiting for expiration
+             */
+            bool pending() const;
+        private:
+            friend class timing_wheel;
+
+            entry*          next_;
+            entry*          previous_;
+            boost::uint64_t tick_;
+            handler_t       handler_;
+        };
+
+        /**
+         * @brief links the entry into the wheel, the handler will be invoked, when expiry is reached
+         * @pre !e.pending()
+         *
+         * The handler is swapped into the entry.
+         */
+        void schedule( entry& e, const boost::posix_time::ptime& expiry, handler_t& handler );
+
+        /**
+         * @brief removes the entry from the wheel and posts its handler with operation_aborted
+         *
+         * returns the number of canceled handlers (0 or 1).
+         */
+        std::size_t cancel( entry& e );
+
+    private:
+        static const unsigned       slot_bits  = 8u;
+        static const unsigned       slot_count = 1u << slot_bits;
+        static const unsigned       levels     = 3u;
+
+        void shutdown_service();
+
+        boost::uint64_t tick( const boost::posix_time::ptime& time, bool round_up ) const;
+
+        // the following functions expect mutex_ to be locked
+        void insert( entry& e );
+        static void unlink( entry& e );
+        static entry* detach( entry& head );
+        void cascade( unsigned level );
+        void advance( std::vector< handler_t >& expired );
+        void start_ticking();
+
+        void handle_tick( const boost::system::error_code& error );
+
+        void init_slots();
+
+        boost::asio::io_service&        queue_;
+        const boost::posix_time::ptime  start_;
+        const boost::uint64_t           tick_length_;
+        boost::mutex                    mutex_;
+        boost::asio::deadline_timer     tick_timer_;
+        bool                            ticking_;
+        bool                            shut_down_;
+        boost::uint64_t                 current_tick_;
+        std::size_t                     size_;
+
+        // every slot is a circular list with the slot itself as sentinel
+        entry                           slots_[ levels ][ slot_count ];
+    };
+
+    /**
+     * @brief a timer with the interface of a boost::asio::deadline_timer, that is implemented by a timing_wheel
+     *
+     * Arming and canceling the timer takes constant time, but the timer expires only with the resolution
+     * of the timing_wheel, which is sufficient for read, write and keep alive timeouts. Only one wait
+     * can be pending on a wheel_timer at a time.
+     *
+     * A wheel_timer can be used as Timer parameter of connection_traits.
+     */
+    class wheel_timer : boost::noncopyable
+    {
+    public:
+        typedef boost::posix_time::ptime time_type;
+        typedef boost::posix_time::time_duration duration_type;
+
+        explicit wheel_timer( boost::asio::io_service& queue );
+
+        /**
+         * @brief a pending wait is canceled
+         */
+        ~wheel_timer();
+
+        boost::asio::io_service& get_io_service();
+
+        /**
+         * @brief start an asynchronous wait on the timer
+         * @pre there is no other pending wait on the timer
+         */
+        template< typename WaitHandler >
+        void async_wait( WaitHandler handler );
+
+        /**
+         * @brief Cancel any asynchronous operations that are waiting on the timer.
+         */
+        std::size_t cancel();
+        std::size_t cancel( boost::system::error_code & ec );
+
+        /**
+         * @brief Get the timer's expire time as an absolute time.
+         */
+        time_type expires_at() const;
+
+        /**
+         * @brief Set the timer's expire time as an absolute time. A pending wait is canceled.
+         */
+        std::size_t expires_at( const time_type & expiry_time );
+        std::size_t expires_at( const time_type & expiry_time, boost::system::error_code & ec );
+
+        /**
+         * @brief Get the timer's expire time relative to now.
+         */
+        duration_type expires_from_now() const;
+
+        /**
+         * @brief Set the timer's expire time relative to now. A pending wait is canceled.
+         */
+        std::size_t expires_from_now( const duration_type & expiry_time );
+        std::size_t expires_from_now( const duration_type & expiry_time, boost::system::error_code & ec );
+
+    private:
+        boost::asio::io_service&    queue_;
+        timing_wheel&               wheel_;
+        timing_wheel::entry         entry_;
+        time_type                   expiry_;
+    };
+
+    // implementation
+    template< typename WaitHandler >
+    void wheel_timer::async_wait( WaitHandler handler )
+    {
+        timing_wheel::handler_t wait_handler( handler );
+        wheel_.schedule( entry_, expiry_, wait_handler );
+    }
+
+} // namespace server
+
+#endif // include guard
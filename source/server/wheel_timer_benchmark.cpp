@@ -0,0 +1,125 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+#include "server/wheel_timer.h"
+#include "tools/elapse_timer.h"
+#include <boost/asio/deadline_timer.hpp>
+#include <boost/asio/io_service.hpp>
+#include <boost/bind.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/shared_ptr.hpp>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <vector>
+
+/*
+ * compares boost::asio::deadline_timer with server::wheel_timer, by rearming a lot of timers, as a connection
+ * does with its read and write timers on every read and write. Every rearm cancels the pending wait of the timer.
+ */
+namespace
+{
+    std::size_t allocations = 0;
+}
+
+void* operator new( std::size_t size )
+{
+    ++allocations;
+
+    if ( void* const result = std::malloc( size ? size : 1 ) )
+        return result;
+
+    throw std::bad_alloc();
+}
+
+void operator delete( void* p ) throw()
+{
+    std::free( p );
+}
+
+namespace
+{
+    const unsigned number_of_timers = 100000u;
+    const unsigned rounds           = 10u;
+
+    struct wait_handler
+    {
+        explicit wait_handler( std::size_t& c ) : calls( &c ) {}
+
+        void operator()( const boost::system::error_code& )
+        {
+            ++*calls;
+        }
+
+        std::size_t* calls;
+    };
+
+    // timeouts between 3 and 30 seconds, like read, write and keep alive timeouts
+    boost::posix_time::time_duration timeout( unsigned timer )
+    {
+        return boost::posix_time::seconds( 3 + timer % 28 );
+    }
+
+    template < class Timer >
+    void rearm( std::vector< boost::shared_ptr< Timer > >& timers, unsigned round, std::size_t& calls )
+    {
+        for ( unsigned i = 0; i != number_of_timers; ++i )
+        {
+            timers[ i ]->expires_from_now( timeout( i + round ) );
+            timers[ i ]->async_wait( wait_handler( calls ) );
+        }
+    }
+
+    template < class Timer >
+    void measure( const char* name )
+    {
+        boost::asio::io_service                     queue;
+        std::vector< boost::shared_ptr< Timer > >   timers;
+        std::size_t                                 calls = 0;
+
+        for ( unsigned i = 0; i != number_of_timers; ++i )
+        {
+            timers.push_back( boost::shared_ptr< Timer >( new Timer( queue ) ) );
+            timers.back()->expires_from_now( timeout( i ) );
+            timers.back()->async_wait( wait_handler( calls ) );
+        }
+
+        const std::size_t start_allocations = allocations;
+        const tools::elapse_timer time;
+
+        for ( unsigned round = 0; round != rounds; ++round )
+        {
+            // rearm from within a handler, as a connection does
+            queue.post( boost::bind( &rearm< Timer >, boost::ref( timers ), round, boost::ref( calls ) ) );
+
+            // handle the canceled waits
+            while ( queue.poll_one() )
+                ;
+        }
+
+        const boost::posix_time::time_duration elapsed = time.elapsed();
+        const std::size_t rearms = number_of_timers * rounds;
+
+        std::cout << name
+                  << ": elapsed: " << elapsed
+                  << "; per rearm: " << elapsed.total_nanoseconds() / rearms << "ns"
+                  << "; allocations per rearm: " << static_cast< double >( allocations - start_allocations ) / rearms
+                  << "; canceled waits: " << calls
+                  << std::endl;
+
+        for ( unsigned i = 0; i != number_of_timers; ++i )
+            timers[ i ]->cancel();
+
+        while ( queue.poll_one() )
+            ;
+    }
+}
+
+int main()
+{
+    std::cout << "timers: " << number_of_timers << "; rounds: " << rounds << std::endl;
+
+    measure< boost::asio::deadline_timer >( "deadline_timer" );
+    measure< server::wheel_timer >( "wheel_timer" );
+}
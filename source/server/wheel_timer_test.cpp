@@ -0,0 +1,167 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+#include <boost/test/unit_test.hpp>
+#include "server/wheel_timer.h"
+#include <boost/asio/io_service.hpp>
+#include <boost/bind.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <vector>
+
+namespace {
+    struct expiration
+    {
+        boost::system::error_code   error;
+        boost::posix_time::ptime    time;
+        unsigned                    order;
+    };
+
+    void record( std::vector< expiration >& expirations, unsigned order, const boost::system::error_code& error )
+    {
+        const expiration e = { error, boost::posix_time::microsec_clock::universal_time(), order };
+        expirations.push_back( e );
+    }
+
+    const boost::posix_time::time_duration resolution = boost::posix_time::millisec( 1 );
+
+    // a queue with a fine grained wheel, so that the higher levels of the wheel are used within a short time
+    struct fine_wheel_queue
+    {
+        fine_wheel_queue()
+        {
+            boost::asio::add_service( queue, new server::timing_wheel( queue, resolution ) );
+        }
+
+        boost::asio::io_service queue;
+    };
+}
+
+/**
+ * @test a timer expires not before the expiry time
+ */
+BOOST_FIXTURE_TEST_CASE( timer_expires, fine_wheel_queue )
+{
+    std::vector< expiration > expirations;
+    server::wheel_timer timer( queue );
+
+    const boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+    timer.expires_from_now( boost::posix_time::millisec( 20 ) );
+    timer.async_wait( boost::bind( &record, boost::ref( expirations ), 0u, _1 ) );
+
+    queue.run();
+
+    BOOST_REQUIRE_EQUAL( expirations.size(), 1u );
+    BOOST_CHECK( !expirations[ 0 ].error );
+    BOOST_CHECK( expirations[ 0 ].time - start >= boost::posix_time::millisec( 20 ) );
+}
+
+/**
+ * @test timers expire in the order of their expiry times, also when the timers are distributed over
+ *       all levels of the wheel.
+ */
+BOOST_FIXTURE_TEST_CASE( timers_expire_in_order, fine_wheel_queue )
+{
+    std::vector< expiration > expirations;
+
+    // 256 ticks are covered by the first level
+    const unsigned timeouts[] = { 700, 5, 300, 255, 256, 40, 257, 512 };
+    const unsigned sorted[]   = { 5, 40, 255, 256, 257, 300, 512, 700 };
+    const std::size_t count = sizeof timeouts / sizeof timeouts[ 0 ];
+
+    std::vector< boost::shared_ptr< server::wheel_timer > > timers;
+    const boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+
+    for ( std::size_t i = 0; i != count; ++i )
+    {
+        timers.push_back( boost::shared_ptr< server::wheel_timer >( new server::wheel_timer( queue ) ) );
+        timers.back()->expires_at( start + boost::posix_time::millisec( timeouts[ i ] ) );
+        timers.back()->async_wait( boost::bind( &record, boost::ref( expirations ), timeouts[ i ], _1 ) );
+    }
+
+    queue.run();
+
+    BOOST_REQUIRE_EQUAL( expirations.size(), count );
+
+    for ( std::size_t i = 0; i != count; ++i )
+    {
+        BOOST_CHECK_EQUAL( expirations[ i ].order, sorted[ i ] );
+        BOOST_CHECK( !expirations[ i ].error );
+        BOOST_CHECK( expirations[ i ].time - start >= boost::posix_time::millisec( sorted[ i ] ) );
+    }
+}
+
+/**
+ * @test canceling a timer invokes the handler with operation_aborted
+ */
+BOOST_FIXTURE_TEST_CASE( cancel_timer, fine_wheel_queue )
+{
+    std::vector< expiration > expirations;
+    server::wheel_timer timer( queue );
+
+    timer.expires_from_now( boost::posix_time::hours( 1 ) );
+    timer.async_wait( boost::bind( &record, boost::ref( expirations ), 0u, _1 ) );
+
+    BOOST_CHECK_EQUAL( timer.cancel(), 1u );
+    BOOST_CHECK_EQUAL( timer.cancel(), 0u );
+
+    // the wheel stops ticking, so run() returns
+    queue.run();
+
+    BOOST_REQUIRE_EQUAL( expirations.size(), 1u );
+    BOOST_CHECK( expirations[ 0 ].error == boost::asio::error::operation_aborted );
+}
+
+/**
+ * @test setting a new expiry time cancels a pending wait
+ */
+BOOST_FIXTURE_TEST_CASE( rearm_timer, fine_wheel_queue )
+{
+    std::vector< expiration > expirations;
+    server::wheel_timer timer( queue );
+
+    timer.expires_from_now( boost::posix_time::hours( 1 ) );
+    timer.async_wait( boost::bind( &record, boost::ref( expirations ), 1u, _1 ) );
+
+    BOOST_CHECK_EQUAL( timer.expires_from_now( boost::posix_time::millisec( 10 ) ), 1u );
+    timer.async_wait( boost::bind( &record, boost::ref( expirations ), 2u, _1 ) );
+
+    queue.run();
+
+    BOOST_REQUIRE_EQUAL( expirations.size(), 2u );
+    BOOST_CHECK_EQUAL( expirations[ 0 ].order, 1u );
+    BOOST_CHECK( expirations[ 0 ].error == boost::asio::error::operation_aborted );
+    BOOST_CHECK_EQUAL( expirations[ 1 ].order, 2u );
+    BOOST_CHECK( !expirations[ 1 ].error );
+}
+
+/**
+ * @test destroying a timer cancels the pending wait; destroying the io_service with pending timers is fine
+ */
+BOOST_AUTO_TEST_CASE( destroy_timer_and_queue )
+{
+    std::vector< expiration > expirations;
+
+    {
+        boost::asio::io_service queue;
+
+        {
+            server::wheel_timer timer( queue );
+            timer.expires_from_now( boost::posix_time::hours( 1 ) );
+            timer.async_wait( boost::bind( &record, boost::ref( expirations ), 1u, _1 ) );
+        }
+
+        queue.run();
+
+        BOOST_REQUIRE_EQUAL( expirations.size(), 1u );
+        BOOST_CHECK( expirations[ 0 ].error == boost::asio::error::operation_aborted );
+
+        server::wheel_timer timer( queue );
+        timer.expires_from_now( boost::posix_time::hours( 1 ) );
+        timer.async_wait( boost::bind( &record, boost::ref( expirations ), 2u, _1 ) );
+
+        BOOST_CHECK_EQUAL( boost::asio::use_service< server::timing_wheel >( queue ).resolution(), boost::posix_time::millisec( 100 ) );
+    }
+
+    BOOST_CHECK_EQUAL( expirations.size(), 1u );
+}
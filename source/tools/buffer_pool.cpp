@@ -0,0 +1,124 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+#include "tools/buffer_pool.h"
+#include <boost/thread/thread.hpp>
+#include <boost/functional/hash.hpp>
+#include <cassert>
+
+namespace tools {
+
+    const std::size_t buffer_pool::min_block_size;
+    const std::size_t buffer_pool::max_pooled_block_size;
+    const std::size_t buffer_pool::max_free_blocks;
+    const std::size_t buffer_pool::number_of_stripes;
+
+    namespace {
+        // free blocks kept per block size and stripe
+        const std::size_t max_free_blocks_per_stripe = buffer_pool::max_free_blocks / buffer_pool::number_of_stripes;
+    }
+
+    buffer_pool::buffer_pool()
+    {
+        for ( stripe* s = stripes_; s != stripes_ + number_of_stripes; ++s )
+            s->free_lists.resize( size_class( max_pooled_block_size ) + 1 );
+    }
+
+    buffer_pool::~buffer_pool()
+    {
+        for ( const stripe* s = stripes_; s != stripes_ + number_of_stripes; ++s )
+        {
+            for ( std::vector< free_list_t >::const_iterator list = s->free_lists.begin(); list != s->free_lists.end(); ++list )
+            {
+                for ( free_list_t::const_iterator block = list->begin(); block != list->end(); ++block )
+                    delete[] *block;
+            }
+        }
+    }
+
+    buffer_pool::stripe& buffer_pool::current_stripe()
+    {
+        return stripes_[ boost::hash< boost::thread::id >()( boost::this_thread::get_id() ) % number_of_stripes ];
+    }
+
+    std::size_t buffer_pool::size_class( std::size_t size )
+    {
+        std::size_t result = 0;
+        for ( std::size_t block_size = min_block_size; block_size < size; block_size *= 2 )
+            ++result;
+
+        return result;
+    }
+
+    char* buffer_pool::allocate( std::size_t& size )
+    {
+        assert( size != 0 );
+
+        const std::size_t index = size_class( size );
+        size = min_block_size << index;
+
+        if ( size <= max_pooled_block_size )
+        {
+            stripe& s = current_stripe();
+            boost::mutex::scoped_lock lock( s.mutex );
+            free_list_t& list = s.free_lists[ index ];
+
+            if ( !list.empty() )
+            {
+                char* const result = list.back();
+                list.pop_back();
+
+                return result;
+            }
+        }
+
+        return new char[ size ];
+    }
+
+    void buffer_pool::release( char* block, std::size_t size )
+    {
+        if ( block == 0 )
+            return;
+
+        if ( size <= max_pooled_block_size )
+        {
+            const std::size_t index = size_class( size );
+            assert( ( min_block_size << index ) == size );
+
+            stripe& s = current_stripe();
+            boost::mutex::scoped_lock lock( s.mutex );
+            free_list_t& list = s.free_lists[ index ];
+
+            if ( list.size() < max_free_blocks_per_stripe )
+            {
+                list.push_back( block );
+                return;
+            }
+        }
+
+        delete[] block;
+    }
+
+    std::size_t buffer_pool::free_blocks() const
+    {
+        std::size_t result = 0;
+
+        for ( const stripe* s = stripes_; s != stripes_ + number_of_stripes; ++s )
+        {
+            boost::mutex::scoped_lock lock( s->mutex );
+
+            for ( std::vector< free_list_t >::const_iterator list = s->free_lists.begin(); list != s->free_lists.end(); ++list )
+                result += list->size();
+        }
+
+        return result;
+    }
+
+    buffer_pool& buffer_pool::shared()
+    {
+        static buffer_pool pool;
+        return pool;
+    }
+
+} // namespace tools
@@ -0,0 +1,86 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+#ifndef SIOUX_SOURCE_TOOLS_BUFFER_POOL_H
+#define SIOUX_SOURCE_TOOLS_BUFFER_POOL_H
+
+#include <boost/thread/mutex.hpp>
+#include <cstddef>
+#include <vector>
+
+namespace tools {
+
+/**
+ * @brief thread safe pool of memory blocks for buffering incoming data
+ *
+ * Blocks are allocated in sizes of powers of two, starting with min_block_size. Released blocks of up to
+ * max_pooled_block_size bytes are kept in a free list per size, to be reused by the next allocation of the
+ * same size. Larger blocks are allocated and freed directly.
+ *
+ * The free lists are partitioned into stripes, each with its own mutex. A thread uses the stripe, that is
+ * selected by its thread id, so that threads rarely contend on a common lock. A block can be released by an
+ * other thread than the one, that allocated it.
+ */
+class buffer_pool
+{
+public:
+    static const std::size_t min_block_size         = 256u;
+    static const std::size_t max_pooled_block_size  = 64u * 1024u;
+
+    /**
+     * @brief the maximum number of free blocks kept per block size
+     */
+    static const std::size_t max_free_blocks        = 256u;
+
+    static const std::size_t number_of_stripes      = 16u;
+
+    buffer_pool();
+    ~buffer_pool();
+
+    /**
+     * @brief allocates a block of at least size bytes.
+     *
+     * size is set to the actual size of the returned block.
+     * @pre size != 0
+     */
+    char* allocate( std::size_t& size );
+
+    /**
+     * @brief returns a block, that was obtained from allocate() with the size, allocate() returned.
+     */
+    void release( char* block, std::size_t size );
+
+    /**
+     * @brief the number of free blocks kept by the pool
+     */
+    std::size_t free_blocks() const;
+
+    /**
+     * @brief a pool instance shared by all users of a process
+     */
+    static buffer_pool& shared();
+
+private:
+    buffer_pool( const buffer_pool& );
+    buffer_pool& operator=( const buffer_pool& );
+
+    static std::size_t size_class( std::size_t size );
+
+    typedef std::vector< char* > free_list_t;
+
+    struct stripe
+    {
+        mutable boost::mutex        mutex;
+        std::vector< free_list_t >  free_lists;
+    };
+
+    // the stripe of the calling thread
+    stripe& current_stripe();
+
+    stripe  stripes_[ number_of_stripes ];
+};
+
+} // namespace tools
+
+#endif // include guard
@@ -0,0 +1,96 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+#include <boost/test/unit_test.hpp>
+#include "tools/buffer_pool.h"
+#include <boost/thread/thread.hpp>
+#include <boost/bind.hpp>
+
+/**
+ * @test block sizes are rounded up to powers of two, starting with min_block_size
+ */
+BOOST_AUTO_TEST_CASE( buffer_pool_block_sizes )
+{
+    tools::buffer_pool pool;
+
+    std::size_t size = 1;
+    char* block = pool.allocate( size );
+    BOOST_CHECK_EQUAL( tools::buffer_pool::min_block_size, size );
+    pool.release( block, size );
+
+    size = tools::buffer_pool::min_block_size + 1;
+    block = pool.allocate( size );
+    BOOST_CHECK_EQUAL( 2 * tools::buffer_pool::min_block_size, size );
+    pool.release( block, size );
+
+    size = 3000;
+    block = pool.allocate( size );
+    BOOST_CHECK_EQUAL( 4096u, size );
+    pool.release( block, size );
+}
+
+/**
+ * @test released blocks are reused by allocations of the same size
+ */
+BOOST_AUTO_TEST_CASE( buffer_pool_reuses_released_blocks )
+{
+    tools::buffer_pool pool;
+
+    std::size_t size = 1000;
+    char* const first = pool.allocate( size );
+    BOOST_CHECK_EQUAL( 0u, pool.free_blocks() );
+
+    pool.release( first, size );
+    BOOST_CHECK_EQUAL( 1u, pool.free_blocks() );
+
+    std::size_t other_size = 100;
+    char* const other = pool.allocate( other_size );
+    BOOST_CHECK( other != first );
+
+    std::size_t same_size = 1024;
+    BOOST_CHECK( pool.allocate( same_size ) == first );
+    BOOST_CHECK_EQUAL( 0u, pool.free_blocks() );
+
+    pool.release( other, other_size );
+    pool.release( first, same_size );
+    BOOST_CHECK_EQUAL( 2u, pool.free_blocks() );
+}
+
+/**
+ * @test large blocks are not kept in the pool
+ */
+BOOST_AUTO_TEST_CASE( buffer_pool_does_not_keep_large_blocks )
+{
+    tools::buffer_pool pool;
+
+    std::size_t size = tools::buffer_pool::max_pooled_block_size + 1;
+    char* const block = pool.allocate( size );
+    BOOST_CHECK_EQUAL( 2 * tools::buffer_pool::max_pooled_block_size, size );
+
+    pool.release( block, size );
+    BOOST_CHECK_EQUAL( 0u, pool.free_blocks() );
+}
+
+namespace {
+    void release_block( tools::buffer_pool& pool, char* block, std::size_t size )
+    {
+        pool.release( block, size );
+    }
+}
+
+/**
+ * @test a block can be released by an other thread, than the one that allocated the block
+ */
+BOOST_AUTO_TEST_CASE( buffer_pool_release_from_other_thread )
+{
+    tools::buffer_pool pool;
+
+    std::size_t size = 1000;
+    char* const block = pool.allocate( size );
+
+    boost::thread other( boost::bind( &release_block, boost::ref( pool ), block, size ) );
+    other.join();
+
+    BOOST_CHECK_EQUAL( 1u, pool.free_blocks() );
+}